@@ -27,16 +27,30 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <cmath> // for ceil, floor
 #include <climits>
 
+// TTL lines that channels are mapped to (line = first line + bank index, wrapping around);
+// TTL_OUT can be any of them
+static const int NUM_EVENT_LINES = 64;
+
+// Buffer size to preallocate for before the actual buffer sizes are known
+static const int EXPECTED_MAX_BUFFER_SIZE = 4096;
+
+// name of the streams' enable parameter, made once rather than for every buffer
+static const String ENABLE_STREAM = "enable_stream";
+
 /** ------------- Crossing Detector Stream Settings --------------- */
 
 CrossingDetectorSettings::CrossingDetectorSettings() :
-    inputChannel(0),
     eventChannel(0),
     thresholdChannel(0),
-    sampleRate(0.0f),
     eventChannelPtr(nullptr),
-    turnoffEvent(nullptr)
+    currentThreshold(0.0f)
 {
+    inputChannels.add(0);
+    inputPointers.resize(1);
+
+    // different thresholds in each session, as with juce::Random
+    engine.setRandomSeed(Random().getSeed());
+
      // make the event-related metadata descriptors
     eventMetadataDescriptors.add(new MetadataDescriptor(MetadataDescriptor::INT64, 1, "Crossing Point",
         "Time when threshold was crossed", "crossing.point"));
@@ -46,154 +60,193 @@ CrossingDetectorSettings::CrossingDetectorSettings() :
         "Monitored voltage threshold", "crossing.threshold"));
     eventMetadataDescriptors.add(new MetadataDescriptor(MetadataDescriptor::UINT8, 1, "Direction",
         "Direction of crossing: 1 = rising, 0 = falling", "crossing.direction"));
+    eventMetadataDescriptors.add(new MetadataDescriptor(MetadataDescriptor::INT32, 1, "Decision latency",
+        "Samples from the crossing to the end of the buffer in which it was detected", "crossing.latency"));
+    eventMetadataDescriptors.add(new MetadataDescriptor(MetadataDescriptor::DOUBLE, 1, "Crossing time",
+        "Time when threshold was crossed, interpolated between samples", "crossing.time"));
+
+    for (auto desc : eventMetadataDescriptors)
+    {
+        eventMetadataValues.add(new MetadataValue(*desc));
+    }
 }
 
-void CrossingDetectorSettings::updateSampleRateDependentValues(
-                                int eventDuration,
-                                int timeout,
-                                int bufferEndMask)
+void CrossingDetectorSettings::setChannels(const Array<int>& channels)
 {
-    eventDurationSamp = int(std::ceil(eventDuration * sampleRate / 1000.0f));
-    timeoutSamp = int(std::floor(timeout * sampleRate / 1000.0f));
-    bufferEndMaskSamp = int(std::ceil(bufferEndMask * sampleRate / 1000.0f));
+    inputChannels = channels;
+    inputPointers.assign(size_t(channels.size()), nullptr);
+    engine.setChannels(channels.size());
 }
 
-TTLEventPtr CrossingDetectorSettings::createEvent(juce::int64 bufferTs, int crossingOffset,
-    int bufferLength, float threshold, float crossingLevel, bool eventState)
+void CrossingDetectorSettings::resetRandomThresh()
 {
-    // Construct metadata array
-    // The order has to match the order the descriptors are stored in createEventChannels.
-    MetadataValueArray mdArray;
-
-    int mdInd = 0;
-    MetadataValue* crossingPointVal = new MetadataValue(*eventMetadataDescriptors[mdInd++]);
-    crossingPointVal->setValue(bufferTs + crossingOffset);
-    mdArray.add(crossingPointVal);
-
-    MetadataValue* crossingLevelVal = new MetadataValue(*eventMetadataDescriptors[mdInd++]);
-    crossingLevelVal->setValue(crossingLevel);
-    mdArray.add(crossingLevelVal);
-
-    MetadataValue* threshVal = new MetadataValue(*eventMetadataDescriptors[mdInd++]);
-    threshVal->setValue(threshold);
-    mdArray.add(threshVal);
-
-    MetadataValue* directionVal = new MetadataValue(*eventMetadataDescriptors[mdInd++]);
-    directionVal->setValue(static_cast<juce::uint8>(crossingLevel > threshold));
-    mdArray.add(directionVal);
+    engine.resetRandomThresh();
+    currentThreshold.store(engine.getCurrentThreshold(), std::memory_order_relaxed);
+}
 
-    // Create event
-    if(eventState)
+void CrossingDetectorSettings::publishThreshold()
+{
+    if (engine.settings.thresholdType == RANDOM || engine.settings.thresholdType == ADAPTIVE)
     {
-        int sampleNumOn = std::max(crossingOffset, 0);
-        juce::int64 eventTsOn = bufferTs + sampleNumOn;
-        TTLEventPtr eventOn = TTLEvent::createTTLEvent(eventChannelPtr, eventTsOn,
-            eventChannel, true, mdArray);
-
-        return  eventOn;
+        currentThreshold.store(engine.getCurrentThreshold(), std::memory_order_relaxed);
     }
-    else
-    {
-        int sampleNumOff = std::max(crossingOffset, 0) + eventDurationSamp;
-        juce::int64 eventTsOff = bufferTs + sampleNumOff;
-        TTLEventPtr eventOff = TTLEvent::createTTLEvent(eventChannelPtr, eventTsOff,
-            eventChannel, false, mdArray);
+}
 
-        return eventOff;
-    }
+int CrossingDetectorSettings::getEventLine(int bankIndex) const
+{
+    return (eventChannel + bankIndex) % NUM_EVENT_LINES;
 }
 
+void CrossingDetectorSettings::setEventMetadata(const CrossingEngine::Event& event)
+{
+    // The order has to match the order the descriptors are stored in the constructor.
+    int mdInd = 0;
+    eventMetadataValues[mdInd++]->setValue(static_cast<juce::int64>(event.crossingPoint));
+    eventMetadataValues[mdInd++]->setValue(event.crossingLevel);
+    eventMetadataValues[mdInd++]->setValue(event.threshold);
+    eventMetadataValues[mdInd++]->setValue(static_cast<juce::uint8>(event.rising()));
+    eventMetadataValues[mdInd++]->setValue(static_cast<juce::int32>(event.latency));
+    eventMetadataValues[mdInd++]->setValue(event.crossingTime);
+}
+
+TTLEventPtr CrossingDetectorSettings::createEvent(const CrossingEngine::Event& event)
+{
+    setEventMetadata(event);
+    return TTLEvent::createTTLEvent(eventChannelPtr, event.sampleNumber,
+        getEventLine(event.channel), event.on, eventMetadataValues);
+}
 
 /** ------------- Crossing Detector Processor --------------- */
 
 CrossingDetector::CrossingDetector()
     : GenericProcessor      ("Crossing Detector")
-    , thresholdType         (CONSTANT)
-    , constantThresh        (0.0f)
     , selectedStreamId      (0)
-    , posOn                 (true)
-    , negOn                 (false)
-    , eventDuration         (100)
-    , timeout               (1000)
-    , useBufferEndMask      (false)
-    , bufferEndMaskMs       (3)
-    , pastStrict            (1.0f)
-    , pastSpan              (0)
-    , futureStrict          (1.0f)
-    , futureSpan            (0)
-    , useJumpLimit          (false)
-    , jumpLimit             (5.0f)
-    , jumpLimitElapsed      (0)
-    , sampToReenable        (pastSpan + futureSpan + 1)
-    , pastSamplesAbove      (0)
-    , futureSamplesAbove    (0)
-    , inputHistory          (pastSpan + futureSpan + 2)
-    , thresholdHistory      (pastSpan + futureSpan + 2)
 {
     setProcessorType(Plugin::Processor::FILTER);
 
-    randomThreshRange[0] = -180.0f;
-    randomThreshRange[1] = 180.0f;
-    thresholdVal = constantThresh;
+    // defaults are those of the engine
+    CrossingEngine::Settings defaults;
+    thresholdVal = defaults.constantThresh;
 
-    addSelectedChannelsParameter(Parameter::STREAM_SCOPE, "Channel", "The input channel to analyze", 1);
+    addSelectedChannelsParameter(Parameter::STREAM_SCOPE, "Channel", "The input channels to analyze", NUM_EVENT_LINES);
 
-    addIntParameter(Parameter::STREAM_SCOPE, "TTL_OUT", "Event output channel", 1, 1, 16);
+    addIntParameter(Parameter::STREAM_SCOPE, "TTL_OUT", "Event output line of the first input channel", 1, 1, NUM_EVENT_LINES);
 
-    addBooleanParameter(Parameter::GLOBAL_SCOPE, "Rising", 
+    addBooleanParameter(Parameter::STREAM_SCOPE, "Rising", 
                         "Trigger events when past samples are below and future samples are above the threshold",
-                        posOn);
+                        defaults.posOn);
     
-    addBooleanParameter(Parameter::GLOBAL_SCOPE, "Falling", 
+    addBooleanParameter(Parameter::STREAM_SCOPE, "Falling", 
                         "Trigger events when past samples are above and future samples are below the threshold",
-                        negOn);
+                        defaults.negOn);
     
-    addIntParameter(Parameter::GLOBAL_SCOPE, "Timeout_ms", "Minimum length of time between consecutive events",
-                    timeout, 0, 100000);
+    addIntParameter(Parameter::STREAM_SCOPE, "Timeout_ms", "Minimum length of time between consecutive events",
+                    defaults.timeout, 0, 100000);
+
+    addIntParameter(Parameter::STREAM_SCOPE, "decimation",
+                    "Factor by which the input channels are decimated before detection (1 = no decimation)",
+                    defaults.decimation, 1, PolyphaseDecimator::MAX_FACTOR);
+
+    addIntParameter(Parameter::STREAM_SCOPE, "prefilter_type",
+                    "Filter applied to the input channels before detection: 0 = none, 1 = high-pass, 2 = band-pass",
+                    defaults.prefilterType, 0, BiquadCascade::NUM_TYPES - 1);
+
+    addIntParameter(Parameter::STREAM_SCOPE, "prefilter_order", "Butterworth order of each cutoff of the input filter",
+                    defaults.prefilterOrder, 1, BiquadCascade::MAX_ORDER);
 
-    addIntParameter(Parameter::GLOBAL_SCOPE, "threshold_type", "Type of Threshold to use", thresholdType, 0, 2);
+    addFloatParameter(Parameter::STREAM_SCOPE, "prefilter_low_cut", "Low cutoff frequency of the input filter (Hz)",
+                    defaults.prefilterLowCut, 0.01f, 100000.0f, 1.0f);
 
-    addFloatParameter(Parameter::GLOBAL_SCOPE, "constant_threshold", "Constant threshold value",
-                    constantThresh, -FLT_MAX, FLT_MAX, 0.1f);
+    addFloatParameter(Parameter::STREAM_SCOPE, "prefilter_high_cut", "High cutoff frequency of the input filter (Hz)",
+                    defaults.prefilterHighCut, 0.01f, 100000.0f, 1.0f);
+
+    addIntParameter(Parameter::STREAM_SCOPE, "threshold_type", "Type of Threshold to use", defaults.thresholdType, 0, 4);
+
+    addFloatParameter(Parameter::STREAM_SCOPE, "constant_threshold", "Constant threshold value",
+                    defaults.constantThresh, -FLT_MAX, FLT_MAX, 0.1f);
     
-    addFloatParameter(Parameter::GLOBAL_SCOPE, "min_random_threshold", "Minimum random threshold value",
-                    randomThreshRange[0], -10000.0f, 10000.0f, 0.1f);
+    addFloatParameter(Parameter::STREAM_SCOPE, "min_random_threshold", "Minimum random threshold value",
+                    defaults.randomThreshRange[0], -10000.0f, 10000.0f, 0.1f);
 
-    addFloatParameter(Parameter::GLOBAL_SCOPE, "max_random_threshold", "Maximum random threshold value",
-                    randomThreshRange[1], -10000.0f, 10000.0f, 0.1f);
+    addFloatParameter(Parameter::STREAM_SCOPE, "max_random_threshold", "Maximum random threshold value",
+                    defaults.randomThreshRange[1], -10000.0f, 10000.0f, 0.1f);
 
     addIntParameter(Parameter::STREAM_SCOPE, "threshold_chan", "Threshold reference channel", 0, 0, 1000);
 
-    addIntParameter(Parameter::GLOBAL_SCOPE, "past_span", "Number of past samples to look at at each timepoint (attention span)",
-                    pastSpan, 0, 100000);
+    addIntParameter(Parameter::STREAM_SCOPE, "adaptive_estimator",
+                    "Amplitude estimate of adaptive thresholds: 0 = RMS, 1 = mean absolute value, 2 = median absolute value",
+                    defaults.adaptiveEstimator, 0, 2);
+
+    addFloatParameter(Parameter::STREAM_SCOPE, "adaptive_multiplier", "Adaptive threshold as a multiple of the amplitude estimate",
+                    defaults.adaptiveMultiplier, -1000.0f, 1000.0f, 0.1f);
+
+    addIntParameter(Parameter::STREAM_SCOPE, "adaptive_time_const", "Time constant of the adaptive threshold's moving average (ms)",
+                    defaults.adaptiveTimeConstMs, 1, INT_MAX);
+
+    addIntParameter(Parameter::STREAM_SCOPE, "adaptive_update", "Interval at which the median of an adaptive threshold is recomputed (ms)",
+                    defaults.adaptiveUpdateMs, 1, INT_MAX);
+
+    addBooleanParameter(Parameter::STREAM_SCOPE, "use_adaptive_freeze",
+                        "Stop adapting the threshold after the calibration period",
+                        defaults.useAdaptiveFreeze);
 
-    addIntParameter(Parameter::GLOBAL_SCOPE, "future_span", "Number of future samples to look at at each timepoint (attention span)",
-                    futureSpan, 0, 100000);
+    addIntParameter(Parameter::STREAM_SCOPE, "adaptive_calibration", "Calibration period of the adaptive threshold after the start of acquisition (ms)",
+                    defaults.adaptiveCalibrationMs, 0, INT_MAX);
+
+    addIntParameter(Parameter::STREAM_SCOPE, "past_span", "Number of past samples to look at at each timepoint (attention span)",
+                    defaults.pastSpan, 0, 100000);
+
+    addIntParameter(Parameter::STREAM_SCOPE, "future_span", "Number of future samples to look at at each timepoint (attention span)",
+                    defaults.futureSpan, 0, 100000);
     
-    addFloatParameter(Parameter::GLOBAL_SCOPE, "past_strict", "fraction of past span required to be above / below threshold",
-                    pastStrict, 0.0f, 1.0f, 0.01f);
+    addFloatParameter(Parameter::STREAM_SCOPE, "past_strict", "fraction of past span required to be above / below threshold",
+                    defaults.pastStrict, 0.0f, 1.0f, 0.01f);
 
-    addFloatParameter(Parameter::GLOBAL_SCOPE, "future_strict", "fraction of future span required to be above / below threshold",
-                    futureStrict, 0.0f, 1.0f, 0.01f);
+    addFloatParameter(Parameter::STREAM_SCOPE, "future_strict", "fraction of future span required to be above / below threshold",
+                    defaults.futureStrict, 0.0f, 1.0f, 0.01f);
     
-    addBooleanParameter(Parameter::GLOBAL_SCOPE, "use_jump_limit", 
+    addFloatParameter(Parameter::STREAM_SCOPE, "phase_target", "Phase (degrees, 0 = peak) at which phase detection triggers",
+                    defaults.phaseTarget, -180.0f, 180.0f, 1.0f);
+
+    addFloatParameter(Parameter::STREAM_SCOPE, "phase_freq", "Center frequency of the phase estimate (Hz)",
+                    defaults.phaseFreq, 0.01f, 100000.0f, 0.1f);
+
+    addFloatParameter(Parameter::STREAM_SCOPE, "phase_bandwidth", "Bandwidth of the phase estimate (Hz)",
+                    defaults.phaseBandwidth, 0.01f, 100000.0f, 0.1f);
+
+    addBooleanParameter(Parameter::STREAM_SCOPE, "early_decision",
+                        "Decide as soon as the future samples seen so far guarantee or rule out the future criterion",
+                        defaults.earlyDecision);
+
+    addBooleanParameter(Parameter::STREAM_SCOPE, "use_jump_limit", 
                         "Enable/Disable phase jump filtering",
-                        useJumpLimit);
+                        defaults.useJumpLimit);
     
-    addFloatParameter(Parameter::GLOBAL_SCOPE, "jump_limit", "Maximum jump size",
-                      jumpLimit, 0.0f, FLT_MAX, 0.1f);
+    addFloatParameter(Parameter::STREAM_SCOPE, "jump_limit", "Maximum jump size",
+                      defaults.jumpLimit, 0.0f, FLT_MAX, 0.1f);
 
-    addFloatParameter(Parameter::GLOBAL_SCOPE, "jump_limit_sleep", "Sleep after artifact",
-                      0.0f, 0.0f, FLT_MAX, 0.1f);
+    addFloatParameter(Parameter::STREAM_SCOPE, "jump_limit_sleep", "Sleep after artifact",
+                      defaults.jumpLimitSleep, 0.0f, FLT_MAX, 0.1f);
 
-    addBooleanParameter(Parameter::GLOBAL_SCOPE, "use_buffer_end_mask", 
+    addBooleanParameter(Parameter::STREAM_SCOPE, "use_hysteresis",
+                        "Enable/disable rearming only after the signal has been beyond the threshold by the hysteresis",
+                        defaults.useHysteresis);
+
+    addFloatParameter(Parameter::STREAM_SCOPE, "hysteresis", "Distance from the threshold at which a crossing direction is rearmed",
+                      defaults.hysteresis, 0.0f, FLT_MAX, 0.1f);
+
+    addBooleanParameter(Parameter::STREAM_SCOPE, "use_buffer_end_mask", 
                         "Enable/disable buffer end sample voting",
-                        negOn);
+                        defaults.useBufferEndMask);
+
+    addIntParameter(Parameter::STREAM_SCOPE, "buffer_end_mask", "Ignore crossings ocurring specified ms before the end of a buffer",
+                    defaults.bufferEndMaskMs, 0, INT_MAX);
 
-    addIntParameter(Parameter::GLOBAL_SCOPE, "buffer_end_mask", "Ignore crossings ocurring specified ms before the end of a buffer",
-                    bufferEndMaskMs, 0, INT_MAX);
+    addIntParameter(Parameter::STREAM_SCOPE, "event_duration", "Event Duration", defaults.eventDuration, 0, INT_MAX);
 
-    addIntParameter(Parameter::GLOBAL_SCOPE, "event_duration", "Event Duration", eventDuration, 0, INT_MAX);
+    addIntParameter(Parameter::STREAM_SCOPE, "crossing_interpolation",
+                    "Interpolation of the crossing time metadata (0 = linear, 1 = cubic)",
+                    defaults.interpolation, 0, CrossingKernel::NUM_INTERPOLATIONS - 1);
 }
 
 CrossingDetector::~CrossingDetector() {}
@@ -207,10 +260,18 @@ AudioProcessorEditor* CrossingDetector::createEditor()
 void CrossingDetector::updateSettings()
 {
     settings.update(getDataStreams());
+    streams = getDataStreams();
 
-    for(auto stream : getDataStreams())
+    for(auto stream : streams)
     {
-        settings[stream->getStreamId()]->sampleRate =  stream->getSampleRate();
+        settings[stream->getStreamId()]->engine.sampleRate = stream->getSampleRate();
+
+        Array<int>& globalIndices = settings[stream->getStreamId()]->globalChannelIndices;
+        globalIndices.clearQuick();
+        for (auto channel : stream->getContinuousChannels())
+        {
+            globalIndices.add(channel->getGlobalIndex());
+        }
         
         EventChannel* ttlChan;
         EventChannel::Settings ttlChanSettings{
@@ -232,393 +293,415 @@ void CrossingDetector::updateSettings()
         eventChannels.add(ttlChan);
         eventChannels.getLast()->addProcessor(processorInfo.get());
         settings[stream->getStreamId()]->eventChannelPtr = eventChannels.getLast();
-    }
 
-    // Force trigger parameter value update
-    parameterValueChanged(getParameter("Timeout_ms"));
-    parameterValueChanged(getParameter("threshold_type"));
-    parameterValueChanged(getParameter("constant_threshold"));
-    parameterValueChanged(getParameter("min_random_threshold"));
-    parameterValueChanged(getParameter("max_random_threshold"));
-    parameterValueChanged(getParameter("future_span"));
-    parameterValueChanged(getParameter("past_span"));
-    parameterValueChanged(getParameter("past_strict"));
-    parameterValueChanged(getParameter("future_strict"));
-    parameterValueChanged(getParameter("use_jump_limit"));
-    parameterValueChanged(getParameter("jump_limit"));
-    parameterValueChanged(getParameter("jump_limit_sleep"));
-    parameterValueChanged(getParameter("buffer_end_mask"));
-    parameterValueChanged(getParameter("event_duration"));
+        // Force trigger parameter value update
+        static const char* const paramNames[] = {
+            "Rising", "Falling", "Timeout_ms", "decimation", "prefilter_type", "prefilter_order", "prefilter_low_cut",
+            "prefilter_high_cut", "threshold_type", "constant_threshold",
+            "min_random_threshold", "max_random_threshold", "adaptive_estimator", "adaptive_multiplier",
+            "adaptive_time_const", "adaptive_update", "use_adaptive_freeze", "adaptive_calibration",
+            "phase_target", "phase_freq", "phase_bandwidth", "future_span", "past_span",
+            "past_strict", "future_strict", "early_decision", "use_jump_limit", "jump_limit", "jump_limit_sleep",
+            "use_hysteresis", "hysteresis",
+            "use_buffer_end_mask", "buffer_end_mask", "event_duration", "crossing_interpolation"
+        };
 
+        for (auto name : paramNames)
+        {
+            parameterValueChanged(getDataStream(stream->getStreamId())->getParameter(name));
+        }
+    }
 }
 
 void CrossingDetector::process(AudioSampleBuffer& continuousBuffer)
 {
-    // loop through the streams
-    for (auto stream : getDataStreams())
+    CROSSING_TRACE_SPAN("process", "process");
+    const juce::int64 startTicks = Time::getHighResolutionTicks();
+
+    // streams are processed in order, each adding its events as they are created
+    PerfCounters::Record record { 0.0f, 0, 0, 0, 0.0f };
+
+    for (auto stream : streams)
+    {
+        if ((*stream)[ENABLE_STREAM])
+        {
+            processStream(stream, continuousBuffer, record);
+        }
+
+        // the threshold display is updated on the message thread
+        settings[stream->getStreamId()]->publishThreshold();
+    }
+
+    record.processUs = float(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks) * 1e6);
+    perfCounters.push(record);
+}
+
+void CrossingDetector::processStream(const DataStream* stream, const AudioSampleBuffer& continuousBuffer,
+    PerfCounters::Record& record)
+{
+    CROSSING_TRACE_SPAN_ARG("detection", "stream", "stream", stream->getStreamId());
+    const juce::uint16 streamId = stream->getStreamId();
+    CrossingDetectorSettings* settingsModule = settings[streamId];
+    CrossingEngine& engine = settingsModule->engine;
+
+    if (!settingsModule->eventChannelPtr)
+    {
+        jassertfalse;
+        return;
+    }
+
+    const int nSamples = getNumSamplesInBlock(streamId);
+    const juce::int64 startTs = getFirstSampleNumberForBlock(streamId);
+
+    const Array<int>& globalIndices = settingsModule->globalChannelIndices;
+    const int numInputs = globalIndices.size();
+
+    // the samples of the monitored channels (channels that the stream doesn't have are skipped)
+    int numMonitored = 0;
+    for (int k = 0; k < settingsModule->inputChannels.size(); ++k)
+    {
+        int inputChannel = settingsModule->inputChannels[k];
+        const float* samples = nullptr;
+
+        if (inputChannel >= 0 && inputChannel < numInputs)
+        {
+            samples = continuousBuffer.getReadPointer(globalIndices[inputChannel]);
+            ++numMonitored;
+        }
+        settingsModule->inputPointers[size_t(k)] = samples;
+    }
+
+    const float* threshChan = engine.settings.thresholdType == CHANNEL
+        ? continuousBuffer.getReadPointer(globalIndices[settingsModule->thresholdChannel])
+        : nullptr;
+
+    record.candidates += engine.process(settingsModule->inputPointers.data(), threshChan,
+        nSamples, startTs);
+    record.samples += nSamples * numMonitored;
+
+    // turn the engine's events into TTL events
+    for (const CrossingEngine::Event& event : engine.getEvents())
     {
+        CROSSING_TRACE_SPAN_ARG("events", "add event", "channel", event.channel);
 
-        if ((*stream)["enable_stream"] && stream->getStreamId() == selectedStreamId)
+        if (event.on)
         {
-            CrossingDetectorSettings* settingsModule = settings[stream->getStreamId()];
-
-            if (settingsModule->inputChannel < 0
-                || settingsModule->inputChannel >= continuousBuffer.getNumChannels()
-                || !settingsModule->eventChannelPtr)
-            {
-                jassertfalse;
-                return;
-            }
-
-            int nSamples = getNumSamplesInBlock(stream->getStreamId());
-            int globalChanIndex = stream->getContinuousChannels()[settingsModule->inputChannel]->getGlobalIndex();
-            const float* const rp = continuousBuffer.getReadPointer(globalChanIndex);
-            juce::int64 startTs = getFirstSampleNumberForBlock(stream->getStreamId());
-
-            // turn off event from previous buffer if necessary
-            int turnoffOffset = settingsModule->turnoffEvent ? 
-                                jmax(0, (int)(settingsModule->turnoffEvent->getSampleNumber() - startTs)) : -1;
-            if (turnoffOffset >= 0 && turnoffOffset < nSamples)
-            {
-                addEvent(settingsModule->turnoffEvent, turnoffOffset);
-                settingsModule->turnoffEvent = nullptr;
-            }
-
-            const ThresholdType currThreshType = thresholdType;
-
-            // store threshold for each sample of current buffer
-            if (currThresholds.size() < nSamples)
-            {
-                currThresholds.resize(nSamples);
-            }
-            float* const pThresh = currThresholds.getRawDataPointer();
-
-            int threshChanIndex = stream->getContinuousChannels()[settingsModule->thresholdChannel]->getGlobalIndex();
-            const float* const rpThreshChan = currThreshType == CHANNEL
-                ? continuousBuffer.getReadPointer(threshChanIndex)
-                : nullptr;
-
-            // define lambdas to access history values more easily
-            auto inputAt = [=](int index)
-            {
-                return index < 0 ? inputHistory[index] : rp[index];
-            };
-
-            auto thresholdAt = [&, this](int index)
-            {
-                return index < 0 ? thresholdHistory[index] : pThresh[index];
-            };
-
-            // loop over current buffer and add events for newly detected crossings
-            for (int i = 0; i < nSamples; ++i)
-            {
-                // state to keep constant during each iteration
-                bool currPosOn = posOn;
-                bool currNegOn = negOn;
-
-                // get and save threshold for this sample
-                switch (currThreshType)
-                {
-                case CONSTANT:
-                    pThresh[i] = constantThresh;
-                    break;
-                case RANDOM:
-                    pThresh[i] = currRandomThresh;
-                    break;
-
-                case CHANNEL:
-                    pThresh[i] = rpThreshChan[i];
-                    break;
-                }
-
-                int indCross = i - futureSpan;
-
-                // update pastSamplesA`bove and futureSamplesAbove
-                if (pastSpan > 0)
-                {
-                    int indLeaving = indCross - 2 - pastSpan;
-                    if (inputAt(indLeaving) > thresholdAt(indLeaving))
-                    {
-                        pastSamplesAbove--;
-                    }
-
-                    int indEntering = indCross - 2;
-                    if (inputAt(indEntering) > thresholdAt(indEntering))
-                    {
-                        pastSamplesAbove++;
-                    }
-                }
-
-                if (futureSpan > 0)
-                {
-                    int indLeaving = indCross;
-                    if (inputAt(indLeaving) > thresholdAt(indLeaving))
-                    {
-                        futureSamplesAbove--;
-                    }
-
-                    int indEntering = indCross + futureSpan; // (== i)
-                    if (inputAt(indEntering) > thresholdAt(indEntering))
-                    {
-                        futureSamplesAbove++;
-                    }
-                }
-
-                if (indCross < sampToReenable ||
-                    (useBufferEndMask && nSamples - indCross > settingsModule->bufferEndMaskSamp))
-                {
-                    // can't trigger an event now
-                    continue;
-                }
-
-                float preVal = inputAt(indCross - 1);
-                float preThresh = thresholdAt(indCross - 1);
-                float postVal = inputAt(indCross);
-                float postThresh = thresholdAt(indCross);
-
-
-                // check whether to trigger an event
-                if (currPosOn && shouldTrigger(true, preVal, postVal, preThresh, postThresh) ||
-                    currNegOn && shouldTrigger(false, preVal, postVal, preThresh, postThresh))
-                {
-                    // create and add ON event
-                    TTLEventPtr onEvent = settingsModule->
-                        createEvent(startTs, indCross, nSamples, postThresh, postVal, true);
-                    addEvent(onEvent, std::max(indCross, 0));
-
-                    // create OFF event
-                    int sampleNumOff = std::max(indCross, 0) + settingsModule->eventDurationSamp;
-                    TTLEventPtr offEvent = settingsModule->
-                        createEvent(startTs, indCross, nSamples, postThresh, postVal, false);
-                    
-                    // Add or schedule turning-off event
-                    // We don't care whether there are other turning-offs scheduled to occur either in
-                    // this buffer or later. The abilities to change event duration during acquisition and for
-                    // events to be longer than the timeout period create a lot of possibilities and edge cases,
-                    // but overwriting turnoffEvent unconditionally guarantees that this and all previously
-                    // turned-on events will be turned off by this "turning-off" if they're not already off.
-                    if (sampleNumOff <= nSamples)
-                    {
-                        // add off event now
-                        addEvent(offEvent, sampleNumOff);
-                    }
-                    else
-                    {
-                        // save for later
-                        settingsModule->turnoffEvent = offEvent;
-                    }
-                    
-                    // update sampToReenable
-                    sampToReenable = indCross + 1 + settingsModule->timeoutSamp;
-
-                    // if using random thresholds, set a new threshold
-                    if (currThreshType == RANDOM)
-                    {
-                        currRandomThresh = nextRandomThresh();
-                        thresholdVal = currRandomThresh;
-                    }
-                }
-            }
-
-            // update inputHistory and thresholdHistory
-            inputHistory.enqueueArray(rp, nSamples);
-            thresholdHistory.enqueueArray(pThresh, nSamples);
-
-            // shift sampToReenable so it is relative to the next buffer
-            sampToReenable = jmax(0, sampToReenable - nSamples);
+            record.maxLatencyMs = jmax(record.maxLatencyMs, event.latency * 1000.0f / engine.sampleRate);
         }
+
+        addEvent(settingsModule->createEvent(event), event.offset);
+        ++record.events;
     }
 }
 
 void CrossingDetector::parameterValueChanged(Parameter* param)
 {
+    CROSSING_TRACE_SPAN("parameters", "parameter");
     LOGD("[Crossing Detector] Parameter value changed: ", param->getName());
+
+    juce::uint16 streamId = param->getStreamId();
+    CrossingDetectorSettings* settingsModule = settings[streamId];
+    CrossingEngine& engine = settingsModule->engine;
+    CrossingEngine::Settings& detection = engine.settings;
+
     if (param->getName().equalsIgnoreCase("threshold_type"))
     {
-        thresholdType = static_cast<ThresholdType>((int)param->getValue());
+        detection.thresholdType = static_cast<ThresholdType>((int)param->getValue());
 
-        switch (thresholdType)
+        if (detection.thresholdType == RANDOM)
         {
-            case CONSTANT:
-                thresholdVal = constantThresh;
-                break;
-
-            case RANDOM:
-                // get new random threshold
-                currRandomThresh = nextRandomThresh();
-                thresholdVal = currRandomThresh;
-                break;
-
-            case CHANNEL:
-                thresholdVal = toChannelThreshString(settings[selectedStreamId]->thresholdChannel);
-                break;
+            // get new random threshold
+            settingsModule->resetRandomThresh();
         }
+        updateThresholdVal(streamId);
     }
     else if (param->getName().equalsIgnoreCase("constant_threshold"))
     {
-        constantThresh = (float)param->getValue();
-        if (thresholdType == CONSTANT)
+        detection.constantThresh = (float)param->getValue();
+        updateThresholdVal(streamId);
+    }
+    else if (param->getName().equalsIgnoreCase("min_random_threshold"))
+    {
+        detection.randomThreshRange[0] = (float)param->getValue();
+        settingsModule->resetRandomThresh();
+        updateThresholdVal(streamId);
+    }
+    else if (param->getName().equalsIgnoreCase("max_random_threshold"))
+    {
+        detection.randomThreshRange[1] = (float)param->getValue();
+        settingsModule->resetRandomThresh();
+        updateThresholdVal(streamId);
+    }
+    else if (param->getName().equalsIgnoreCase("threshold_chan"))
+    {
+        settingsModule->thresholdChannel = (int)param->getValue();
+        updateThresholdVal(streamId);
+    }
+    else if (param->getName().equalsIgnoreCase("decimation"))
+    {
+        if (!acceptPrefilterChange(param, float(detection.decimation)))
         {
-            thresholdVal = constantThresh;
+            return;
         }
+
+        // everything that runs at the detection rate starts over
+        detection.decimation = (int)param->getValue();
+        engine.updateDecimators();
+        engine.updateSampleRateDependentValues();
+        engine.updatePrefilters();
+        engine.updatePhaseEstimators();
+        engine.resetDetectors();
     }
-    else if (param->getName().equalsIgnoreCase("min_random_threshold"))
+    else if (param->getName().equalsIgnoreCase("prefilter_type"))
     {
-        randomThreshRange[0] = (float)param->getValue();
-        currRandomThresh = nextRandomThresh();
-        if (thresholdType == RANDOM)
+        if (acceptPrefilterChange(param, float(detection.prefilterType)))
         {
-            thresholdVal = currRandomThresh;
+            detection.prefilterType = static_cast<BiquadCascade::Type>((int)param->getValue());
+            engine.updatePrefilters();
         }
     }
-    else if (param->getName().equalsIgnoreCase("max_random_threshold"))
+    else if (param->getName().equalsIgnoreCase("prefilter_order"))
     {
-        randomThreshRange[1] = (float)param->getValue();
-        currRandomThresh = nextRandomThresh();
-        if (thresholdType == RANDOM)
+        detection.prefilterOrder = (int)param->getValue();
+        engine.updatePrefilters();
+    }
+    else if (param->getName().equalsIgnoreCase("prefilter_low_cut"))
+    {
+        if (acceptPrefilterChange(param, detection.prefilterLowCut))
         {
-            thresholdVal = currRandomThresh;
+            detection.prefilterLowCut = (float)param->getValue();
+            engine.updatePrefilters();
         }
     }
-    else if (param->getName().equalsIgnoreCase("threshold_chan"))
+    else if (param->getName().equalsIgnoreCase("prefilter_high_cut"))
     {
-        settings[param->getStreamId()]->thresholdChannel = (int)param->getValue();
-        if (thresholdType == CHANNEL)
+        if (acceptPrefilterChange(param, detection.prefilterHighCut))
         {
-            thresholdVal = toChannelThreshString(settings[param->getStreamId()]->thresholdChannel);
+            detection.prefilterHighCut = (float)param->getValue();
+            engine.updatePrefilters();
         }
     }
+    else if (param->getName().equalsIgnoreCase("adaptive_estimator"))
+    {
+        detection.adaptiveEstimator = static_cast<AdaptiveThreshold::Estimator>((int)param->getValue());
+        engine.updateAdaptiveThresholds();
+        updateThresholdVal(streamId);
+    }
+    else if (param->getName().equalsIgnoreCase("adaptive_multiplier"))
+    {
+        detection.adaptiveMultiplier = (float)param->getValue();
+        engine.updateAdaptiveThresholds();
+        updateThresholdVal(streamId);
+    }
+    else if (param->getName().equalsIgnoreCase("adaptive_time_const"))
+    {
+        detection.adaptiveTimeConstMs = (int)param->getValue();
+        engine.updateAdaptiveThresholds();
+    }
+    else if (param->getName().equalsIgnoreCase("adaptive_update"))
+    {
+        detection.adaptiveUpdateMs = (int)param->getValue();
+        engine.updateAdaptiveThresholds();
+    }
+    else if (param->getName().equalsIgnoreCase("use_adaptive_freeze"))
+    {
+        detection.useAdaptiveFreeze = (bool)param->getValue();
+        engine.updateAdaptiveThresholds();
+    }
+    else if (param->getName().equalsIgnoreCase("adaptive_calibration"))
+    {
+        detection.adaptiveCalibrationMs = (int)param->getValue();
+        engine.updateAdaptiveThresholds();
+    }
+    else if (param->getName().equalsIgnoreCase("phase_target"))
+    {
+        detection.phaseTarget = (float)param->getValue();
+        updateThresholdVal(streamId);
+    }
+    else if (param->getName().equalsIgnoreCase("phase_freq"))
+    {
+        detection.phaseFreq = (float)param->getValue();
+        engine.updatePhaseEstimators();
+    }
+    else if (param->getName().equalsIgnoreCase("phase_bandwidth"))
+    {
+        detection.phaseBandwidth = (float)param->getValue();
+        engine.updatePhaseEstimators();
+    }
     else if (param->getName().equalsIgnoreCase("Channel"))
     {
-        Array<var>* array = param->getValue().getArray();
-        
-        if (array->size() > 0)
-            settings[param->getStreamId()]->inputChannel = int(array->getReference(0));
-        else
-            settings[param->getStreamId()]->inputChannel = -1;
+        var value = param->getValue();
+        Array<var>* array = value.getArray();
+
+        Array<int> channels;
+        for (int i = 0; i < array->size(); ++i)
+        {
+            channels.add(int(array->getReference(i)));
+        }
+
+        settingsModule->setChannels(channels);
 
-        if(selectedStreamId != param->getStreamId())
-            setSelectedStream(param->getStreamId());
+        if(selectedStreamId != streamId)
+            setSelectedStream(streamId);
 
         // make sure available threshold channels take into account new input channel
-        static_cast<CrossingDetectorEditor*>(getEditor())->updateVisualizer();
+        // (there is no editor when the processor runs in a headless host)
+        if (auto* crossingEditor = static_cast<CrossingDetectorEditor*>(getEditor()))
+        {
+            crossingEditor->updateVisualizer();
+        }
 
         // // update signal chain, since the event channel metadata has to get updated.
         // CoreServices::updateSignalChain(getEditor());
     }
     else if (param->getName().equalsIgnoreCase("TTL_OUT"))
     {
-        settings[param->getStreamId()]->eventChannel = (int)param->getValue() - 1;
+        settingsModule->eventChannel = (int)param->getValue() - 1;
     }
     else if (param->getName().equalsIgnoreCase("Rising"))
     {
-        posOn = (bool)param->getValue();
+        detection.posOn = (bool)param->getValue();
     }
     else if (param->getName().equalsIgnoreCase("Falling"))
     {
-        negOn = (bool)param->getValue();
+        detection.negOn = (bool)param->getValue();
     }
     else if (param->getName().equalsIgnoreCase("event_duration"))
     {
-        eventDuration = (int)param->getValue();
-        for (auto stream : getDataStreams())
-        {
-            settings[stream->getStreamId()]->updateSampleRateDependentValues(eventDuration, timeout, bufferEndMaskMs);
-        }
+        detection.eventDuration = (int)param->getValue();
+        engine.updateSampleRateDependentValues();
+    }
+    else if (param->getName().equalsIgnoreCase("crossing_interpolation"))
+    {
+        detection.interpolation = static_cast<CrossingKernel::Interpolation>((int)param->getValue());
     }
     else if (param->getName().equalsIgnoreCase("Timeout_ms"))
     {
-        timeout = (int)param->getValue();
-        for (auto stream : getDataStreams())
-        {
-            settings[stream->getStreamId()]->updateSampleRateDependentValues(eventDuration, timeout, bufferEndMaskMs);
-        }
+        detection.timeout = (int)param->getValue();
+        engine.updateSampleRateDependentValues();
     }
     else if (param->getName().equalsIgnoreCase("past_span"))
     {
-        pastSpan = (int)param->getValue();
-        sampToReenable = pastSpan + futureSpan + 1;
-
-        inputHistory.reset();
-        inputHistory.resize(pastSpan + futureSpan + 2);
-        thresholdHistory.reset();
-        thresholdHistory.resize(pastSpan + futureSpan + 2);
-
-        // counters must reflect current contents of inputHistory and thresholdHistory
-        pastSamplesAbove = 0;
-        futureSamplesAbove = 0;
+        detection.pastSpan = (int)param->getValue();
+        engine.resetDetectors();
     }
     else if (param->getName().equalsIgnoreCase("future_span"))
     {
-        futureSpan = (int)param->getValue();
-        sampToReenable = pastSpan + futureSpan + 1;
-
-        inputHistory.reset();
-        inputHistory.resize(pastSpan + futureSpan + 2);
-        thresholdHistory.reset();
-        thresholdHistory.resize(pastSpan + futureSpan + 2);
-
-        // counters must reflect current contents of inputHistory and thresholdHistory
-        pastSamplesAbove = 0;
-        futureSamplesAbove = 0;
+        detection.futureSpan = (int)param->getValue();
+        engine.resetDetectors();
     }
     else if (param->getName().equalsIgnoreCase("past_strict"))
     {
-        pastStrict = (float)param->getValue();
+        detection.pastStrict = (float)param->getValue();
     }
     else if (param->getName().equalsIgnoreCase("future_strict"))
     {
-        futureStrict = (float)param->getValue();
+        detection.futureStrict = (float)param->getValue();
+    }
+    else if (param->getName().equalsIgnoreCase("early_decision"))
+    {
+        // the future counter is not maintained with early decisions
+        detection.earlyDecision = (bool)param->getValue();
+        engine.resetDetectors();
     }
     else if (param->getName().equalsIgnoreCase("use_jump_limit"))
     {
-        useJumpLimit = (bool)param->getValue();
+        detection.useJumpLimit = (bool)param->getValue();
     }
     else if (param->getName().equalsIgnoreCase("jump_limit"))
     {
-        jumpLimit = (float)param->getValue();
+        detection.jumpLimit = (float)param->getValue();
     }
     else if (param->getName().equalsIgnoreCase("jump_limit_sleep"))
     {
-        jumpLimitSleep = (float)param->getValue();
+        detection.jumpLimitSleep = (float)param->getValue();
+    }
+    else if (param->getName().equalsIgnoreCase("use_hysteresis"))
+    {
+        // directions are armed once the signal has been seen beyond the hysteresis
+        detection.useHysteresis = (bool)param->getValue();
+        engine.disarmHysteresis();
+    }
+    else if (param->getName().equalsIgnoreCase("hysteresis"))
+    {
+        detection.hysteresis = (float)param->getValue();
     }
     else if (param->getName().equalsIgnoreCase("use_buffer_end_mask"))
     {
-        useBufferEndMask = (bool)param->getValue();
+        detection.useBufferEndMask = (bool)param->getValue();
     }
     else if (param->getName().equalsIgnoreCase("buffer_end_mask"))
     {
-        bufferEndMaskMs = (int)param->getValue();
-        for (auto stream : getDataStreams())
-        {
-            settings[stream->getStreamId()]->updateSampleRateDependentValues(eventDuration, timeout, bufferEndMaskMs);
-        }
+        detection.bufferEndMaskMs = (int)param->getValue();
+        engine.updateSampleRateDependentValues();
     }
     
 }
 
+bool CrossingDetector::acceptPrefilterChange(Parameter* param, float inUse)
+{
+    const juce::uint16 streamId = param->getStreamId();
+    DataStream* stream = getDataStream(streamId);
+    const CrossingEngine& engine = settings[streamId]->engine;
+
+    // the stream's parameters rather than the engine's settings, which are applied one by one
+    CrossingEngine::Settings candidate = engine.settings;
+    candidate.decimation = (int)stream->getParameter("decimation")->getValue();
+    candidate.prefilterType = static_cast<BiquadCascade::Type>((int)stream->getParameter("prefilter_type")->getValue());
+    candidate.prefilterLowCut = (float)stream->getParameter("prefilter_low_cut")->getValue();
+    candidate.prefilterHighCut = (float)stream->getParameter("prefilter_high_cut")->getValue();
+
+    const std::string error = CrossingEngine::checkPrefilter(candidate, engine.sampleRate);
+    if (error.empty() || (float)param->getValue() == inUse)
+    {
+        return true;
+    }
+
+    LOGE("[Crossing Detector] Invalid ", param->getName(), ": ", String(error));
+    CoreServices::sendStatusMessage("Crossing Detector: " + String(error));
+
+    // setting it back calls parameterValueChanged() again, which accepts the value in use
+    param->setNextValue(inUse);
+
+    if (auto* crossingEditor = static_cast<CrossingDetectorEditor*>(getEditor()))
+    {
+        crossingEditor->updateVisualizer();
+    }
+    return false;
+}
 
 bool CrossingDetector::startAcquisition()
 {
-    jumpLimitElapsed = jumpLimitSleep * getDataStream(selectedStreamId)->getSampleRate();
-
     for(auto stream : getDataStreams())
     {
-        settings[stream->getStreamId()]->
-            updateSampleRateDependentValues(eventDuration, timeout, bufferEndMaskMs);
+        settings[stream->getStreamId()]->engine.start(EXPECTED_MAX_BUFFER_SIZE);
     }
 
+#if CROSSING_DETECTOR_TRACING
+    File traceFile = File::getSpecialLocation(File::tempDirectory)
+        .getNonexistentChildFile("crossing-detector-trace", ".json", false);
+    if (TraceRecorder::getInstance().start(traceFile.getFullPathName().toStdString()))
+    {
+        LOGC("[Crossing Detector] Recording a trace to ", String(TraceRecorder::getInstance().getPath()));
+    }
+    else
+    {
+        LOGE("[Crossing Detector] Could not open ", traceFile.getFullPathName(), " to record a trace");
+    }
+#endif
+
     return isEnabled;
 }
 
 bool CrossingDetector::stopAcquisition()
 {
-    // set this to pastSpan so that we don't trigger on old data when we start again.
-    sampToReenable = pastSpan + futureSpan + 1;    
-    // cancel any pending turning-off per stream
+#if CROSSING_DETECTOR_TRACING
+    TraceRecorder::getInstance().stop();
+#endif
+
     for(auto stream : getDataStreams())
     {
-        settings[stream->getStreamId()]->turnoffEvent = nullptr;
+        settings[stream->getStreamId()]->engine.stop();
     }
     
     return true;
@@ -627,20 +710,52 @@ bool CrossingDetector::stopAcquisition()
 void CrossingDetector::setSelectedStream(juce::uint16 streamId)
 {
     selectedStreamId = streamId;
+    updateThresholdVal(streamId);
 }
 
 // ----- private functions ------
 
-
-float CrossingDetector::nextRandomThresh()
+void CrossingDetector::updateThresholdVal(juce::uint16 streamId)
 {
-    float range = randomThreshRange[1] - randomThreshRange[0];
-    return randomThreshRange[0] + range * rng.nextFloat();
+    if (streamId != selectedStreamId)
+    {
+        return;
+    }
+
+    CrossingDetectorSettings* settingsModule = settings[streamId];
+    const CrossingEngine::Settings& detection = settingsModule->engine.settings;
+
+    switch (detection.thresholdType)
+    {
+        case CONSTANT:
+            thresholdVal = detection.constantThresh;
+            break;
+
+        case RANDOM:
+            thresholdVal = settingsModule->currentThreshold.load(std::memory_order_relaxed);
+            break;
+
+        case CHANNEL:
+            thresholdVal = toChannelThreshString(settingsModule->thresholdChannel);
+            break;
+
+        case ADAPTIVE:
+            // current threshold of the first monitored channel, as of the last buffer
+            thresholdVal = settingsModule->currentThreshold.load(std::memory_order_relaxed);
+            break;
+
+        case PHASE:
+            thresholdVal = detection.phaseTarget;
+            break;
+
+        default:
+            break;
+    }
 }
 
 bool CrossingDetector::isCompatibleWithInput(int chanNum)
 {
-    if (settings[selectedStreamId]->inputChannel == chanNum 
+    if (settings[selectedStreamId]->inputChannels.contains(chanNum)
         && getDataStream(selectedStreamId)->getContinuousChannels()[chanNum] != nullptr)
     {
         return false;
@@ -653,34 +768,3 @@ String CrossingDetector::toChannelThreshString(int chanNum)
 {
     return "<chan " + String(chanNum + 1) + ">";
 }
-
-bool CrossingDetector::shouldTrigger(bool direction, float preVal, float postVal,
-    float preThresh, float postThresh)
-{
-
-    jassert(pastSamplesAbove >= 0 && futureSamplesAbove >= 0);
-    // check jumpLimit
-    if (useJumpLimit && abs(postVal - preVal) >= jumpLimit)
-    {
-        jumpLimitElapsed = 0;
-        return false;
-    }
-
-    if (jumpLimitElapsed <= (jumpLimitSleep * getDataStream(selectedStreamId)->getSampleRate()))
-    {
-        jumpLimitElapsed++;
-        return false;
-    }
-
-    // number of samples required before and after crossing threshold
-    int pastSamplesNeeded = pastSpan ? static_cast<int>(ceil(pastSpan * pastStrict)) : 0;
-    int futureSamplesNeeded = futureSpan ? static_cast<int>(ceil(futureSpan * futureStrict)) : 0;
-    
-    // four conditions for the event
-    bool preSat = direction != (preVal > preThresh);
-    bool postSat = direction == (postVal > postThresh);
-    bool pastSat = (direction ? pastSpan - pastSamplesAbove : pastSamplesAbove) >= pastSamplesNeeded;
-    bool futureSat = (direction ? futureSamplesAbove : futureSpan - futureSamplesAbove) >= futureSamplesNeeded;
-    
-    return preSat && postSat && pastSat && futureSat;
-}
@@ -25,24 +25,32 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define CROSSING_DETECTOR_H_INCLUDED
 
 #include <ProcessorHeaders.h>
-#include "CircularArray.h"
+#include "Engine/CrossingEngine.h"
+#include "PerfCounters.h"
+#include "TraceRecorder.h"
 
 /*
- * The crossing detector plugin is designed to read in one continuous channel c, and generate events on one events channel
- * when c crosses a certain value. There are various parameters to tweak this basic functionality, including:
+ * The crossing detector plugin is designed to read in one or more continuous channels, and generate events on one events channel
+ * when a channel c crosses a certain value. Each monitored channel has its own TTL line. There are various parameters to tweak this basic functionality, including:
  *  - whether to listen for crosses with a positive or negative slope, or either
  *  - how strictly to filter transient level changes, by adjusting the required number and percent of past and future samples to be above/below the threshold
  *  - the duration of the generated event
  *  - the minimum time to wait between events ("timeout")
  *  - whether to use a constant threshold, draw one randomly from a range for each event, or read thresholds from an input channel
+ *    (or to trigger at a target phase of the input instead)
+ *  - whether to high-pass or band-pass filter the monitored channels before detection
+ *  - whether to decimate the monitored channels, to detect at a lower rate than the stream's
  *
  * All ontinuous signals pass through unchanged, so multiple CrossingDetectors can be
- * chained together in order to operate on more than one channel.
+ * chained together in order to use different settings for different channels.
+ *
+ * The detection itself is done by a CrossingEngine per stream (see Engine/CrossingEngine.h),
+ * which doesn't depend on the GUI; the processor maps parameters, channels and events to it.
  *
  * @see GenericProcessor
  */
 
-/** Holds settings for one stream's crossing detector */
+/** Holds settings and detector state for one stream's crossing detector */
 class CrossingDetectorSettings
 {
 public:
@@ -52,39 +60,64 @@ public:
     /** Destructor*/
     ~CrossingDetectorSettings() { }
 
-    /** Converts parameters specified in ms to samples, and updates the corresponding member variables. */
-    void updateSampleRateDependentValues(int eventDuration, int timeout, int bufferEndMask);
+    /** Sets the monitored channels, which resets their detectors. */
+    void setChannels(const Array<int>& channels);
+
+    /** Select a new random threshold and use it for all channels of this stream. */
+    void resetRandomThresh();
+
+    /** Publishes the current threshold of random and adaptive thresholds for display. */
+    void publishThreshold();
 
-    /* Crate a "turning-on" or "turning-off" event for a crossing.
-     *  - bufferTs:       Timestamp of start of current buffer
-     *  - crossingOffset: Difference betweeen time of actual crossing and bufferTs
-     *  - bufferLength:   Number of samples in current buffer
+    /* Sets the metadata values from those of an event of the engine:
+     *  - crossingPoint:  Sample number of the actual crossing
      *  - threshold:      Threshold at the time of the crossing
      *  - crossingLevel:  Level of signal at the first sample after the crossing
+     *  - latency:        Samples from the crossing to the end of the buffer in which it was detected
+     *  - crossingTime:   Sample number of the crossing, interpolated between the samples around it
      */
-    TTLEventPtr createEvent(juce::int64 bufferTs, int crossingOffset, int bufferLength,
-        float threshold, float crossingLevel, bool eventState);
+    void setEventMetadata(const CrossingEngine::Event& event);
+
+    /* Creates the "turning-on" or "turning-off" TTL event for an event of the engine, with its metadata. */
+    TTLEventPtr createEvent(const CrossingEngine::Event& event);
+
+    /** TTL line of the channel at the given position in the bank */
+    int getEventLine(int bankIndex) const;
 
     /** Parameters */
 
-    int inputChannel; //Index of the inut channel
-    int eventChannel;
+    int eventChannel; // TTL line of the first monitored channel
 
     // if using channel threshold:
     int thresholdChannel;
-    
-    float sampleRate;
-    int eventDurationSamp;
-    int timeoutSamp;
-    int bufferEndMaskSamp;
+
+    Array<int> inputChannels; // local index of each monitored channel within the stream
+
+    // index in the processor's buffer of each continuous channel of the stream, as of the last
+    // updateSettings() (the stream's channel list is a copy, which process() can't make)
+    Array<int> globalChannelIndices;
 
     EventChannel* eventChannelPtr;
     MetadataDescriptorArray eventMetadataDescriptors;
-    TTLEventPtr turnoffEvent; // holds a turnoff event that must be added in a later buffer
-};
 
+    // Metadata values for the descriptors above, reused for every event
+    // (createTTLEvent copies them into the event).
+    MetadataValueArray eventMetadataValues;
+
+    /** Internals */
+
+    // The detector itself: the detection parameters, and the state of one detector per
+    // monitored channel. Filters, thresholds and the kernel run at the engine's detection rate.
+    CrossingEngine engine;
+
+    // samples of each monitored channel in the current buffer, for the engine
+    std::vector<const float*> inputPointers;
+
+    // Current random or adaptive threshold (of the first channel), written by the audio thread
+    // so that the message thread can display it without touching the detector state.
+    std::atomic<float> currentThreshold;
+};
 
-enum ThresholdType { CONSTANT = 0, RANDOM, CHANNEL, NUM_THRESHOLDS };
 
 class CrossingDetector : public GenericProcessor
 {
@@ -97,6 +130,14 @@ public:
 
     void updateSettings() override;
 
+    /** Runs the detectors of all enabled streams and adds their events.
+     *
+     *  Real-time contract: besides the TTL events themselves (which the GUI allocates when they
+     *  are created and added to the event buffer), this doesn't allocate memory, take locks or
+     *  make system calls for buffers of up to 4096 samples per stream. Everything it needs is
+     *  cached or reserved by updateSettings(), startAcquisition() and parameterValueChanged().
+     *  Streams are processed one after the other on the calling thread.
+     */
     void process(AudioSampleBuffer& continuousBuffer) override;
 
     /** Called when a parameter is updated*/
@@ -108,11 +149,19 @@ public:
     /** Get the current selected stream */
     juce::uint16 getSelectedStream() { return selectedStreamId; }
 
+    /** Updates thresholdVal if the given stream is the selected one. Must be called on the
+     *  message thread, e.g. periodically to follow random and adaptive thresholds.
+     */
+    void updateThresholdVal(juce::uint16 streamId);
+
+    /** Statistics of the processed buffers, to be read on the message thread */
+    const PerfCounters& getPerfCounters() const { return perfCounters; }
+
     /** Set the current selected stream */
     void setSelectedStream(juce::uint16 streamId);
 
     /* Returns true if the given chanNum corresponds to an input
-     * and that channel is not equal to the inputChannel.
+     * and that channel is not one of the monitored input channels.
      */
     bool isCompatibleWithInput(int chanNum);
     
@@ -120,83 +169,35 @@ private:
 
     // ---------------------------- PRIVATE FUNCTIONS ----------------------
 
-    /********** random threshold ***********/
+    /* Runs the detectors of one stream on the current buffer, adds its events and adds its
+     * statistics to 'record'.
+     */
+    void processStream(const DataStream* stream, const AudioSampleBuffer& continuousBuffer,
+        PerfCounters::Record& record);
+
+    /* Checks the input filter that the parameters of param's stream (decimation, filter type and
+     * cutoffs) describe. If it can't be used, reports why and sets param back to 'inUse', its
+     * value in the stream's engine, and returns false. The value in use is always accepted.
+     */
+    bool acceptPrefilterChange(Parameter* param, float inUse);
 
-    // Select a new random threshold using minThresh, maxThresh, and rng.
-    float nextRandomThresh();
- 
     /********** channel threshold ***********/
 
     // Returns a string to display in the threshold box when using a threshold channel
     static String toChannelThreshString(int chanNum);
 
-    /*********  triggering ************/
-
-    /* Whether there should be a trigger in the given direction (true = rising, float = falling),
-     * given the current pastCounter and futureCounter and the passed values and thresholds
-     * surrounding the point where a crossing may be.
-     */
-    bool shouldTrigger(bool direction, float preVal, float postVal, float preThresh, float postThresh);
-
 
     // ------ PARAMETERS ------------
 
     StreamSettings<CrossingDetectorSettings> settings;
-    ThresholdType thresholdType;
-
-    // if using constant threshold:
-    float constantThresh;
-
-    // if using random thresholds:
-    float randomThreshRange[2];
-    float currRandomThresh;
-
-    bool posOn;
-    bool negOn;
-
-    int eventDuration; // in milliseconds
-    int timeout; // milliseconds after an event onset when no more events are allowed.
-
-    bool useBufferEndMask;
-    int bufferEndMaskMs;
-
-    /* Number of *additional* past and future samples to look at at each timepoint (attention span)
-     * If futureSpan samples are not available to look ahead from a timepoint, the test is delayed until enough samples are available.
-     * If it succeeds, the event occurs on the first sample in the buffer when the test occurs, but the "crossing point"
-     * metadata field will contain the timepoint of the actual crossing.
-     */
-    int pastSpan;
-    int futureSpan;
-
-    // fraction of spans required to be above / below threshold
-    float pastStrict;
-    float futureStrict;
-
-    // maximum absolute difference between x[k] and x[k-1] to trigger an event on x[k]
-    bool useJumpLimit;
-    float jumpLimit;
-    float jumpLimitSleep;
-    int jumpLimitElapsed;
 
     // ------ INTERNALS -----------
 
-    // the next time at which the detector should be reenabled after a timeout period, measured in
-    // samples past the start of the current processing buffer. Less than -numNext if there is no scheduled reenable (i.e. the detector is enabled).
-    int sampToReenable;
-
-     // counters for delay keeping track of voting samples
-    int pastSamplesAbove;
-    int futureSamplesAbove;
+    Value thresholdVal; // underlying value of the threshold label (for the selected stream)
 
-    // arrays to implement past/future voting
-    CircularArray<float> inputHistory;
-    CircularArray<float> thresholdHistory;
+    Array<const DataStream*> streams; // getDataStreams() as of the last updateSettings(), for process()
 
-    Array<float> currThresholds;
-
-    Value thresholdVal; // underlying value of the threshold label
-    
-    Random rng; // for random thresholds
+    PerfCounters perfCounters; // one record per call to process()
 
     // Selected stream's ID
     juce::uint16 selectedStreamId;
@@ -28,6 +28,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /*************** canvas (extra settings) *******************/
 
 CrossingDetectorCanvas::CrossingDetectorCanvas(GenericProcessor* p)
+    : perfNext(0)
+    , perfReadCount(0)
 {
     processor = static_cast<CrossingDetector*>(p);
     editor = static_cast<CrossingDetectorEditor*>(processor->getEditor());
@@ -42,7 +44,13 @@ CrossingDetectorCanvas::~CrossingDetectorCanvas() {}
 
 void CrossingDetectorCanvas::refreshState() {}
 
-void CrossingDetectorCanvas::refresh() {}
+void CrossingDetectorCanvas::refresh()
+{
+    // follow random and adaptive thresholds
+    processor->updateThresholdVal(processor->getSelectedStream());
+
+    updatePerfViews();
+}
 
 void CrossingDetectorCanvas::paint(Graphics& g)
 {
@@ -76,6 +84,115 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
 
     Font subtitleFont("Fira Sans", "Bold", 16.0f);
 
+    /** ############## INPUT FILTER ############## */
+
+    filterGroupSet = new VerticalGroupSet("Input filter controls");
+    optionsPanel->addAndMakeVisible(filterGroupSet, 0);
+
+    xPos = LEFT_EDGE;
+    yPos += 45;
+
+    filterTitle = new Label("FilterTitle", "Input filter");
+    filterTitle->setBounds(bounds = { xPos, yPos, 200, 50 });
+    filterTitle->setFont(subtitleFont);
+    optionsPanel->addAndMakeVisible(filterTitle);
+    opBounds = opBounds.getUnion(bounds);
+
+    xPos += TAB_WIDTH;
+    yPos += 45;
+
+    static const String filterTT =
+        "Butterworth filter applied to the monitored channels before detection. Only the detector "
+        "sees the filtered signal; the continuous channels pass through unchanged.";
+
+    int filterType = (int)getStreamParameterValue("prefilter_type");
+
+    filterTypeBox = new ComboBox("filterType");
+    filterTypeBox->setBounds(bounds = { xPos, yPos, 100, C_TEXT_HT });
+    filterTypeBox->addItem("none", BiquadCascade::NONE + 1);
+    filterTypeBox->addItem("high-pass", BiquadCascade::HIGHPASS + 1);
+    filterTypeBox->addItem("band-pass", BiquadCascade::BANDPASS + 1);
+    filterTypeBox->setSelectedId(filterType + 1, dontSendNotification);
+    filterTypeBox->setTooltip(filterTT);
+    filterTypeBox->addListener(this);
+    optionsPanel->addAndMakeVisible(filterTypeBox);
+    opBounds = opBounds.getUnion(bounds);
+
+    filterOrderLabel = new Label("FilterOrderL", "order");
+    filterOrderLabel->setBounds(bounds = { xPos += 110, yPos, 45, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(filterOrderLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    filterOrderEditable = createEditable("FilterOrderE", String((int)getStreamParameterValue("prefilter_order")),
+        "Order of the Butterworth filter at each cutoff", bounds = { xPos += 45, yPos, 30, C_TEXT_HT });
+    filterOrderEditable->setEnabled(filterType != BiquadCascade::NONE);
+    optionsPanel->addAndMakeVisible(filterOrderEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    filterCutoffLabel = new Label("FilterCutoffL", "cutoff");
+    filterCutoffLabel->setBounds(bounds = { xPos += 40, yPos, 50, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(filterCutoffLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    filterLowCutEditable = createEditable("FilterLowE", String((float)getStreamParameterValue("prefilter_low_cut")),
+        "Low cutoff frequency", bounds = { xPos += 50, yPos, 50, C_TEXT_HT });
+    filterLowCutEditable->setEnabled(filterType != BiquadCascade::NONE);
+    optionsPanel->addAndMakeVisible(filterLowCutEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    filterToLabel = new Label("FilterToL", "-");
+    filterToLabel->setBounds(bounds = { xPos += 50, yPos, 20, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(filterToLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    filterHighCutEditable = createEditable("FilterHighE", String((float)getStreamParameterValue("prefilter_high_cut")),
+        "High cutoff frequency (band-pass only)", bounds = { xPos += 20, yPos, 50, C_TEXT_HT });
+    filterHighCutEditable->setEnabled(filterType == BiquadCascade::BANDPASS);
+    optionsPanel->addAndMakeVisible(filterHighCutEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    filterUnit = new Label("FilterUnitL", "Hz");
+    filterUnit->setBounds(bounds = { xPos += 55, yPos, 30, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(filterUnit);
+    opBounds = opBounds.getUnion(bounds);
+
+    filterGroupSet->addGroup({
+        filterTypeBox,
+        filterOrderLabel,
+        filterOrderEditable,
+        filterCutoffLabel,
+        filterLowCutEditable,
+        filterToLabel,
+        filterHighCutEditable,
+        filterUnit
+    });
+
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 30;
+
+    decimationLabel = new Label("DecimationL", "Decimate by");
+    decimationLabel->setBounds(bounds = { xPos, yPos, 90, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(decimationLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    decimationEditable = createEditable("DecimationE", String((int)getStreamParameterValue("decimation")),
+        "Detect at the stream's sample rate divided by this factor, after an anti-aliasing filter. "
+        "Saves CPU when the signal of interest is well below the Nyquist frequency; events are still "
+        "placed at the stream's sample numbers.", bounds = { xPos += 90, yPos, 30, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(decimationEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    decimationRateLabel = new Label("DecimationRateL", "before detection (1 = none)");
+    decimationRateLabel->setBounds(bounds = { xPos += 35, yPos, 200, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(decimationRateLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    filterGroupSet->addGroup({
+        decimationLabel,
+        decimationEditable,
+        decimationRateLabel
+    });
+
     /** ############## THRESHOLD TYPE ############## */
 
     thresholdGroupSet = new VerticalGroupSet("Threshold controls");
@@ -99,14 +216,14 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     constantThreshButton->setLookAndFeel(&rbLookAndFeel);
     constantThreshButton->setRadioGroupId(threshRadioId, dontSendNotification);
     constantThreshButton->setBounds(bounds = { xPos, yPos, 160, C_TEXT_HT });
-    constantThreshButton->setToggleState((int)processor->getParameter("threshold_type")->getValue() == ThresholdType::CONSTANT,
+    constantThreshButton->setToggleState((int)getStreamParameterValue("threshold_type") == ThresholdType::CONSTANT,
         dontSendNotification);
     constantThreshButton->setTooltip("Use a constant threshold (set on the main editor panel in the signal chain)");
     constantThreshButton->addListener(this);
     optionsPanel->addAndMakeVisible(constantThreshButton);
     opBounds = opBounds.getUnion(bounds);
 
-    constantThreshValue = createEditable("ConstantThresholdValue", String((float)processor->getParameter("constant_threshold")->getValue()),
+    constantThreshValue = createEditable("ConstantThresholdValue", String((float)getStreamParameterValue("constant_threshold")),
         "Constant threshold voltage", bounds = { xPos += 160, yPos, 50, C_TEXT_HT });
     constantThreshValue->setEnabled(constantThreshButton->getToggleState());
     optionsPanel->addAndMakeVisible(constantThreshValue);
@@ -124,7 +241,7 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     randomizeButton->setLookAndFeel(&rbLookAndFeel);
     randomizeButton->setRadioGroupId(threshRadioId, dontSendNotification);
     randomizeButton->setBounds(bounds = { xPos, yPos, 325, C_TEXT_HT });
-    randomizeButton->setToggleState((int)processor->getParameter("threshold_type")->getValue() == ThresholdType::RANDOM,
+    randomizeButton->setToggleState((int)getStreamParameterValue("threshold_type") == ThresholdType::RANDOM,
         dontSendNotification);
     randomizeButton->setTooltip("After each event, choose a new threshold sampled uniformly at random from the given range");
     randomizeButton->addListener(this);
@@ -139,7 +256,7 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     optionsPanel->addAndMakeVisible(minThreshLabel);
     opBounds = opBounds.getUnion(bounds);
 
-    minThreshEditable = createEditable("MinThreshE", String((float)processor->getParameter("min_random_threshold")->getValue()),
+    minThreshEditable = createEditable("MinThreshE", String((float)getStreamParameterValue("min_random_threshold")),
         "Minimum threshold voltage", bounds = { xPos += 80, yPos, 50, C_TEXT_HT });
     minThreshEditable->setEnabled(randomizeButton->getToggleState());
     optionsPanel->addAndMakeVisible(minThreshEditable);
@@ -150,7 +267,7 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     optionsPanel->addAndMakeVisible(maxThreshLabel);
     opBounds = opBounds.getUnion(bounds);
 
-    maxThreshEditable = createEditable("MaxThreshE", String((float)processor->getParameter("max_random_threshold")->getValue()),
+    maxThreshEditable = createEditable("MaxThreshE", String((float)getStreamParameterValue("max_random_threshold")),
         "Maximum threshold voltage", bounds = { xPos += 80, yPos, 50, C_TEXT_HT });
     maxThreshEditable->setEnabled(randomizeButton->getToggleState());
     optionsPanel->addAndMakeVisible(maxThreshEditable);
@@ -173,7 +290,7 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     channelThreshButton->setLookAndFeel(&rbLookAndFeel);
     channelThreshButton->setRadioGroupId(threshRadioId, dontSendNotification);
     channelThreshButton->setBounds(bounds = { xPos, yPos, 200, C_TEXT_HT });
-    channelThreshButton->setToggleState((int)processor->getParameter("threshold_type")->getValue() == ThresholdType::CHANNEL,
+    channelThreshButton->setToggleState((int)getStreamParameterValue("threshold_type") == ThresholdType::CHANNEL,
         dontSendNotification);
     channelThreshButton->setEnabled(false); // only enabled when channelThreshBox is populated
     channelThreshButton->setTooltip("At each sample, compare the level of the input channel with a given threshold channel");
@@ -193,6 +310,188 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
 
     thresholdGroupSet->addGroup({ channelThreshButton, channelThreshBox });
 
+    /* ------------ Adaptive threshold ---------- */
+
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 40;
+
+    bool adaptiveOn = (int)getStreamParameterValue("threshold_type") == ThresholdType::ADAPTIVE;
+
+    adaptiveThreshButton = new ToggleButton("Adaptive:");
+    adaptiveThreshButton->setLookAndFeel(&rbLookAndFeel);
+    adaptiveThreshButton->setRadioGroupId(threshRadioId, dontSendNotification);
+    adaptiveThreshButton->setBounds(bounds = { xPos, yPos, 95, C_TEXT_HT });
+    adaptiveThreshButton->setToggleState(adaptiveOn, dontSendNotification);
+    adaptiveThreshButton->setTooltip("Use a multiple of a moving estimate of each input channel's amplitude "
+        "(a negative multiple gives a threshold below zero)");
+    adaptiveThreshButton->addListener(this);
+    optionsPanel->addAndMakeVisible(adaptiveThreshButton);
+    opBounds = opBounds.getUnion(bounds);
+
+    adaptiveMultEditable = createEditable("AdaptiveMultE", String((float)getStreamParameterValue("adaptive_multiplier")),
+        "Multiple of the amplitude estimate", bounds = { xPos += 100, yPos, 40, C_TEXT_HT });
+    adaptiveMultEditable->setEnabled(adaptiveOn);
+    optionsPanel->addAndMakeVisible(adaptiveMultEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    adaptiveTimesLabel = new Label("AdaptiveTimesL", "x");
+    adaptiveTimesLabel->setBounds(bounds = { xPos += 40, yPos, 20, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(adaptiveTimesLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    adaptiveEstimatorBox = new ComboBox("adaptiveEstimator");
+    adaptiveEstimatorBox->setBounds(bounds = { xPos += 25, yPos, 90, C_TEXT_HT });
+    adaptiveEstimatorBox->addItem("RMS", AdaptiveThreshold::RMS + 1);
+    adaptiveEstimatorBox->addItem("mean |x|", AdaptiveThreshold::MEAN_ABS + 1);
+    adaptiveEstimatorBox->addItem("median |x|", AdaptiveThreshold::MEDIAN_ABS + 1);
+    adaptiveEstimatorBox->setSelectedId((int)getStreamParameterValue("adaptive_estimator") + 1, dontSendNotification);
+    adaptiveEstimatorBox->addListener(this);
+    adaptiveEstimatorBox->setEnabled(adaptiveOn);
+    optionsPanel->addAndMakeVisible(adaptiveEstimatorBox);
+    opBounds = opBounds.getUnion(bounds);
+
+    adaptiveTimeConstLabel = new Label("AdaptiveTauL", "over");
+    adaptiveTimeConstLabel->setBounds(bounds = { xPos += 95, yPos, 40, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(adaptiveTimeConstLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    adaptiveTimeConstEditable = createEditable("AdaptiveTauE", String((int)getStreamParameterValue("adaptive_time_const")),
+        "Time constant of the moving average", bounds = { xPos += 40, yPos, 50, C_TEXT_HT });
+    adaptiveTimeConstEditable->setEnabled(adaptiveOn);
+    optionsPanel->addAndMakeVisible(adaptiveTimeConstEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    adaptiveTimeConstUnit = new Label("AdaptiveTauUnitL", "ms");
+    adaptiveTimeConstUnit->setBounds(bounds = { xPos += 55, yPos, 30, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(adaptiveTimeConstUnit);
+    opBounds = opBounds.getUnion(bounds);
+
+    xPos = LEFT_EDGE + 2 * TAB_WIDTH;
+    yPos += 30;
+
+    bool medianOn = (int)getStreamParameterValue("adaptive_estimator") == AdaptiveThreshold::MEDIAN_ABS;
+
+    adaptiveUpdateLabel = new Label("AdaptiveUpdateL", "Recompute the median every");
+    adaptiveUpdateLabel->setBounds(bounds = { xPos, yPos, 215, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(adaptiveUpdateLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    adaptiveUpdateEditable = createEditable("AdaptiveUpdateE", String((int)getStreamParameterValue("adaptive_update")),
+        "The median threshold is constant in between", bounds = { xPos += 215, yPos, 50, C_TEXT_HT });
+    adaptiveUpdateEditable->setEnabled(adaptiveOn && medianOn);
+    optionsPanel->addAndMakeVisible(adaptiveUpdateEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    adaptiveUpdateUnit = new Label("AdaptiveUpdateUnitL", "ms");
+    adaptiveUpdateUnit->setBounds(bounds = { xPos += 55, yPos, 30, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(adaptiveUpdateUnit);
+    opBounds = opBounds.getUnion(bounds);
+
+    xPos = LEFT_EDGE + 2 * TAB_WIDTH;
+    yPos += 30;
+
+    static const String adaptiveFreezeTT = "Keep the threshold fixed once it has been calibrated "
+        "over the given time after the start of acquisition";
+
+    adaptiveFreezeButton = new ToggleButton("Freeze after calibrating for");
+    adaptiveFreezeButton->setBounds(bounds = { xPos, yPos, 215, C_TEXT_HT });
+    adaptiveFreezeButton->setToggleState((bool)getStreamParameterValue("use_adaptive_freeze"), dontSendNotification);
+    adaptiveFreezeButton->setTooltip(adaptiveFreezeTT);
+    adaptiveFreezeButton->addListener(this);
+    adaptiveFreezeButton->setEnabled(adaptiveOn);
+    optionsPanel->addAndMakeVisible(adaptiveFreezeButton);
+    opBounds = opBounds.getUnion(bounds);
+
+    adaptiveCalibrationEditable = createEditable("AdaptiveCalE", String((int)getStreamParameterValue("adaptive_calibration")),
+        adaptiveFreezeTT, bounds = { xPos += 215, yPos, 50, C_TEXT_HT });
+    adaptiveCalibrationEditable->setEnabled(adaptiveOn && adaptiveFreezeButton->getToggleState());
+    optionsPanel->addAndMakeVisible(adaptiveCalibrationEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    adaptiveCalibrationUnit = new Label("AdaptiveCalUnitL", "ms");
+    adaptiveCalibrationUnit->setBounds(bounds = { xPos += 55, yPos, 30, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(adaptiveCalibrationUnit);
+    opBounds = opBounds.getUnion(bounds);
+
+    thresholdGroupSet->addGroup({
+        adaptiveThreshButton,
+        adaptiveMultEditable,
+        adaptiveTimesLabel,
+        adaptiveEstimatorBox,
+        adaptiveTimeConstLabel,
+        adaptiveTimeConstEditable,
+        adaptiveTimeConstUnit,
+        adaptiveUpdateLabel,
+        adaptiveUpdateEditable,
+        adaptiveUpdateUnit,
+        adaptiveFreezeButton,
+        adaptiveCalibrationEditable,
+        adaptiveCalibrationUnit
+    });
+
+    /* ------------ Phase ---------- */
+
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 40;
+
+    bool phaseOn = (int)getStreamParameterValue("threshold_type") == ThresholdType::PHASE;
+
+    phaseThreshButton = new ToggleButton("Phase (deg):");
+    phaseThreshButton->setLookAndFeel(&rbLookAndFeel);
+    phaseThreshButton->setRadioGroupId(threshRadioId, dontSendNotification);
+    phaseThreshButton->setBounds(bounds = { xPos, yPos, 115, C_TEXT_HT });
+    phaseThreshButton->setToggleState(phaseOn, dontSendNotification);
+    phaseThreshButton->setTooltip("Trigger when the phase of each input channel in a frequency band reaches "
+        "a target (0 = peak, 180 = trough, -90 = rising zero crossing). The phase is estimated causally "
+        "within the plugin, and its wraps are never taken for crossings.");
+    phaseThreshButton->addListener(this);
+    optionsPanel->addAndMakeVisible(phaseThreshButton);
+    opBounds = opBounds.getUnion(bounds);
+
+    phaseTargetEditable = createEditable("PhaseTargetE", String((float)getStreamParameterValue("phase_target")),
+        "Target phase in degrees", bounds = { xPos += 120, yPos, 40, C_TEXT_HT });
+    phaseTargetEditable->setEnabled(phaseOn);
+    optionsPanel->addAndMakeVisible(phaseTargetEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    phaseAtLabel = new Label("PhaseAtL", "at");
+    phaseAtLabel->setBounds(bounds = { xPos += 40, yPos, 25, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(phaseAtLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    phaseFreqEditable = createEditable("PhaseFreqE", String((float)getStreamParameterValue("phase_freq")),
+        "Center frequency of the phase estimate", bounds = { xPos += 25, yPos, 40, C_TEXT_HT });
+    phaseFreqEditable->setEnabled(phaseOn);
+    optionsPanel->addAndMakeVisible(phaseFreqEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    phaseBandwidthLabel = new Label("PhaseBandwidthL", "Hz, bandwidth");
+    phaseBandwidthLabel->setBounds(bounds = { xPos += 45, yPos, 100, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(phaseBandwidthLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    phaseBandwidthEditable = createEditable("PhaseBandwidthE", String((float)getStreamParameterValue("phase_bandwidth")),
+        "A narrower band rejects more noise, but the phase of frequencies away from the center is estimated "
+        "less accurately", bounds = { xPos += 100, yPos, 40, C_TEXT_HT });
+    phaseBandwidthEditable->setEnabled(phaseOn);
+    optionsPanel->addAndMakeVisible(phaseBandwidthEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    phaseBandwidthUnit = new Label("PhaseBandwidthUnitL", "Hz");
+    phaseBandwidthUnit->setBounds(bounds = { xPos += 45, yPos, 30, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(phaseBandwidthUnit);
+    opBounds = opBounds.getUnion(bounds);
+
+    thresholdGroupSet->addGroup({
+        phaseThreshButton,
+        phaseTargetEditable,
+        phaseAtLabel,
+        phaseFreqEditable,
+        phaseBandwidthLabel,
+        phaseBandwidthEditable,
+        phaseBandwidthUnit
+    });
+
     /** ############## EVENT CRITERIA ############## */
 
     criteriaGroupSet = new VerticalGroupSet("Event criteria controls");
@@ -214,7 +513,7 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
 
     limitButton = new ToggleButton("Limit jump size across threshold (|X[k] - X[k-1]|)");
     limitButton->setBounds(bounds = { xPos, yPos, 420, C_TEXT_HT });
-    limitButton->setToggleState((bool)processor->getParameter("use_jump_limit")->getValue(), dontSendNotification);
+    limitButton->setToggleState((bool)getStreamParameterValue("use_jump_limit"), dontSendNotification);
     limitButton->addListener(this);
     optionsPanel->addAndMakeVisible(limitButton);
     opBounds = opBounds.getUnion(bounds);
@@ -224,7 +523,7 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     optionsPanel->addAndMakeVisible(limitLabel);
     opBounds = opBounds.getUnion(bounds);
 
-    limitEditable = createEditable("LimitE", String((float)processor->getParameter("jump_limit")->getValue()), "",
+    limitEditable = createEditable("LimitE", String((float)getStreamParameterValue("jump_limit")), "",
         bounds = { xPos += 150, yPos, 50, C_TEXT_HT });
     limitEditable->setEnabled(limitButton->getToggleState());
     optionsPanel->addAndMakeVisible(limitEditable);
@@ -236,7 +535,7 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     optionsPanel->addAndMakeVisible(limitSleepLabel);
     opBounds = opBounds.getUnion(bounds);
 
-    limitSleepEditable = createEditable("LimitSE", String((float)processor->getParameter("jump_limit_sleep")->getValue()), "",
+    limitSleepEditable = createEditable("LimitSE", String((float)getStreamParameterValue("jump_limit_sleep")), "",
         bounds = { xPos += 150, yPos, 50, C_TEXT_HT });
     limitSleepEditable->setEnabled(limitButton->getToggleState());
     optionsPanel->addAndMakeVisible(limitSleepEditable);
@@ -244,6 +543,31 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
 
     criteriaGroupSet->addGroup({ limitButton, limitLabel, limitEditable, limitSleepLabel, limitSleepEditable });
 
+    /* --------------- Hysteresis ------------------ */
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 40;
+
+    static const String hysteresisTT =
+        "After an event, don't trigger another one in the same direction until the signal has been "
+        "below (rising) or above (falling) the threshold by at least this amount. Suppresses chatter "
+        "around the threshold without the latency of sample voting.";
+
+    hysteresisButton = new ToggleButton("Rearm after passing back beyond threshold by");
+    hysteresisButton->setBounds(bounds = { xPos, yPos, 340, C_TEXT_HT });
+    hysteresisButton->setToggleState((bool)getStreamParameterValue("use_hysteresis"), dontSendNotification);
+    hysteresisButton->addListener(this);
+    hysteresisButton->setTooltip(hysteresisTT);
+    optionsPanel->addAndMakeVisible(hysteresisButton);
+    opBounds = opBounds.getUnion(bounds);
+
+    hysteresisEditable = createEditable("HysteresisE", String((float)getStreamParameterValue("hysteresis")),
+        hysteresisTT, bounds = { xPos += 340, yPos, 50, C_TEXT_HT });
+    hysteresisEditable->setEnabled(hysteresisButton->getToggleState());
+    optionsPanel->addAndMakeVisible(hysteresisEditable);
+    opBounds = opBounds.getUnion(bounds);
+
+    criteriaGroupSet->addGroup({ hysteresisButton, hysteresisEditable });
+
     /* --------------- Sample voting ------------------ */
     xPos = LEFT_EDGE + TAB_WIDTH;
     yPos += 40;
@@ -262,7 +586,7 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     optionsPanel->addAndMakeVisible(pastStrictLabel);
     opBounds = opBounds.getUnion(bounds);
 
-    pastPctEditable = createEditable("PastPctE", String(100 * (float)processor->getParameter("past_strict")->getValue()), "",
+    pastPctEditable = createEditable("PastPctE", String(100 * (float)getStreamParameterValue("past_strict")), "",
         bounds = { xPos += 75, yPos, 35, C_TEXT_HT });
     optionsPanel->addAndMakeVisible(pastPctEditable);
     opBounds = opBounds.getUnion(bounds);
@@ -272,7 +596,7 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     optionsPanel->addAndMakeVisible(pastPctLabel);
     opBounds = opBounds.getUnion(bounds);
 
-    pastSpanEditable = createEditable("PastSpanE", String((int)processor->getParameter("past_span")->getValue()), "",
+    pastSpanEditable = createEditable("PastSpanE", String((int)getStreamParameterValue("past_span")), "",
         bounds = { xPos += 70, yPos, 45, C_TEXT_HT });
     optionsPanel->addAndMakeVisible(pastSpanEditable);
     opBounds = opBounds.getUnion(bounds);
@@ -291,7 +615,7 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     optionsPanel->addAndMakeVisible(futureStrictLabel);
     opBounds = opBounds.getUnion(bounds);
 
-    futurePctEditable = createEditable("FuturePctE", String(100 * (float)processor->getParameter("future_strict")->getValue()), "",
+    futurePctEditable = createEditable("FuturePctE", String(100 * (float)getStreamParameterValue("future_strict")), "",
         bounds = { xPos += 75, yPos, 35, C_TEXT_HT });
     optionsPanel->addAndMakeVisible(futurePctEditable);
     opBounds = opBounds.getUnion(bounds);
@@ -301,7 +625,7 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     optionsPanel->addAndMakeVisible(futurePctLabel);
     opBounds = opBounds.getUnion(bounds);
 
-    futureSpanEditable = createEditable("FutureSpanE", String((int)processor->getParameter("future_span")->getValue()), "",
+    futureSpanEditable = createEditable("FutureSpanE", String((int)getStreamParameterValue("future_span")), "",
         bounds = { xPos += 70, yPos, 45, C_TEXT_HT });
     optionsPanel->addAndMakeVisible(futureSpanEditable);
     opBounds = opBounds.getUnion(bounds);
@@ -319,11 +643,23 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     optionsPanel->addAndMakeVisible(votingFooter);
     opBounds = opBounds.getUnion(bounds);
 
+    xPos = LEFT_EDGE + 2 * TAB_WIDTH;
+    yPos += 30;
+
+    earlyDecisionButton = new ToggleButton("Decide as soon as the future samples received guarantee or rule this out");
+    earlyDecisionButton->setBounds(bounds = { xPos, yPos, 480, C_TEXT_HT });
+    earlyDecisionButton->setToggleState((bool)getStreamParameterValue("early_decision"), dontSendNotification);
+    earlyDecisionButton->addListener(this);
+    earlyDecisionButton->setTooltip("Reduces the latency of events when voting on future samples. "
+        "The same crossings are detected, unless thresholds are drawn randomly.");
+    optionsPanel->addAndMakeVisible(earlyDecisionButton);
+    opBounds = opBounds.getUnion(bounds);
+
     criteriaGroupSet->addGroup({
         votingHeader,
         pastStrictLabel,   pastPctEditable,   pastPctLabel,   pastSpanEditable,   pastSpanLabel,
         futureStrictLabel, futurePctEditable, futurePctLabel, futureSpanEditable, futureSpanLabel,
-        votingFooter
+        votingFooter,      earlyDecisionButton
     });
 
 
@@ -340,13 +676,13 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
 
     bufferMaskButton = new ToggleButton("Ignore crossings ocurring >");
     bufferMaskButton->setBounds(bounds = { xPos, yPos, 225, C_TEXT_HT });
-    bufferMaskButton->setToggleState((bool)processor->getParameter("use_buffer_end_mask")->getValue(), dontSendNotification);
+    bufferMaskButton->setToggleState((bool)getStreamParameterValue("use_buffer_end_mask"), dontSendNotification);
     bufferMaskButton->addListener(this);
     bufferMaskButton->setTooltip(bufferMaskTT);
     optionsPanel->addAndMakeVisible(bufferMaskButton);
     opBounds = opBounds.getUnion(bounds);
 
-    bufferMaskEditable = createEditable("BufMaskE", String((int)processor->getParameter("buffer_end_mask")->getValue()),
+    bufferMaskEditable = createEditable("BufMaskE", String((int)getStreamParameterValue("buffer_end_mask")),
         bufferMaskTT, bounds = { xPos += 225, yPos, 40, C_TEXT_HT });
     bufferMaskEditable->setEnabled(bufferMaskButton->getToggleState());
     optionsPanel->addAndMakeVisible(bufferMaskEditable);
@@ -384,7 +720,7 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
     optionsPanel->addAndMakeVisible(durationLabel);
     opBounds = opBounds.getUnion(bounds);
 
-    durationEditable = createEditable("DurE", String((int)processor->getParameter("event_duration")->getValue()), "",
+    durationEditable = createEditable("DurE", String((int)getStreamParameterValue("event_duration")), "",
         bounds = { xPos += 120, yPos, 40, C_TEXT_HT });
     optionsPanel->addAndMakeVisible(durationEditable);
     opBounds = opBounds.getUnion(bounds);
@@ -396,14 +732,98 @@ void CrossingDetectorCanvas::initializeOptionsPanel()
 
     outputGroupSet->addGroup({ durationLabel, durationEditable, durationUnit });
 
+    /* ------------ Crossing time interpolation ------------ */
+
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 40;
+
+    static const String interpolationTT =
+        "How the \"Crossing time\" metadata of each event is estimated between the samples on "
+        "either side of the crossing";
+
+    interpolationLabel = new Label("InterpL", "Crossing time interpolation:");
+    interpolationLabel->setBounds(bounds = { xPos, yPos, 190, C_TEXT_HT });
+    interpolationLabel->setTooltip(interpolationTT);
+    optionsPanel->addAndMakeVisible(interpolationLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    interpolationBox = new ComboBox("interpolation");
+    interpolationBox->setBounds(bounds = { xPos += 195, yPos, 90, C_TEXT_HT });
+    interpolationBox->addItem("linear", CrossingKernel::LINEAR + 1);
+    interpolationBox->addItem("cubic", CrossingKernel::CUBIC + 1);
+    interpolationBox->setSelectedId((int)getStreamParameterValue("crossing_interpolation") + 1, dontSendNotification);
+    interpolationBox->setTooltip(interpolationTT);
+    interpolationBox->addListener(this);
+    optionsPanel->addAndMakeVisible(interpolationBox);
+    opBounds = opBounds.getUnion(bounds);
+
+    outputGroupSet->addGroup({ interpolationLabel, interpolationBox });
+
+    /** ############## PERFORMANCE ############## */
+
+    perfGroupSet = new VerticalGroupSet("Performance");
+    optionsPanel->addAndMakeVisible(perfGroupSet, 0);
+
+    xPos = LEFT_EDGE;
+    yPos += 40;
+
+    perfTitle = new Label("perfTitle", "Performance");
+    perfTitle->setBounds(bounds = { xPos, yPos, 150, 50 });
+    perfTitle->setFont(subtitleFont);
+    optionsPanel->addAndMakeVisible(perfTitle);
+    opBounds = opBounds.getUnion(bounds);
+
+    static const char* const perfRows[] = { "", "Time per buffer (us)", "Samples (x channels)",
+        "Candidates evaluated", "Events", "Decision latency (ms)" };
+    static const char* const perfColumns[] = { "p50", "p99", "max" };
+
+    yPos += 20;
+    for (int row = 0; row < 6; ++row)
+    {
+        xPos = LEFT_EDGE + TAB_WIDTH;
+        yPos += 25;
+
+        Label* name = createLabel("PerfRowL", perfRows[row], bounds = { xPos, yPos, 170, C_TEXT_HT });
+        perfLabels.add(name);
+        optionsPanel->addAndMakeVisible(name);
+        opBounds = opBounds.getUnion(bounds);
+
+        for (int col = 0; col < 3; ++col)
+        {
+            Label* value = createLabel("PerfValueL", row == 0 ? perfColumns[col] : "-",
+                bounds = { xPos += (col == 0 ? 175 : 70), yPos, 65, C_TEXT_HT });
+            value->setJustificationType(Justification::centredRight);
+            perfLabels.add(value);
+            optionsPanel->addAndMakeVisible(value);
+            opBounds = opBounds.getUnion(bounds);
+
+            if (row > 0)
+            {
+                perfValues.add(value);
+            }
+        }
+    }
+
+    xPos = LEFT_EDGE + TAB_WIDTH;
+    yPos += 25;
+
+    perfWindowLabel = createLabel("PerfWindowL", "No buffers processed yet",
+        bounds = { xPos, yPos, 380, C_TEXT_HT });
+    optionsPanel->addAndMakeVisible(perfWindowLabel);
+    opBounds = opBounds.getUnion(bounds);
+
+    perfGroupSet->addGroup({ perfLabels[0], perfWindowLabel });
+
     // some extra padding
     opBounds.setBottom(opBounds.getBottom() + 10);
     opBounds.setRight(opBounds.getRight() + 10);
 
     optionsPanel->setBounds(opBounds);
+    filterGroupSet->setBounds(opBounds);
     thresholdGroupSet->setBounds(opBounds);
     criteriaGroupSet->setBounds(opBounds);
     outputGroupSet->setBounds(opBounds);
+    perfGroupSet->setBounds(opBounds);
 }
 
 
@@ -411,22 +831,83 @@ void CrossingDetectorCanvas::comboBoxChanged(ComboBox* comboBoxThatHasChanged)
 {
     if (comboBoxThatHasChanged == channelThreshBox)
     {
-        DataStream *currStream = processor->getDataStream(processor->getSelectedStream());
-        currStream->getParameter("threshold_chan")->setNextValue(channelThreshBox->getSelectedId() - 1);
+        setStreamParameter("threshold_chan", channelThreshBox->getSelectedId() - 1);
+    }
+    else if (comboBoxThatHasChanged == adaptiveEstimatorBox)
+    {
+        int estimator = adaptiveEstimatorBox->getSelectedId() - 1;
+        adaptiveUpdateEditable->setEnabled(estimator == AdaptiveThreshold::MEDIAN_ABS);
+        setStreamParameter("adaptive_estimator", estimator);
+    }
+    else if (comboBoxThatHasChanged == filterTypeBox)
+    {
+        int filterType = filterTypeBox->getSelectedId() - 1;
+        filterOrderEditable->setEnabled(filterType != BiquadCascade::NONE);
+        filterLowCutEditable->setEnabled(filterType != BiquadCascade::NONE);
+        filterHighCutEditable->setEnabled(filterType == BiquadCascade::BANDPASS);
+        setStreamParameter("prefilter_type", filterType);
+    }
+    else if (comboBoxThatHasChanged == interpolationBox)
+    {
+        setStreamParameter("crossing_interpolation", interpolationBox->getSelectedId() - 1);
     }
 
 }
 
 void CrossingDetectorCanvas::labelTextChanged(Label* labelThatHasChanged)
 {
-    if (labelThatHasChanged == constantThreshValue)
+    // Input filter editable labels
+
+    if (labelThatHasChanged == filterOrderEditable)
+    {
+        int newVal;
+        int prevVal = (int)getStreamParameterValue("prefilter_order");
+        if (updateIntLabel(labelThatHasChanged, 1, BiquadCascade::MAX_ORDER, prevVal, &newVal))
+        {
+            setStreamParameter("prefilter_order", newVal);
+        }
+    }
+    else if (labelThatHasChanged == decimationEditable)
+    {
+        int newVal;
+        int prevVal = (int)getStreamParameterValue("decimation");
+        if (updateIntLabel(labelThatHasChanged, 1, PolyphaseDecimator::MAX_FACTOR, prevVal, &newVal))
+        {
+            setStreamParameter("decimation", newVal);
+        }
+    }
+    else if (labelThatHasChanged == filterLowCutEditable)
+    {
+        float newVal;
+        float prevVal = (float)getStreamParameterValue("prefilter_low_cut");
+        float highCut = (float)getStreamParameterValue("prefilter_high_cut");
+        bool bandpass = (int)getStreamParameterValue("prefilter_type") == BiquadCascade::BANDPASS;
+        if (updateFloatLabel(labelThatHasChanged, 0.01f, bandpass ? highCut : 100000.0f, prevVal, &newVal))
+        {
+            setStreamParameter("prefilter_low_cut", newVal);
+        }
+    }
+    else if (labelThatHasChanged == filterHighCutEditable)
+    {
+        float newVal;
+        float prevVal = (float)getStreamParameterValue("prefilter_high_cut");
+        float lowCut = (float)getStreamParameterValue("prefilter_low_cut");
+        if (updateFloatLabel(labelThatHasChanged, lowCut, 100000.0f, prevVal, &newVal))
+        {
+            setStreamParameter("prefilter_high_cut", newVal);
+        }
+    }
+
+    // Threshold editable labels
+
+    else if (labelThatHasChanged == constantThreshValue)
     {
         float newVal;
-        float prevVal = (float)processor->getParameter("constant_threshold")->getValue();
+        float prevVal = (float)getStreamParameterValue("constant_threshold");
         if (updateFloatLabel(labelThatHasChanged, -FLT_MAX, FLT_MAX,
             prevVal, &newVal))
         {
-            processor->getParameter("constant_threshold")->setNextValue(newVal);
+            setStreamParameter("constant_threshold", newVal);
         }
     }
 
@@ -434,37 +915,37 @@ void CrossingDetectorCanvas::labelTextChanged(Label* labelThatHasChanged)
     else if (labelThatHasChanged == pastPctEditable)
     {
         float newVal;
-        float prevVal = (float)processor->getParameter("past_strict")->getValue();
+        float prevVal = (float)getStreamParameterValue("past_strict");
         if (updateFloatLabel(labelThatHasChanged, 0, 100, 100 * prevVal, &newVal))
         {
-            processor->getParameter("past_strict")->setNextValue(newVal / 100);
+            setStreamParameter("past_strict", newVal / 100);
         }
     }
     else if (labelThatHasChanged == pastSpanEditable)
     {
         int newVal;
-        int prevVal = (int)processor->getParameter("past_span")->getValue();
+        int prevVal = (int)getStreamParameterValue("past_span");
         if (updateIntLabel(labelThatHasChanged, 0, INT_MAX, prevVal, &newVal))
         {
-            processor->getParameter("past_strict")->setNextValue(newVal);
+            setStreamParameter("past_span", newVal);
         }
     }
     else if (labelThatHasChanged == futurePctEditable)
     {
         float newVal;
-        float prevVal = (float)processor->getParameter("future_strict")->getValue();
+        float prevVal = (float)getStreamParameterValue("future_strict");
         if (updateFloatLabel(labelThatHasChanged, 0, 100, 100 * prevVal, &newVal))
         {
-            processor->getParameter("future_strict")->setNextValue(newVal / 100);
+            setStreamParameter("future_strict", newVal / 100);
         }
     }
     else if (labelThatHasChanged == futureSpanEditable)
     {
         int newVal;
-        int prevVal = (int)processor->getParameter("future_span")->getValue();
+        int prevVal = (int)getStreamParameterValue("future_span");
         if (updateIntLabel(labelThatHasChanged, 0, INT_MAX, prevVal, &newVal))
         {
-            processor->getParameter("future_span")->setNextValue(newVal);
+            setStreamParameter("future_span", newVal);
         }
     }
 
@@ -472,12 +953,12 @@ void CrossingDetectorCanvas::labelTextChanged(Label* labelThatHasChanged)
     else if (labelThatHasChanged == minThreshEditable)
     {
         float newVal;
-        float prevVal = (float)processor->getParameter("min_random_threshold")->getValue();
+        float prevVal = (float)getStreamParameterValue("min_random_threshold");
         if (updateFloatLabel(labelThatHasChanged,
             -FLT_MAX, FLT_MAX, prevVal, &newVal))
         {
-            processor->getParameter("min_random_threshold")->setNextValue(newVal);
-            if (newVal > (float)processor->getParameter("max_random_threshold")->getValue())
+            setStreamParameter("min_random_threshold", newVal);
+            if (newVal > (float)getStreamParameterValue("max_random_threshold"))
             {
                 // push the max thresh up to match
                 maxThreshEditable->setText(String(newVal), sendNotificationAsync);
@@ -487,12 +968,12 @@ void CrossingDetectorCanvas::labelTextChanged(Label* labelThatHasChanged)
     else if (labelThatHasChanged == maxThreshEditable)
     {
         float newVal;
-        float prevVal = (float)processor->getParameter("max_random_threshold")->getValue();
+        float prevVal = (float)getStreamParameterValue("max_random_threshold");
         if (updateFloatLabel(labelThatHasChanged,
             -FLT_MAX, FLT_MAX, prevVal, &newVal))
         {
-            processor->getParameter("max_random_threshold")->setNextValue(newVal);
-            if (newVal < (float)processor->getParameter("min_random_threshold")->getValue())
+            setStreamParameter("max_random_threshold", newVal);
+            if (newVal < (float)getStreamParameterValue("min_random_threshold"))
             {
                 // push the min down to match
                 minThreshEditable->setText(String(newVal), sendNotificationAsync);
@@ -500,32 +981,109 @@ void CrossingDetectorCanvas::labelTextChanged(Label* labelThatHasChanged)
         }
     }
 
+    // Adaptive threshold editable labels
+    else if (labelThatHasChanged == adaptiveMultEditable)
+    {
+        float newVal;
+        float prevVal = (float)getStreamParameterValue("adaptive_multiplier");
+        if (updateFloatLabel(labelThatHasChanged, -1000.0f, 1000.0f, prevVal, &newVal))
+        {
+            setStreamParameter("adaptive_multiplier", newVal);
+        }
+    }
+    else if (labelThatHasChanged == adaptiveTimeConstEditable)
+    {
+        int newVal;
+        int prevVal = (int)getStreamParameterValue("adaptive_time_const");
+        if (updateIntLabel(labelThatHasChanged, 1, INT_MAX, prevVal, &newVal))
+        {
+            setStreamParameter("adaptive_time_const", newVal);
+        }
+    }
+    else if (labelThatHasChanged == adaptiveUpdateEditable)
+    {
+        int newVal;
+        int prevVal = (int)getStreamParameterValue("adaptive_update");
+        if (updateIntLabel(labelThatHasChanged, 1, INT_MAX, prevVal, &newVal))
+        {
+            setStreamParameter("adaptive_update", newVal);
+        }
+    }
+    else if (labelThatHasChanged == adaptiveCalibrationEditable)
+    {
+        int newVal;
+        int prevVal = (int)getStreamParameterValue("adaptive_calibration");
+        if (updateIntLabel(labelThatHasChanged, 0, INT_MAX, prevVal, &newVal))
+        {
+            setStreamParameter("adaptive_calibration", newVal);
+        }
+    }
+
+    // Phase editable labels
+
+    else if (labelThatHasChanged == phaseTargetEditable)
+    {
+        float newVal;
+        float prevVal = (float)getStreamParameterValue("phase_target");
+        if (updateFloatLabel(labelThatHasChanged, -180.0f, 180.0f, prevVal, &newVal))
+        {
+            setStreamParameter("phase_target", newVal);
+        }
+    }
+    else if (labelThatHasChanged == phaseFreqEditable)
+    {
+        float newVal;
+        float prevVal = (float)getStreamParameterValue("phase_freq");
+        if (updateFloatLabel(labelThatHasChanged, 0.01f, 100000.0f, prevVal, &newVal))
+        {
+            setStreamParameter("phase_freq", newVal);
+        }
+    }
+    else if (labelThatHasChanged == phaseBandwidthEditable)
+    {
+        float newVal;
+        float prevVal = (float)getStreamParameterValue("phase_bandwidth");
+        if (updateFloatLabel(labelThatHasChanged, 0.01f, 100000.0f, prevVal, &newVal))
+        {
+            setStreamParameter("phase_bandwidth", newVal);
+        }
+    }
+
     // Event criteria editable labels
     else if (labelThatHasChanged == limitEditable)
     {
         float newVal;
-        float prevVal = (float)processor->getParameter("jump_limit")->getValue();
+        float prevVal = (float)getStreamParameterValue("jump_limit");
         if (updateFloatLabel(labelThatHasChanged, 0, FLT_MAX, prevVal, &newVal))
         {
-            processor->getParameter("jump_limit")->setNextValue(newVal);
+            setStreamParameter("jump_limit", newVal);
         }
     }
     else if (labelThatHasChanged == limitSleepEditable)
     {
 		float newVal;
-        float prevVal = (float)processor->getParameter("jump_limit_sleep")->getValue();
+        float prevVal = (float)getStreamParameterValue("jump_limit_sleep");
 		if (updateFloatLabel(labelThatHasChanged, 0, FLT_MAX, prevVal, &newVal))
         {
-            processor->getParameter("jump_limit_sleep")->setNextValue(newVal);
+            setStreamParameter("jump_limit_sleep", newVal);
+        }
+    }
+    else if (labelThatHasChanged == hysteresisEditable)
+    {
+        float newVal;
+        float prevVal = (float)getStreamParameterValue("hysteresis");
+        if (updateFloatLabel(labelThatHasChanged, 0, FLT_MAX, prevVal, &newVal))
+        {
+            setStreamParameter("hysteresis", newVal);
         }
     }
     else if (labelThatHasChanged == bufferMaskEditable)
     {
         int newVal;
-        int prevVal = (int)processor->getParameter("buffer_end_mask")->getValue();
+        int prevVal = (int)getStreamParameterValue("buffer_end_mask");
         if (updateIntLabel(labelThatHasChanged, 0, INT_MAX, prevVal, &newVal))
         {
-            processor->getParameter("buffer_end_mask")->setNextValue(newVal);
+            setStreamParameter("buffer_end_mask", newVal);
         }
     }
 
@@ -533,10 +1091,10 @@ void CrossingDetectorCanvas::labelTextChanged(Label* labelThatHasChanged)
     else if (labelThatHasChanged == durationEditable)
     {
         int newVal;
-        int prevVal = (int)processor->getParameter("event_duration")->getValue();
+        int prevVal = (int)getStreamParameterValue("event_duration");
         if (updateIntLabel(labelThatHasChanged, 0, INT_MAX, prevVal, &newVal))
         {
-            processor->getParameter("event_duration")->setNextValue(newVal);
+            setStreamParameter("event_duration", newVal);
         }
     }
 }
@@ -549,13 +1107,23 @@ void CrossingDetectorCanvas::buttonClicked(Button* button)
         bool limitOn = button->getToggleState();
         limitEditable->setEnabled(limitOn);
         limitSleepEditable->setEnabled(limitOn);
-        processor->getParameter("use_jump_limit")->setNextValue(limitOn);
+        setStreamParameter("use_jump_limit", limitOn);
+    }
+    else if (button == hysteresisButton)
+    {
+        bool hysteresisOn = button->getToggleState();
+        hysteresisEditable->setEnabled(hysteresisOn);
+        setStreamParameter("use_hysteresis", hysteresisOn);
+    }
+    else if (button == earlyDecisionButton)
+    {
+        setStreamParameter("early_decision", button->getToggleState());
     }
     else if (button == bufferMaskButton)
     {
         bool bufMaskOn = button->getToggleState();
         bufferMaskEditable->setEnabled(bufMaskOn);
-        processor->getParameter("use_buffer_end_mask")->setNextValue(bufMaskOn);
+        setStreamParameter("use_buffer_end_mask", bufMaskOn);
     }
 
     // Threshold radio buttons
@@ -565,7 +1133,7 @@ void CrossingDetectorCanvas::buttonClicked(Button* button)
         if (on)
         {
             constantThreshValue->setEnabled(true);
-            processor->getParameter("threshold_type")->setNextValue(ThresholdType::CONSTANT);
+            setStreamParameter("threshold_type", ThresholdType::CONSTANT);
         }
     }
     else if (button == randomizeButton)
@@ -576,7 +1144,7 @@ void CrossingDetectorCanvas::buttonClicked(Button* button)
         if (on)
         {
             constantThreshValue->setEnabled(false);
-            processor->getParameter("threshold_type")->setNextValue(ThresholdType::RANDOM);
+            setStreamParameter("threshold_type", ThresholdType::RANDOM);
         }
     }
     else if (button == channelThreshButton)
@@ -586,13 +1154,47 @@ void CrossingDetectorCanvas::buttonClicked(Button* button)
         if (on)
         {
             constantThreshValue->setEnabled(false);
-            processor->getParameter("threshold_type")->setNextValue(ThresholdType::CHANNEL);
+            setStreamParameter("threshold_type", ThresholdType::CHANNEL);
+        }
+    }
+    else if (button == adaptiveThreshButton)
+    {
+        bool on = button->getToggleState();
+        adaptiveMultEditable->setEnabled(on);
+        adaptiveEstimatorBox->setEnabled(on);
+        adaptiveTimeConstEditable->setEnabled(on);
+        adaptiveUpdateEditable->setEnabled(on && adaptiveEstimatorBox->getSelectedId() - 1 == AdaptiveThreshold::MEDIAN_ABS);
+        adaptiveFreezeButton->setEnabled(on);
+        adaptiveCalibrationEditable->setEnabled(on && adaptiveFreezeButton->getToggleState());
+        if (on)
+        {
+            constantThreshValue->setEnabled(false);
+            setStreamParameter("threshold_type", ThresholdType::ADAPTIVE);
+        }
+    }
+    else if (button == phaseThreshButton)
+    {
+        bool on = button->getToggleState();
+        phaseTargetEditable->setEnabled(on);
+        phaseFreqEditable->setEnabled(on);
+        phaseBandwidthEditable->setEnabled(on);
+        if (on)
+        {
+            constantThreshValue->setEnabled(false);
+            setStreamParameter("threshold_type", ThresholdType::PHASE);
         }
     }
+    else if (button == adaptiveFreezeButton)
+    {
+        bool freezeOn = button->getToggleState();
+        adaptiveCalibrationEditable->setEnabled(freezeOn);
+        setStreamParameter("use_adaptive_freeze", freezeOn);
+    }
 }
 
 void CrossingDetectorCanvas::update()
 {
+    updateParameterViews();
 
     // update channel threshold combo box
     int numChans = 0;
@@ -601,7 +1203,7 @@ void CrossingDetectorCanvas::update()
     if(selStreamId != 0)
         numChans = processor->getDataStream(selStreamId)->getChannelCount();
     
-    int currThreshId = channelThreshBox->getSelectedId();
+    int currThreshId = (int)getStreamParameterValue("threshold_chan") + 1;
     channelThreshBox->clear(dontSendNotification);
 
     for (int chan = 1; chan <= numChans; ++chan)
@@ -638,6 +1240,169 @@ void CrossingDetectorCanvas::update()
 
 /**************** private ******************/
 
+Parameter* CrossingDetectorCanvas::getStreamParameter(const String& name)
+{
+    DataStream* stream = processor->getDataStream(processor->getSelectedStream());
+    return stream != nullptr ? stream->getParameter(name) : nullptr;
+}
+
+var CrossingDetectorCanvas::getStreamParameterValue(const String& name)
+{
+    Parameter* param = getStreamParameter(name);
+    return param != nullptr ? param->getValue() : var();
+}
+
+void CrossingDetectorCanvas::setStreamParameter(const String& name, var value)
+{
+    if (Parameter* param = getStreamParameter(name))
+    {
+        param->setNextValue(value);
+    }
+}
+
+void CrossingDetectorCanvas::updateParameterViews()
+{
+    if (processor->getDataStream(processor->getSelectedStream()) == nullptr)
+    {
+        return;
+    }
+
+    int filterType = (int)getStreamParameterValue("prefilter_type");
+    filterTypeBox->setSelectedId(filterType + 1, dontSendNotification);
+    filterOrderEditable->setText(String((int)getStreamParameterValue("prefilter_order")), dontSendNotification);
+    filterOrderEditable->setEnabled(filterType != BiquadCascade::NONE);
+    filterLowCutEditable->setText(String((float)getStreamParameterValue("prefilter_low_cut")), dontSendNotification);
+    filterLowCutEditable->setEnabled(filterType != BiquadCascade::NONE);
+    filterHighCutEditable->setText(String((float)getStreamParameterValue("prefilter_high_cut")), dontSendNotification);
+    filterHighCutEditable->setEnabled(filterType == BiquadCascade::BANDPASS);
+    decimationEditable->setText(String((int)getStreamParameterValue("decimation")), dontSendNotification);
+
+    int threshType = (int)getStreamParameterValue("threshold_type");
+    constantThreshButton->setToggleState(threshType == ThresholdType::CONSTANT, dontSendNotification);
+    randomizeButton->setToggleState(threshType == ThresholdType::RANDOM, dontSendNotification);
+    channelThreshButton->setToggleState(threshType == ThresholdType::CHANNEL, dontSendNotification);
+    adaptiveThreshButton->setToggleState(threshType == ThresholdType::ADAPTIVE, dontSendNotification);
+
+    constantThreshValue->setText(String((float)getStreamParameterValue("constant_threshold")), dontSendNotification);
+    constantThreshValue->setEnabled(threshType == ThresholdType::CONSTANT);
+
+    minThreshEditable->setText(String((float)getStreamParameterValue("min_random_threshold")), dontSendNotification);
+    minThreshEditable->setEnabled(threshType == ThresholdType::RANDOM);
+    maxThreshEditable->setText(String((float)getStreamParameterValue("max_random_threshold")), dontSendNotification);
+    maxThreshEditable->setEnabled(threshType == ThresholdType::RANDOM);
+
+    channelThreshBox->setEnabled(threshType == ThresholdType::CHANNEL);
+
+    bool adaptiveOn = threshType == ThresholdType::ADAPTIVE;
+    bool freezeOn = (bool)getStreamParameterValue("use_adaptive_freeze");
+    adaptiveMultEditable->setText(String((float)getStreamParameterValue("adaptive_multiplier")), dontSendNotification);
+    adaptiveMultEditable->setEnabled(adaptiveOn);
+    adaptiveEstimatorBox->setSelectedId((int)getStreamParameterValue("adaptive_estimator") + 1, dontSendNotification);
+    adaptiveEstimatorBox->setEnabled(adaptiveOn);
+    adaptiveTimeConstEditable->setText(String((int)getStreamParameterValue("adaptive_time_const")), dontSendNotification);
+    adaptiveTimeConstEditable->setEnabled(adaptiveOn);
+    adaptiveUpdateEditable->setText(String((int)getStreamParameterValue("adaptive_update")), dontSendNotification);
+    adaptiveUpdateEditable->setEnabled(adaptiveOn
+        && (int)getStreamParameterValue("adaptive_estimator") == AdaptiveThreshold::MEDIAN_ABS);
+    adaptiveFreezeButton->setToggleState(freezeOn, dontSendNotification);
+    adaptiveFreezeButton->setEnabled(adaptiveOn);
+    adaptiveCalibrationEditable->setText(String((int)getStreamParameterValue("adaptive_calibration")), dontSendNotification);
+    adaptiveCalibrationEditable->setEnabled(adaptiveOn && freezeOn);
+
+    bool phaseOn = threshType == ThresholdType::PHASE;
+    phaseThreshButton->setToggleState(phaseOn, dontSendNotification);
+    phaseTargetEditable->setText(String((float)getStreamParameterValue("phase_target")), dontSendNotification);
+    phaseTargetEditable->setEnabled(phaseOn);
+    phaseFreqEditable->setText(String((float)getStreamParameterValue("phase_freq")), dontSendNotification);
+    phaseFreqEditable->setEnabled(phaseOn);
+    phaseBandwidthEditable->setText(String((float)getStreamParameterValue("phase_bandwidth")), dontSendNotification);
+    phaseBandwidthEditable->setEnabled(phaseOn);
+
+    bool limitOn = (bool)getStreamParameterValue("use_jump_limit");
+    limitButton->setToggleState(limitOn, dontSendNotification);
+    limitEditable->setText(String((float)getStreamParameterValue("jump_limit")), dontSendNotification);
+    limitEditable->setEnabled(limitOn);
+    limitSleepEditable->setText(String((float)getStreamParameterValue("jump_limit_sleep")), dontSendNotification);
+    limitSleepEditable->setEnabled(limitOn);
+
+    bool hysteresisOn = (bool)getStreamParameterValue("use_hysteresis");
+    hysteresisButton->setToggleState(hysteresisOn, dontSendNotification);
+    hysteresisEditable->setText(String((float)getStreamParameterValue("hysteresis")), dontSendNotification);
+    hysteresisEditable->setEnabled(hysteresisOn);
+
+    pastPctEditable->setText(String(100 * (float)getStreamParameterValue("past_strict")), dontSendNotification);
+    pastSpanEditable->setText(String((int)getStreamParameterValue("past_span")), dontSendNotification);
+    futurePctEditable->setText(String(100 * (float)getStreamParameterValue("future_strict")), dontSendNotification);
+    futureSpanEditable->setText(String((int)getStreamParameterValue("future_span")), dontSendNotification);
+    earlyDecisionButton->setToggleState((bool)getStreamParameterValue("early_decision"), dontSendNotification);
+
+    bool bufMaskOn = (bool)getStreamParameterValue("use_buffer_end_mask");
+    bufferMaskButton->setToggleState(bufMaskOn, dontSendNotification);
+    bufferMaskEditable->setText(String((int)getStreamParameterValue("buffer_end_mask")), dontSendNotification);
+    bufferMaskEditable->setEnabled(bufMaskOn);
+
+    durationEditable->setText(String((int)getStreamParameterValue("event_duration")), dontSendNotification);
+    interpolationBox->setSelectedId((int)getStreamParameterValue("crossing_interpolation") + 1, dontSendNotification);
+}
+
+void CrossingDetectorCanvas::updatePerfViews()
+{
+    if (perfPulled.empty())
+    {
+        perfPulled.resize(PerfCounters::CAPACITY);
+        perfRecords.reserve(PerfCounters::CAPACITY);
+    }
+
+    int numNew = processor->getPerfCounters().pull(perfPulled.data(), perfReadCount);
+    if (numNew == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < numNew; ++i)
+    {
+        if (perfRecords.size() < size_t(PerfCounters::CAPACITY))
+        {
+            perfRecords.push_back(perfPulled[size_t(i)]);
+        }
+        else
+        {
+            perfRecords[size_t(perfNext)] = perfPulled[size_t(i)];
+        }
+        perfNext = (perfNext + 1) % PerfCounters::CAPACITY;
+    }
+
+    // percentiles of each statistic over the recent buffers
+    std::vector<float> values(perfRecords.size());
+    const int numStats = perfValues.size() / 3;
+    for (int stat = 0; stat < numStats; ++stat)
+    {
+        for (size_t i = 0; i < perfRecords.size(); ++i)
+        {
+            const PerfCounters::Record& r = perfRecords[i];
+            switch (stat)
+            {
+            case 0:  values[i] = r.processUs; break;
+            case 1:  values[i] = float(r.samples); break;
+            case 2:  values[i] = float(r.candidates); break;
+            case 3:  values[i] = float(r.events); break;
+            default: values[i] = r.maxLatencyMs; break;
+            }
+        }
+
+        static const float percentiles[] = { 0.5f, 0.99f, 1.0f };
+        for (int col = 0; col < 3; ++col)
+        {
+            auto nth = values.begin() + int(percentiles[col] * float(values.size() - 1));
+            std::nth_element(values.begin(), nth, values.end());
+            perfValues[3 * stat + col]->setText(String(*nth, stat == 0 || stat == 4 ? 2 : 0), dontSendNotification);
+        }
+    }
+
+    perfWindowLabel->setText("Over the last " + String(int(perfRecords.size())) + " buffers",
+        dontSendNotification);
+}
+
 
 Label* CrossingDetectorCanvas::createEditable(const String& name, const String& initialValue,
     const String& tooltip, juce::Rectangle<int> bounds)
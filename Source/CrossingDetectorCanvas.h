@@ -30,10 +30,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 /*
 Canvas/visualizer contains:
-- Threshold type selection - constant, adaptive, random, or channel (with parameters)
+- Input filter selection - none, high-pass or band-pass (with order and cutoffs), and decimation factor
+- Threshold type selection - constant, adaptive, random, channel or phase (with parameters)
 - Jump limiting toggle and max jump box
 - Voting settings (pre/post event span and strictness)
-- Event duration control
+- Event duration and crossing time interpolation controls
+- Performance statistics of recent buffers (while acquiring)
 
 @see Visualizer
 */
@@ -120,12 +122,42 @@ private:
 
     void initializeOptionsPanel();
 
+    /* All settings shown on the canvas belong to the stream that is selected in the editor.
+    *  These access its parameters and do nothing if no stream is selected.
+    */
+    Parameter* getStreamParameter(const String& name);
+    var getStreamParameterValue(const String& name);
+    void setStreamParameter(const String& name, var value);
+
+    // Shows the parameter values of the selected stream
+    void updateParameterViews();
+
+    // Adds the statistics of the buffers processed since the last call and shows their percentiles
+    void updatePerfViews();
+
     RadioButtonLookAndFeel rbLookAndFeel;
 
     // --- Canvas elements are managed by editor but invisible until visualizer is opened ----
     ScopedPointer<Component> optionsPanel;
 
     ScopedPointer<Label> optionsPanelTitle;
+
+    /****** input filter section ******/
+
+    ScopedPointer<Label> filterTitle;
+    ScopedPointer<VerticalGroupSet> filterGroupSet;
+
+    ScopedPointer<ComboBox> filterTypeBox;
+    ScopedPointer<Label> filterOrderLabel;
+    ScopedPointer<Label> filterOrderEditable;
+    ScopedPointer<Label> filterCutoffLabel;
+    ScopedPointer<Label> filterLowCutEditable;
+    ScopedPointer<Label> filterToLabel;
+    ScopedPointer<Label> filterHighCutEditable;
+    ScopedPointer<Label> filterUnit;
+    ScopedPointer<Label> decimationLabel;
+    ScopedPointer<Label> decimationEditable;
+    ScopedPointer<Label> decimationRateLabel;
     
     /****** threshold section ******/
 
@@ -147,6 +179,30 @@ private:
     ScopedPointer<ToggleButton> channelThreshButton;
     ScopedPointer<ComboBox> channelThreshBox;
 
+    // adaptive threshold
+    ScopedPointer<ToggleButton> adaptiveThreshButton;
+    ScopedPointer<Label> adaptiveMultEditable;
+    ScopedPointer<Label> adaptiveTimesLabel;
+    ScopedPointer<ComboBox> adaptiveEstimatorBox;
+    ScopedPointer<Label> adaptiveTimeConstLabel;
+    ScopedPointer<Label> adaptiveTimeConstEditable;
+    ScopedPointer<Label> adaptiveTimeConstUnit;
+    ScopedPointer<Label> adaptiveUpdateLabel;
+    ScopedPointer<Label> adaptiveUpdateEditable;
+    ScopedPointer<Label> adaptiveUpdateUnit;
+    ScopedPointer<ToggleButton> adaptiveFreezeButton;
+    ScopedPointer<Label> adaptiveCalibrationEditable;
+    ScopedPointer<Label> adaptiveCalibrationUnit;
+
+    // phase
+    ScopedPointer<ToggleButton> phaseThreshButton;
+    ScopedPointer<Label> phaseTargetEditable;
+    ScopedPointer<Label> phaseAtLabel;
+    ScopedPointer<Label> phaseFreqEditable;
+    ScopedPointer<Label> phaseBandwidthLabel;
+    ScopedPointer<Label> phaseBandwidthEditable;
+    ScopedPointer<Label> phaseBandwidthUnit;
+
     /******* criteria section *******/
 
     ScopedPointer<Label> criteriaTitle;
@@ -159,6 +215,10 @@ private:
     ScopedPointer<Label> limitSleepLabel;
     ScopedPointer<Label> limitSleepEditable;
 
+    // hysteresis
+    ScopedPointer<ToggleButton> hysteresisButton;
+    ScopedPointer<Label> hysteresisEditable;
+
     // sample voting
     ScopedPointer<Label> votingHeader;
     
@@ -175,6 +235,7 @@ private:
     ScopedPointer<Label> futureSpanEditable;
 
     ScopedPointer<Label> votingFooter;
+    ScopedPointer<ToggleButton> earlyDecisionButton;
 
     // buffer end mask
     ScopedPointer<ToggleButton> bufferMaskButton;
@@ -191,6 +252,25 @@ private:
     ScopedPointer<Label> durationEditable;
     ScopedPointer<Label> durationUnit;
 
+    // crossing time interpolation
+    ScopedPointer<Label> interpolationLabel;
+    ScopedPointer<ComboBox> interpolationBox;
+
+    /******** performance section *******/
+
+    ScopedPointer<Label> perfTitle;
+    ScopedPointer<VerticalGroupSet> perfGroupSet;
+
+    // one row per statistic: name, then p50, p99 and max over the recent buffers
+    OwnedArray<Label> perfLabels;
+    Array<Label*> perfValues;
+    ScopedPointer<Label> perfWindowLabel;
+
+    std::vector<PerfCounters::Record> perfRecords; // the last PerfCounters::CAPACITY buffers, as a ring
+    std::vector<PerfCounters::Record> perfPulled;  // buffers published since the last refresh
+    int perfNext;
+    int64_t perfReadCount;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CrossingDetectorCanvas);
 };
 
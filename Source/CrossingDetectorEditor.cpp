@@ -39,7 +39,9 @@ CustomButton::CustomButton(Parameter* param, String label) : ParameterEditor(par
 
 void CustomButton::buttonClicked(Button*)
 {
-    param->setNextValue(button->getToggleState());
+    // not bound while there is no stream
+    if (param != nullptr)
+        param->setNextValue(button->getToggleState());
 }
 
 void CustomButton::updateView()
@@ -62,11 +64,12 @@ CrossingDetectorEditor::CrossingDetectorEditor(GenericProcessor* parentNode)
 
     addComboBoxParameterEditor("TTL_OUT", 110, 25);
 
-    Parameter* customParam = getProcessor()->getParameter("Rising");
-    addCustomParameterEditor(new CustomButton(customParam, "Rising"), 15, 70);
+    // stream-scoped: rebound when the selected stream changes
+    risingButton = new CustomButton(getStreamParameter("Rising"), "Rising");
+    addCustomParameterEditor(risingButton, 15, 70);
 
-    customParam = getProcessor()->getParameter("Falling");
-    addCustomParameterEditor(new CustomButton(customParam, "Falling"), 15, 95);
+    fallingButton = new CustomButton(getStreamParameter("Falling"), "Falling");
+    addCustomParameterEditor(fallingButton, 15, 95);
 
     addTextBoxParameterEditor("Timeout_ms", 110, 75);
 
@@ -85,6 +88,17 @@ void CrossingDetectorEditor::selectedStreamHasChanged()
     CrossingDetector* processor = (CrossingDetector*)getProcessor();
     processor->setSelectedStream(getCurrentStream());
 
+    risingButton->setParameter(getStreamParameter("Rising"));
+    risingButton->updateView();
+    fallingButton->setParameter(getStreamParameter("Falling"));
+    fallingButton->updateView();
+
     // inform the canvas about selected stream updates
     updateVisualizer();
 }
+
+Parameter* CrossingDetectorEditor::getStreamParameter(const String& name)
+{
+    DataStream* stream = getProcessor()->getDataStream(getCurrentStream());
+    return stream != nullptr ? stream->getParameter(name) : nullptr;
+}
@@ -78,6 +78,13 @@ private:
     ScopedPointer<Label> threshValue;
 
     void selectedStreamHasChanged() override;
+
+    /** Parameter of the selected stream, or null if there is none */
+    Parameter* getStreamParameter(const String& name);
+
+    // direction buttons, bound to the parameters of the selected stream
+    CustomButton* risingButton;
+    CustomButton* fallingButton;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CrossingDetectorEditor);
 };
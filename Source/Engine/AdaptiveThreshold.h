@@ -0,0 +1,256 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ADAPTIVE_THRESHOLD_H_INCLUDED
+#define ADAPTIVE_THRESHOLD_H_INCLUDED
+
+/*
+Threshold that follows the amplitude of the input: multiplier * RMS, multiplier * mean |x|, or
+multiplier * median |x|, where the RMS and mean are exponential moving averages and the median
+is taken over exponentially decaying weights, with a given time constant.
+
+With the RMS and mean, the threshold of each sample only depends on the samples before it. Until
+one time constant's worth of samples has been seen, a plain running mean is used instead, so
+that the estimate doesn't start out biased towards zero.
+
+The median is robust to the spikes that a spike detection threshold is meant to find: for
+band-passed signals, median |x| is the median absolute deviation (MAD). It is estimated with a
+LogHistogram, which is updated with whole buffers, and recomputed whenever updateInterval
+samples have been added since the last time; the threshold is constant in between. The first
+buffer is used for its own threshold, since there is nothing else to go on yet.
+
+Optionally, the estimate is frozen after a calibration period, so that the threshold stays
+fixed from then on (e.g. to calibrate on a baseline recording period).
+
+Updating the moving average is a recurrence, so it takes one multiply-add per sample. Turning
+the averages into thresholds (square root and scaling) is done in a separate vectorized pass.
+*/
+
+#include "LogHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ADAPTIVE_THRESHOLD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+class AdaptiveThreshold
+{
+public:
+    /** What the amplitude estimate is based on */
+    enum Estimator
+    {
+        RMS = 0,    // x^2, the threshold uses the square root of the average
+        MEAN_ABS,   // |x|
+        MEDIAN_ABS, // |x|, median instead of mean
+        NUM_ESTIMATORS
+    };
+
+    /** Settings, with durations in samples */
+    struct Settings
+    {
+        Estimator estimator;
+        double timeConstant;
+        float multiplier;
+        bool freeze;                    // stop adapting after the calibration period
+        int64_t calibrationSamples;
+        int64_t updateInterval;         // how often the median is recomputed
+    };
+
+    /** Creates an estimator with a time constant of one sample that has seen no input. */
+    AdaptiveThreshold()
+        : settings              ({ RMS, 1.0, 1.0f, false, 0, 1 })
+        , alpha                 (1.0)
+        , estimate              (0.0)
+        , numSeen               (0)
+        , samplesSinceUpdate    (0)
+    {}
+
+    /** Applies new settings. Changing the estimator restarts the estimate. */
+    void setSettings(const Settings& newSettings)
+    {
+        if (newSettings.estimator != settings.estimator)
+        {
+            reset();
+        }
+
+        settings = newSettings;
+        settings.timeConstant = std::max(settings.timeConstant, 1.0);
+        alpha = 1.0 - std::exp(-1.0 / settings.timeConstant);
+        histogram.setTimeConstant(settings.timeConstant);
+    }
+
+    /** Forgets the input seen so far and restarts the calibration period. */
+    void reset()
+    {
+        estimate = 0.0;
+        numSeen = 0;
+        samplesSinceUpdate = 0;
+        histogram.reset();
+    }
+
+    /** Writes the thresholds of numSamples input samples and advances the estimate past them. */
+    void process(const float* x, float* thresh, int numSamples)
+    {
+        int numAdapting = numSamples;
+        if (settings.freeze)
+        {
+            numAdapting = int(std::max<int64_t>(0,
+                std::min<int64_t>(numSamples, settings.calibrationSamples - numSeen)));
+        }
+
+        if (settings.estimator == MEDIAN_ABS)
+        {
+            bool calibrationDone = settings.freeze && numSeen + numAdapting >= settings.calibrationSamples;
+            updateMedian(x, numAdapting, calibrationDone);
+            std::fill(thresh, thresh + numSamples, float(estimate));
+        }
+        else
+        {
+            updateAverage(x, thresh, numAdapting);
+
+            // frozen: the average no longer changes
+            std::fill(thresh + numAdapting, thresh + numSamples, float(estimate));
+        }
+
+        toThreshold(thresh, numSamples);
+    }
+
+    /** Threshold that applies to the next input sample */
+    float current() const
+    {
+        float t = float(estimate);
+        toThreshold(&t, 1);
+        return t;
+    }
+
+    /** Writes the estimate to a snapshot. */
+    void saveState(StateWriter& out) const
+    {
+        // beyond the warm-up and calibration, the number of samples seen no longer matters
+        int64_t warmupEnd = int64_t(std::ceil(1.0 / alpha));
+        int64_t limit = std::max<int64_t>(warmupEnd, settings.freeze ? settings.calibrationSamples : 1);
+
+        out.write(estimate);
+        out.write(std::min(numSeen, limit));
+        out.write(samplesSinceUpdate);
+        histogram.saveState(out);
+    }
+
+    /** Restores the estimate from a snapshot. */
+    void restoreState(StateReader& in)
+    {
+        in.read(estimate);
+        in.read(numSeen);
+        in.read(samplesSinceUpdate);
+        histogram.restoreState(in);
+    }
+
+private:
+    /** Writes the moving average before each sample to 'averages' and advances it. */
+    void updateAverage(const float* x, float* averages, int numSamples)
+    {
+        // while warming up, the weight of each new sample is 1 / (number seen so far)
+        int i = 0;
+        int64_t warmupEnd = int64_t(std::ceil(1.0 / alpha));
+        for (; i < numSamples && numSeen < warmupEnd; ++i)
+        {
+            averages[i] = float(estimate);
+            estimate += (value(x[i]) - estimate) / double(++numSeen);
+        }
+
+        const int warmupDone = i;
+        const double a = alpha;
+        double avg = estimate;
+        for (; i < numSamples; ++i)
+        {
+            averages[i] = float(avg);
+            avg += a * (value(x[i]) - avg);
+        }
+        numSeen += numSamples - warmupDone;
+        estimate = avg;
+    }
+
+    /** Adds samples to the histogram and recomputes the median when it is due. */
+    void updateMedian(const float* x, int numSamples, bool calibrationDone)
+    {
+        bool first = numSeen == 0;
+
+        histogram.add(x, numSamples);
+        numSeen += numSamples;
+        samplesSinceUpdate += numSamples;
+
+        if (numSamples > 0 && (first || calibrationDone || samplesSinceUpdate >= settings.updateInterval))
+        {
+            estimate = histogram.quantile(0.5);
+            samplesSinceUpdate = 0;
+        }
+    }
+
+    double value(float sample) const
+    {
+        return settings.estimator == RMS ? double(sample) * sample : std::abs(double(sample));
+    }
+
+    /** Turns moving averages into thresholds in place */
+    void toThreshold(float* values, int numValues) const
+    {
+        const float k = settings.multiplier;
+        int i = 0;
+
+        if (settings.estimator == RMS)
+        {
+#if ADAPTIVE_THRESHOLD_SSE2
+            const __m128 kv = _mm_set1_ps(k);
+            for (; i + 4 <= numValues; i += 4)
+            {
+                __m128 v = _mm_max_ps(_mm_loadu_ps(values + i), _mm_setzero_ps());
+                _mm_storeu_ps(values + i, _mm_mul_ps(kv, _mm_sqrt_ps(v)));
+            }
+#endif
+            for (; i < numValues; ++i)
+            {
+                values[i] = k * std::sqrt(std::max(values[i], 0.0f));
+            }
+        }
+        else
+        {
+            for (; i < numValues; ++i)
+            {
+                values[i] *= k;
+            }
+        }
+    }
+
+    Settings settings;
+    double alpha;               // weight of each new sample after the warm-up
+    double estimate;            // moving average or median of the samples seen so far
+    int64_t numSeen;            // number of input samples the estimate is based on
+    int64_t samplesSinceUpdate; // samples added to the histogram since the median was computed
+    LogHistogram histogram;     // only used for the median
+};
+
+#endif // ADAPTIVE_THRESHOLD_H_INCLUDED
@@ -0,0 +1,225 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BIQUAD_CASCADE_H_INCLUDED
+#define BIQUAD_CASCADE_H_INCLUDED
+
+/*
+Cascade of second-order IIR sections ("biquads") that filters one channel, used to band-pass or
+high-pass the input before detection without a separate filter plugin.
+
+The sections are Butterworth high-pass and low-pass filters designed with the bilinear transform
+(a band-pass is a high-pass followed by a low-pass). An odd order adds a first-order section,
+stored as a biquad with b2 = a2 = 0.
+
+Each section runs over the whole buffer before the next one (in transposed direct form II), so
+a buffer stays in cache while the cascade is applied and the first section can write straight to
+wherever the output is needed. Coefficients and state are doubles, which keeps low cutoffs at
+high sample rates stable. The sections are stored in a fixed-size array, so changing the design
+never allocates.
+*/
+
+#include "StateSnapshot.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+class BiquadCascade
+{
+public:
+    /** Response of the cascade */
+    enum Type
+    {
+        NONE = 0,   // the input passes through unchanged
+        HIGHPASS,
+        BANDPASS,
+        NUM_TYPES
+    };
+
+    /** Maximum order of each of the high-pass and low-pass parts */
+    static const int MAX_ORDER = 8;
+
+    /** Creates a filter that passes its input through. */
+    BiquadCascade() : numSections(0)
+    {
+        reset();
+    }
+
+    /** Designs a Butterworth filter of the given order (per cutoff) and clears the state.
+     *  Cutoffs are in Hz; the high cutoff is only used by BANDPASS.
+     */
+    void design(Type type, int order, double lowCut, double highCut, double sampleRate)
+    {
+        numSections = 0;
+
+        if (type != NONE && sampleRate > 0)
+        {
+            order = std::min(std::max(order, 1), int(MAX_ORDER));
+
+            // keep the cutoffs strictly between 0 and the Nyquist frequency
+            const double minCut = 1e-4 * sampleRate;
+            const double maxCut = 0.49 * sampleRate;
+            highCut = std::min(std::max(highCut, minCut), maxCut);
+            lowCut = std::min(std::max(lowCut, minCut), maxCut);
+
+            if (type == HIGHPASS)
+            {
+                addButterworth(false, order, lowCut / sampleRate);
+            }
+            else
+            {
+                addButterworth(false, order, lowCut / sampleRate);
+                addButterworth(true, order, highCut / sampleRate);
+            }
+        }
+
+        reset();
+    }
+
+    /** Clears the state of all sections, as if the input had been 0 so far. */
+    void reset()
+    {
+        for (auto& s : state)
+        {
+            s[0] = s[1] = 0.0;
+        }
+    }
+
+    /** Filters numSamples samples from 'in' to 'out' (which may be the same array). */
+    void process(const float* in, float* out, int numSamples)
+    {
+        if (numSections == 0)
+        {
+            if (out != in)
+            {
+                std::copy(in, in + numSamples, out);
+            }
+            return;
+        }
+
+        const float* src = in;
+        for (int k = 0; k < numSections; ++k)
+        {
+            const Section& c = sections[size_t(k)];
+            double s1 = state[size_t(k)][0];
+            double s2 = state[size_t(k)][1];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                double x = src[i];
+                double y = c.b0 * x + s1;
+                s1 = c.b1 * x - c.a1 * y + s2;
+                s2 = c.b2 * x - c.a2 * y;
+                out[i] = float(y);
+            }
+
+            state[size_t(k)][0] = s1;
+            state[size_t(k)][1] = s2;
+            src = out;
+        }
+    }
+
+    /** Writes the state of the sections to a snapshot. */
+    void saveState(StateWriter& out) const
+    {
+        out.write(numSections);
+        for (int k = 0; k < numSections; ++k)
+        {
+            out.write(state[size_t(k)].data(), 2);
+        }
+    }
+
+    /** Restores the state of a filter with the same design from a snapshot. */
+    void restoreState(StateReader& in)
+    {
+        if (in.expect(numSections))
+        {
+            for (int k = 0; k < numSections; ++k)
+            {
+                in.read(state[size_t(k)].data(), 2);
+            }
+        }
+    }
+
+private:
+    /** Coefficients of one section, normalized so that a0 = 1 */
+    struct Section
+    {
+        double b0, b1, b2, a1, a2;
+    };
+
+    /** Appends the sections of a Butterworth low-pass or high-pass filter.
+     *  cutoff is a fraction of the sample rate.
+     */
+    void addButterworth(bool lowpass, int order, double cutoff)
+    {
+        const double pi = 3.14159265358979323846;
+        const double k = std::tan(pi * cutoff); // prewarped analog cutoff
+
+        // pairs of complex conjugate poles, each a section with its own Q
+        for (int p = 1; p <= order / 2; ++p)
+        {
+            double q = 1.0 / (2.0 * std::sin((2 * p - 1) * pi / (2.0 * order)));
+            double norm = 1.0 / (1.0 + k / q + k * k);
+
+            Section s;
+            if (lowpass)
+            {
+                s.b0 = k * k * norm;
+                s.b1 = 2.0 * s.b0;
+            }
+            else
+            {
+                s.b0 = norm;
+                s.b1 = -2.0 * s.b0;
+            }
+            s.b2 = s.b0;
+            s.a1 = 2.0 * (k * k - 1.0) * norm;
+            s.a2 = (1.0 - k / q + k * k) * norm;
+            sections[size_t(numSections++)] = s;
+        }
+
+        // the real pole of an odd order
+        if (order % 2 != 0)
+        {
+            double norm = 1.0 / (1.0 + k);
+
+            Section s;
+            s.b0 = (lowpass ? k : 1.0) * norm;
+            s.b1 = lowpass ? s.b0 : -s.b0;
+            s.b2 = 0.0;
+            s.a1 = (k - 1.0) * norm;
+            s.a2 = 0.0;
+            sections[size_t(numSections++)] = s;
+        }
+    }
+
+    static const int MAX_SECTIONS = 2 * ((MAX_ORDER + 1) / 2);
+
+    std::array<Section, MAX_SECTIONS> sections;
+    std::array<std::array<double, 2>, MAX_SECTIONS> state; // s1, s2 of each section
+    int numSections;
+};
+
+#endif // BIQUAD_CASCADE_H_INCLUDED
@@ -0,0 +1,227 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BIT_HISTORY_H_INCLUDED
+#define BIT_HISTORY_H_INCLUDED
+
+/*
+Packed ring of one bit per sample, recording whether each sample was above its threshold.
+
+Samples are addressed by an absolute position that increases with every appended sample.
+At least 'historyLength' bits before the current end are always retained, so past/future
+voting only needs this ring (1 bit per sample) instead of the input and threshold values
+(64 bits per sample). Counting the samples above threshold in a range is done with one
+popcount per 64-bit word.
+*/
+
+#include "CrossingScan.h"
+#include "StateSnapshot.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+class BitHistory
+{
+public:
+    /** Creates an empty history. */
+    BitHistory() : historyLength(0), endPos(0), wordMask(0)
+    {
+        words.resize(1, 0);
+    }
+
+    /** Creates a history that retains the given number of bits. */
+    explicit BitHistory(int length) : BitHistory()
+    {
+        reset(length);
+    }
+
+    /** Clears all bits and sets the number of bits that must be retained behind the end.
+        The retained bits are all zero ("not above") after a reset.
+    */
+    void reset(int length)
+    {
+        historyLength = length > 0 ? length : 0;
+        endPos = 0;
+        std::fill(words.begin(), words.end(), 0);
+        reserve(historyLength);
+    }
+
+    /** Makes room for appending numNewBits without losing any of the retained bits.
+        Only allocates if the current capacity is too small.
+    */
+    void reserve(int numNewBits)
+    {
+        uint64_t needed = uint64_t(historyLength) + uint64_t(numNewBits > 0 ? numNewBits : 0);
+        uint64_t capacity = uint64_t(words.size()) * 64;
+        if (needed <= capacity)
+            return;
+
+        while (capacity < needed)
+            capacity *= 2;
+
+        // copy the retained bits into the new ring at the same absolute positions
+        BitHistory grown;
+        grown.historyLength = historyLength;
+        grown.endPos = endPos;
+        grown.words.assign(size_t(capacity / 64), 0);
+        grown.wordMask = grown.words.size() - 1;
+
+        for (uint64_t pos = endPos - uint64_t(historyLength); pos != endPos; )
+        {
+            int nBits = int(std::min<uint64_t>(64, endPos - pos));
+            grown.writeBits(pos, readBits(pos, nBits), nBits);
+            pos += uint64_t(nBits);
+        }
+
+        words.swap(grown.words);
+        wordMask = grown.wordMask;
+    }
+
+    /** Returns the position one past the most recently appended bit. */
+    int64_t end() const
+    {
+        return int64_t(endPos);
+    }
+
+    /** Appends one bit per sample, set iff x[k] > t[k]. Returns the position of the first new bit. */
+    int64_t append(const float* x, const float* t, int n)
+    {
+        int64_t start = end();
+        reserve(n);
+        endPos += uint64_t(n);
+        assign(start, x, t, n);
+        return start;
+    }
+
+    /** Recomputes n already appended bits starting at position 'from'. */
+    void assign(int64_t from, const float* x, const float* t, int n)
+    {
+        for (int k = 0; k < n; k += 64)
+        {
+            int nBits = n - k < 64 ? n - k : 64;
+            writeBits(uint64_t(from + k), CrossingScan::packAbove(x + k, t + k, nBits), nBits);
+        }
+    }
+
+    /** Returns the number of set bits in positions [from, to). */
+    int count(int64_t from, int64_t to) const
+    {
+        int total = 0;
+        for (uint64_t pos = uint64_t(from); int64_t(pos) < to; )
+        {
+            int offset = int(pos & 63);
+            int nBits = int(std::min<int64_t>(64 - offset, to - int64_t(pos)));
+            uint64_t word = words[(pos >> 6) & wordMask] >> offset;
+            total += popcount(nBits < 64 ? word & lowBits(nBits) : word);
+            pos += uint64_t(nBits);
+        }
+        return total;
+    }
+
+    /** Writes the retained bits to a snapshot. */
+    void saveState(StateWriter& out) const
+    {
+        out.write(historyLength);
+        for (uint64_t pos = endPos - uint64_t(historyLength); pos != endPos; )
+        {
+            int nBits = int(std::min<uint64_t>(64, endPos - pos));
+            out.write(readBits(pos, nBits));
+            pos += uint64_t(nBits);
+        }
+    }
+
+    /** Restores the retained bits of a history with the same length. */
+    void restoreState(StateReader& in)
+    {
+        if (!in.expect(historyLength))
+        {
+            return;
+        }
+
+        std::vector<uint64_t> bits(static_cast<size_t>((historyLength + 63) / 64));
+        if (in.read(bits.data(), bits.size()))
+        {
+            reset(historyLength);
+            for (int k = 0; k < historyLength; k += 64)
+            {
+                writeBits(endPos, bits[size_t(k / 64)], std::min(64, historyLength - k));
+                endPos += uint64_t(std::min(64, historyLength - k));
+            }
+        }
+    }
+
+private:
+    static uint64_t lowBits(int nBits)
+    {
+        return nBits >= 64 ? ~uint64_t(0) : (uint64_t(1) << nBits) - 1;
+    }
+
+    static int popcount(uint64_t word)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        return int(__popcnt64(word));
+#elif defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(word);
+#else
+        word = word - ((word >> 1) & 0x5555555555555555ULL);
+        word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return int((word * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+    /** Reads nBits (1 to 64) bits starting at pos, which may straddle two words. */
+    uint64_t readBits(uint64_t pos, int nBits) const
+    {
+        int offset = int(pos & 63);
+        uint64_t bits = words[(pos >> 6) & wordMask] >> offset;
+        if (offset + nBits > 64)
+            bits |= words[((pos >> 6) + 1) & wordMask] << (64 - offset);
+        return bits & lowBits(nBits);
+    }
+
+    /** Writes nBits (1 to 64) bits starting at pos, which may straddle two words. */
+    void writeBits(uint64_t pos, uint64_t bits, int nBits)
+    {
+        int offset = int(pos & 63);
+        uint64_t mask = lowBits(nBits);
+        bits &= mask;
+
+        uint64_t& first = words[(pos >> 6) & wordMask];
+        first = (first & ~(mask << offset)) | (bits << offset);
+
+        if (offset + nBits > 64)
+        {
+            uint64_t& second = words[((pos >> 6) + 1) & wordMask];
+            second = (second & ~(mask >> (64 - offset))) | (bits >> (64 - offset));
+        }
+    }
+
+    std::vector<uint64_t> words; // size is a power of two
+    int historyLength;
+    uint64_t endPos;
+    uint64_t wordMask;
+};
+
+#endif // BIT_HISTORY_H_INCLUDED
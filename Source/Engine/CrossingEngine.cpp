@@ -0,0 +1,800 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "CrossingEngine.h"
+
+#include <algorithm>
+#include <cmath> // for ceil, floor
+#include <cstdio>
+
+// Upper bound for the number of events to preallocate
+static const int MAX_RESERVED_EVENTS = 1 << 16;
+
+/** ------------- Crossing Detector Bank --------------- */
+
+CrossingDetectorBank::CrossingDetectorBank()
+{
+    setChannels(1, 0, 0, 0.0f);
+}
+
+void CrossingDetectorBank::setChannels(int numChannels, int pastSpan, int futureSpan, float initialThresh)
+{
+    const size_t n = size_t(numChannels);
+
+    sampToReenable.resize(n);
+    jumpLimitElapsed.resize(n);
+    nextIndex.resize(n);
+    armedDirections.resize(n);
+    pastSamplesAbove.resize(n);
+    futureSamplesAbove.resize(n);
+    randomThresh.assign(n, initialThresh);
+    adaptiveThresh.resize(n);
+    decimators.resize(n);
+    prefilters.resize(n);
+    phaseEstimators.resize(n);
+    inputHistory.resize(n);
+    thresholdHistory.resize(n);
+    aboveHistory.resize(n);
+
+    reset(pastSpan, futureSpan);
+}
+
+void CrossingDetectorBank::reset(int pastSpan, int futureSpan)
+{
+    for (size_t k = 0; k < sampToReenable.size(); ++k)
+    {
+        // don't trigger on the (empty) history: the first crossing index with a full past span
+        sampToReenable[k] = pastSpan + 1;
+        nextIndex[k] = -futureSpan;
+        armedDirections[k] = 0;
+
+        // counters must reflect current contents of aboveHistory
+        pastSamplesAbove[k] = 0;
+        futureSamplesAbove[k] = 0;
+        aboveHistory[k].reset(pastSpan + futureSpan + 2);
+
+        inputHistory[k].reset(futureSpan + 2);
+        thresholdHistory[k].reset(futureSpan + 2);
+    }
+}
+
+void CrossingDetectorBank::reserve(int maxBufferSize)
+{
+    for (size_t k = 0; k < sampToReenable.size(); ++k)
+    {
+        inputHistory[k].reserve(maxBufferSize);
+        thresholdHistory[k].reserve(maxBufferSize);
+        aboveHistory[k].reserve(maxBufferSize);
+    }
+}
+
+CrossingKernel::State CrossingDetectorBank::getState(int k) const
+{
+    const size_t i = size_t(k);
+    return { sampToReenable[i], jumpLimitElapsed[i], nextIndex[i], armedDirections[i],
+        pastSamplesAbove[i], futureSamplesAbove[i] };
+}
+
+void CrossingDetectorBank::setState(int k, const CrossingKernel::State& state)
+{
+    const size_t i = size_t(k);
+    sampToReenable[i] = state.sampToReenable;
+    jumpLimitElapsed[i] = state.jumpLimitElapsed;
+    nextIndex[i] = state.nextIndex;
+    armedDirections[i] = state.armed;
+    pastSamplesAbove[i] = state.pastSamplesAbove;
+    futureSamplesAbove[i] = state.futureSamplesAbove;
+}
+
+void CrossingDetectorBank::saveState(StateWriter& out) const
+{
+    out.write(size());
+
+    for (int k = 0; k < size(); ++k)
+    {
+        const size_t i = size_t(k);
+        const int counters[] = { sampToReenable[i], jumpLimitElapsed[i], nextIndex[i], armedDirections[i],
+            pastSamplesAbove[i], futureSamplesAbove[i] };
+        out.write(counters, 6);
+        out.write(randomThresh[i]);
+
+        adaptiveThresh[i].saveState(out);
+        decimators[i].saveState(out);
+        prefilters[i].saveState(out);
+        phaseEstimators[i].saveState(out);
+        inputHistory[i].saveState(out);
+        thresholdHistory[i].saveState(out);
+        aboveHistory[i].saveState(out);
+    }
+}
+
+void CrossingDetectorBank::restoreState(StateReader& in)
+{
+    if (!in.expect(size()))
+    {
+        return;
+    }
+
+    for (int k = 0; k < size() && in.ok(); ++k)
+    {
+        const size_t i = size_t(k);
+        int counters[6];
+        if (!in.read(counters, 6) || !in.read(randomThresh[i]))
+        {
+            return;
+        }
+        setState(k, { counters[0], counters[1], counters[2], counters[3], counters[4], counters[5] });
+
+        adaptiveThresh[i].restoreState(in);
+        decimators[i].restoreState(in);
+        prefilters[i].restoreState(in);
+        phaseEstimators[i].restoreState(in);
+        inputHistory[i].restoreState(in);
+        thresholdHistory[i].restoreState(in);
+        aboveHistory[i].restoreState(in);
+    }
+}
+
+/** ------------- Crossing Engine --------------- */
+
+CrossingEngine::Settings::Settings() :
+    decimation(1),
+    prefilterType(BiquadCascade::NONE),
+    prefilterOrder(2),
+    prefilterLowCut(300.0f),
+    prefilterHighCut(6000.0f),
+    thresholdType(CONSTANT),
+    constantThresh(0.0f),
+    adaptiveEstimator(AdaptiveThreshold::RMS),
+    adaptiveMultiplier(4.0f),
+    adaptiveTimeConstMs(1000),
+    adaptiveUpdateMs(100),
+    useAdaptiveFreeze(false),
+    adaptiveCalibrationMs(10000),
+    phaseTarget(0.0f),
+    phaseFreq(8.0f),
+    phaseBandwidth(8.0f),
+    posOn(true),
+    negOn(false),
+    eventDuration(100),
+    timeout(1000),
+    useBufferEndMask(false),
+    bufferEndMaskMs(3),
+    pastSpan(0),
+    futureSpan(0),
+    pastStrict(1.0f),
+    futureStrict(1.0f),
+    earlyDecision(false),
+    useJumpLimit(false),
+    jumpLimit(5.0f),
+    jumpLimitSleep(0.0f),
+    useHysteresis(false),
+    hysteresis(5.0f),
+    interpolation(CrossingKernel::LINEAR)
+{
+    randomThreshRange[0] = -180.0f;
+    randomThreshRange[1] = 180.0f;
+}
+
+CrossingEngine::CrossingEngine() :
+    sampleRate(0.0f),
+    reservedBufferSize(0),
+    eventDurationSamp(0),
+    timeoutSamp(0),
+    bufferEndMaskSamp(0),
+    currRandomThresh(0.0f)
+{
+    setChannels(1);
+}
+
+void CrossingEngine::configure(float inputSampleRate, int numChannels)
+{
+    sampleRate = inputSampleRate;
+    setChannels(numChannels);
+    updateSampleRateDependentValues();
+
+    if (settings.thresholdType == RANDOM)
+    {
+        resetRandomThresh();
+    }
+}
+
+void CrossingEngine::setChannels(int numChannels)
+{
+    detectors.setChannels(numChannels, toDetectionSamples(settings.pastSpan),
+        toDetectionSamples(settings.futureSpan), currRandomThresh);
+
+    Event none {};
+    none.channel = -1;
+    turnoffEvents.assign(size_t(numChannels), none);
+
+    updateDecimators();
+    updateAdaptiveThresholds();
+    updatePrefilters();
+    updatePhaseEstimators();
+
+    reserveBuffers();
+}
+
+void CrossingEngine::updateSampleRateDependentValues()
+{
+    // events are placed at the input's sample rate, while crossings are detected at the detection rate
+    eventDurationSamp = int(std::ceil(settings.eventDuration * sampleRate / 1000.0f));
+    timeoutSamp = int(std::floor(settings.timeout * detectionRate() / 1000.0f));
+    bufferEndMaskSamp = int(std::ceil(settings.bufferEndMaskMs * detectionRate() / 1000.0f));
+
+    updateAdaptiveThresholds();
+
+    // a shorter timeout allows more events per buffer
+    reserveBuffers();
+}
+
+float CrossingEngine::detectionRate() const
+{
+    return sampleRate / settings.decimation;
+}
+
+int CrossingEngine::toDetectionSamples(int inputSamples) const
+{
+    return (inputSamples + settings.decimation - 1) / settings.decimation;
+}
+
+void CrossingEngine::resetDetectors()
+{
+    detectors.reset(toDetectionSamples(settings.pastSpan), toDetectionSamples(settings.futureSpan));
+
+    // longer spans leave less room for the buffer in the histories
+    reserveBuffers();
+}
+
+void CrossingEngine::updateDecimators()
+{
+    for (auto& decimator : detectors.decimators)
+    {
+        decimator.design(settings.decimation);
+    }
+    thresholdDecimator.design(settings.decimation);
+}
+
+void CrossingEngine::updateAdaptiveThresholds()
+{
+    AdaptiveThreshold::Settings adaptiveSettings;
+    adaptiveSettings.estimator = settings.adaptiveEstimator;
+    adaptiveSettings.timeConstant = settings.adaptiveTimeConstMs * double(detectionRate()) / 1000.0;
+    adaptiveSettings.multiplier = settings.adaptiveMultiplier;
+    adaptiveSettings.freeze = settings.useAdaptiveFreeze;
+    adaptiveSettings.calibrationSamples = int64_t(std::ceil(settings.adaptiveCalibrationMs * double(detectionRate()) / 1000.0));
+    adaptiveSettings.updateInterval = int64_t(std::ceil(settings.adaptiveUpdateMs * double(detectionRate()) / 1000.0));
+
+    for (auto& estimator : detectors.adaptiveThresh)
+    {
+        estimator.setSettings(adaptiveSettings);
+    }
+}
+
+void CrossingEngine::updatePrefilters()
+{
+    for (auto& filter : detectors.prefilters)
+    {
+        filter.design(settings.prefilterType, settings.prefilterOrder, settings.prefilterLowCut,
+            settings.prefilterHighCut, detectionRate());
+    }
+}
+
+std::string CrossingEngine::checkPrefilter(const Settings& candidate, float inputSampleRate)
+{
+    char message[200] = "";
+
+    if (candidate.prefilterType == BiquadCascade::BANDPASS && candidate.prefilterLowCut >= candidate.prefilterHighCut)
+    {
+        std::snprintf(message, sizeof(message),
+            "the low cutoff of the band-pass filter (%g Hz) must be below its high cutoff (%g Hz)",
+            candidate.prefilterLowCut, candidate.prefilterHighCut);
+    }
+    else if (candidate.prefilterType != BiquadCascade::NONE && inputSampleRate > 0)
+    {
+        const bool bandpass = candidate.prefilterType == BiquadCascade::BANDPASS;
+        const float cutoff = bandpass ? candidate.prefilterHighCut : candidate.prefilterLowCut;
+        const float nyquist = inputSampleRate / std::max(candidate.decimation, 1) / 2;
+
+        if (cutoff >= nyquist)
+        {
+            std::snprintf(message, sizeof(message),
+                "the %s cutoff of the input filter (%g Hz) must be below the Nyquist frequency of the "
+                "detection rate (%g Hz)", bandpass ? "high" : "low", cutoff, nyquist);
+        }
+    }
+
+    return message;
+}
+
+void CrossingEngine::updatePhaseEstimators()
+{
+    for (auto& estimator : detectors.phaseEstimators)
+    {
+        estimator.design(settings.phaseFreq, settings.phaseBandwidth, detectionRate());
+    }
+}
+
+void CrossingEngine::disarmHysteresis()
+{
+    std::fill(detectors.armedDirections.begin(), detectors.armedDirections.end(), 0);
+}
+
+void CrossingEngine::setRandomSeed(int64_t seed)
+{
+    rng.setSeed(seed);
+}
+
+float CrossingEngine::nextRandomThresh()
+{
+    float range = settings.randomThreshRange[1] - settings.randomThreshRange[0];
+    return settings.randomThreshRange[0] + range * rng.nextFloat();
+}
+
+void CrossingEngine::resetRandomThresh()
+{
+    currRandomThresh = nextRandomThresh();
+    std::fill(detectors.randomThresh.begin(), detectors.randomThresh.end(), currRandomThresh);
+}
+
+float CrossingEngine::getCurrentThreshold() const
+{
+    switch (settings.thresholdType)
+    {
+    case RANDOM:
+        return currRandomThresh;
+
+    case ADAPTIVE:
+        return detectors.adaptiveThresh.empty() ? 0.0f : detectors.adaptiveThresh[0].current();
+
+    case PHASE:
+        return settings.phaseTarget;
+
+    default:
+        return settings.constantThresh;
+    }
+}
+
+int CrossingEngine::maxEventsPerBuffer(int maxBufferSize) const
+{
+    // Each channel produces at most one crossing per timeout period (two events each),
+    // plus a turning-off event left over from the previous buffer.
+    int maxDetected = toDetectionSamples(maxBufferSize);
+    int maxCrossings = std::min(maxDetected, maxDetected / (timeoutSamp + 1) + 1);
+    int maxEvents = detectors.size() * (2 * maxCrossings + 1);
+
+    return std::min(maxEvents, MAX_RESERVED_EVENTS);
+}
+
+void CrossingEngine::start(int maxBufferSize)
+{
+    updateSampleRateDependentValues();
+
+    std::fill(detectors.jumpLimitElapsed.begin(), detectors.jumpLimitElapsed.end(),
+        int(settings.jumpLimitSleep * detectionRate()));
+
+    // adaptive thresholds are calibrated from the start of acquisition
+    for (auto& estimator : detectors.adaptiveThresh)
+    {
+        estimator.reset();
+    }
+
+    for (auto& decimator : detectors.decimators)
+    {
+        decimator.reset();
+    }
+    thresholdDecimator.reset();
+
+    for (auto& filter : detectors.prefilters)
+    {
+        filter.reset();
+    }
+
+    for (auto& estimator : detectors.phaseEstimators)
+    {
+        estimator.reset();
+    }
+
+    reservedBufferSize = std::max(maxBufferSize, 0);
+    reserveBuffers();
+}
+
+void CrossingEngine::reserveBuffers()
+{
+    if (reservedBufferSize == 0)
+    {
+        return;
+    }
+
+    events.reserve(size_t(maxEventsPerBuffer(reservedBufferSize)));
+    detectors.reserve(reservedBufferSize);
+    decimatedThreshold.reserve(size_t(reservedBufferSize));
+}
+
+void CrossingEngine::stop()
+{
+    // set this to pastSpan + 1 so that we don't trigger on old data when we start again.
+    std::fill(detectors.sampToReenable.begin(), detectors.sampToReenable.end(),
+        toDetectionSamples(settings.pastSpan) + 1);
+
+    // cancel any pending turning-off per channel
+    for (auto& turnoff : turnoffEvents)
+    {
+        turnoff.channel = -1;
+    }
+}
+
+void CrossingEngine::saveEvent(StateWriter& out, const Event& event)
+{
+    out.write(event.sampleNumber);
+    out.write(event.offset);
+    out.write(event.channel);
+    out.write(uint8_t(event.on));
+    out.write(event.crossingPoint);
+    out.write(event.crossingLevel);
+    out.write(event.threshold);
+    out.write(event.latency);
+    out.write(event.crossingTime);
+}
+
+void CrossingEngine::restoreEvent(StateReader& in, Event& event)
+{
+    uint8_t on = 0;
+    in.read(event.sampleNumber);
+    in.read(event.offset);
+    in.read(event.channel);
+    in.read(on);
+    in.read(event.crossingPoint);
+    in.read(event.crossingLevel);
+    in.read(event.threshold);
+    in.read(event.latency);
+    in.read(event.crossingTime);
+    event.on = on != 0;
+}
+
+// identifies snapshots of this layout
+static const uint32_t SNAPSHOT_VERSION = 0x43445331; // "CDS1"
+
+void CrossingEngine::saveState(std::vector<uint8_t>& snapshot) const
+{
+    snapshot.clear();
+    StateWriter out(snapshot);
+
+    out.write(SNAPSHOT_VERSION);
+    detectors.saveState(out);
+
+    for (const Event& turnoff : turnoffEvents)
+    {
+        // only pending events matter
+        if (turnoff.channel >= 0)
+        {
+            out.write(uint8_t(1));
+            saveEvent(out, turnoff);
+        }
+        else
+        {
+            out.write(uint8_t(0));
+        }
+    }
+
+    thresholdDecimator.saveState(out);
+    out.write(currRandomThresh);
+    out.write(rng.getSeed());
+}
+
+bool CrossingEngine::restoreState(const std::vector<uint8_t>& snapshot)
+{
+    StateReader in(snapshot);
+
+    in.expect(SNAPSHOT_VERSION);
+    detectors.restoreState(in);
+
+    for (Event& turnoff : turnoffEvents)
+    {
+        uint8_t pending = 0;
+        in.read(pending);
+        turnoff = Event {};
+        turnoff.channel = -1;
+        if (pending != 0)
+        {
+            restoreEvent(in, turnoff);
+        }
+    }
+
+    thresholdDecimator.restoreState(in);
+    in.read(currRandomThresh);
+
+    int64_t seed = 0;
+    if (in.read(seed))
+    {
+        rng.setSeed(seed);
+    }
+
+    // the restored histories are only as large as they were when saved
+    reserveBuffers();
+
+    return in.ok() && in.atEnd();
+}
+
+void CrossingEngine::addCrossing(int k, int64_t firstSampleNumber, int numSamples, int indCross, const Event& crossing)
+{
+    // ON event
+    Event eventOn = crossing;
+    eventOn.offset = std::max(indCross, 0);
+    eventOn.sampleNumber = firstSampleNumber + eventOn.offset;
+    eventOn.on = true;
+    events.push_back(eventOn);
+
+    // OFF event
+    Event eventOff = crossing;
+    eventOff.offset = eventOn.offset + eventDurationSamp;
+    eventOff.sampleNumber = firstSampleNumber + eventOff.offset;
+    eventOff.on = false;
+
+    // Add or schedule turning-off event
+    // We don't care whether there are other turning-offs scheduled to occur either in
+    // this buffer or later. The abilities to change event duration during acquisition and for
+    // events to be longer than the timeout period create a lot of possibilities and edge cases,
+    // but overwriting the turning-off event unconditionally guarantees that this and all previously
+    // turned-on events will be turned off by this "turning-off" if they're not already off.
+    if (eventOff.offset <= numSamples)
+    {
+        // add off event now
+        events.push_back(eventOff);
+    }
+    else
+    {
+        // save for later
+        turnoffEvents[size_t(k)] = eventOff;
+    }
+}
+
+// connects the detection kernel to one channel's history and event output
+struct CrossingEngine::Host
+{
+    CrossingEngine* engine;
+    int k;
+    ThresholdType threshType;
+    const float* rp;
+    float* pThresh;
+    int nDetected;          // samples of the buffer at the detection rate
+    int nSamples;           // samples of the buffer at the input's rate
+    int firstOutput;        // input sample of the first detection sample
+    int decimation;
+    double filterDelay;     // of the decimator, in input samples
+    int64_t startTs;
+    int64_t bufferPos;
+
+    // converts an index at the detection rate to an input sample of the buffer
+    int toInputIndex(int ind) const
+    {
+        return firstOutput + ind * decimation;
+    }
+
+    int countAbove(int from, int to)
+    {
+        return engine->detectors.aboveHistory[size_t(k)].count(bufferPos + from, bufferPos + to);
+    }
+
+    void trigger(int detectedCross, int decisionInd, float crossingOffset, float crossingLevel, float threshold)
+    {
+        // the decimated signal lags the input by the anti-aliasing filter's delay, so the
+        // crossing happened that much earlier in the input
+        const int indDetected = toInputIndex(detectedCross);
+        const int indCross = indDetected - int(std::floor(filterDelay));
+
+        if (threshType == PHASE)
+        {
+            // report the phase itself (not wrapped, so that it compares correctly with the target)
+            crossingLevel += engine->settings.phaseTarget;
+            threshold = engine->settings.phaseTarget;
+        }
+
+        Event crossing {};
+        crossing.channel = k;
+        crossing.crossingPoint = startTs + indCross;
+        crossing.crossingLevel = crossingLevel;
+        crossing.threshold = threshold;
+        crossing.latency = nSamples - 1 - indCross;
+        crossing.crossingTime = double(startTs + indDetected) + double(crossingOffset) * decimation - filterDelay;
+
+        engine->addCrossing(k, startTs, nSamples, indCross, crossing);
+
+        // if using random thresholds, set a new threshold for the samples not yet seen
+        if (threshType == RANDOM)
+        {
+            float newThresh = engine->nextRandomThresh();
+            engine->currRandomThresh = newThresh;
+            engine->detectors.randomThresh[size_t(k)] = newThresh;
+
+            int firstNewSample = decisionInd + 1;
+            if (firstNewSample < nDetected)
+            {
+                std::fill(pThresh + firstNewSample, pThresh + nDetected, newThresh);
+                engine->detectors.aboveHistory[size_t(k)].assign(bufferPos + firstNewSample,
+                    rp + firstNewSample, pThresh + firstNewSample, nDetected - firstNewSample);
+            }
+        }
+    }
+};
+
+int CrossingEngine::process(const float* const* input, const float* thresholdInput, int numSamples,
+    int64_t firstSampleNumber)
+{
+    events.clear();
+
+    const int64_t startTs = firstSampleNumber;
+    const int nSamples = numSamples;
+    const ThresholdType currThreshType = settings.thresholdType;
+
+    // Decimated samples are produced by the input samples firstOutput, firstOutput + decimation, ...
+    // of the buffer; detection runs on the nDetected of them.
+    const int decimation = settings.decimation;
+    const int firstOutput = PolyphaseDecimator::firstOutput(startTs, decimation);
+    const int nDetected = PolyphaseDecimator::numOutputs(nSamples, firstOutput, decimation);
+
+    const float* threshChan = currThreshType == CHANNEL ? thresholdInput : nullptr;
+
+    if (threshChan != nullptr && decimation > 1)
+    {
+        if (decimatedThreshold.size() < size_t(nDetected))
+        {
+            decimatedThreshold.resize(size_t(nDetected));
+        }
+        float* decimated = decimatedThreshold.data();
+        thresholdDecimator.process(threshChan, decimated, nSamples, firstOutput);
+        threshChan = decimated;
+    }
+
+    // settings to keep constant during the buffer (spans at the detection rate)
+    const int pastSpan = toDetectionSamples(settings.pastSpan);
+    const int futureSpan = toDetectionSamples(settings.futureSpan);
+
+    CrossingKernel::Config config;
+    config.thresholdType = currThreshType;
+    config.directions = (settings.posOn ? CrossingScan::RISING : 0)
+        | (settings.negOn ? CrossingScan::FALLING : 0);
+    config.pastSpan = pastSpan;
+    config.futureSpan = futureSpan;
+    config.pastSamplesNeeded = CrossingKernel::samplesNeeded(pastSpan, settings.pastStrict);
+    config.futureSamplesNeeded = CrossingKernel::samplesNeeded(futureSpan, settings.futureStrict);
+    config.useJumpLimit = settings.useJumpLimit;
+    config.jumpLimit = settings.jumpLimit;
+    config.jumpLimitSleepSamp = settings.jumpLimitSleep * detectionRate();
+    config.timeoutSamp = timeoutSamp;
+    config.constantThresh = settings.constantThresh;
+    config.earlyDecision = settings.earlyDecision;
+    config.useHysteresis = settings.useHysteresis;
+    config.hysteresis = settings.hysteresis;
+    config.interpolation = settings.interpolation;
+
+    if (currThreshType == PHASE)
+    {
+        // a wrap of the phase is a jump of almost 360 degrees rather than a crossing, while the
+        // phase advances by less than 180 degrees per sample below the Nyquist frequency
+        config.useJumpLimit = true;
+        config.jumpLimit = settings.useJumpLimit ? std::min(settings.jumpLimit, 180.0f) : 180.0f;
+        if (!settings.useJumpLimit)
+        {
+            config.jumpLimitSleepSamp = 0;
+        }
+    }
+
+    int numEvaluated = 0;
+
+    for (int k = 0; k < detectors.size(); ++k)
+    {
+        if (input[k] == nullptr)
+        {
+            continue;
+        }
+
+        // continue the channel's input history with the current buffer, decimating and filtering
+        // it on the way if enabled (the input is left unchanged)
+        MirroredRing& inputHistory = detectors.inputHistory[size_t(k)];
+        float* const filtered = inputHistory.prepare(nDetected);
+        detectors.decimators[size_t(k)].process(input[k], filtered, nSamples, firstOutput);
+        detectors.prefilters[size_t(k)].process(filtered, filtered, nDetected);
+
+        // with phase detection, the detector sees the phase relative to the target instead
+        if (currThreshType == PHASE)
+        {
+            detectors.phaseEstimators[size_t(k)].process(filtered, filtered, nDetected, settings.phaseTarget);
+        }
+
+        inputHistory.commit(nDetected);
+        const float* const rp = filtered;
+
+        // store threshold for each sample of current buffer, after those of the previous ones
+        MirroredRing& thresholdHistory = detectors.thresholdHistory[size_t(k)];
+        float* const pThresh = thresholdHistory.prepare(nDetected);
+
+        // turn off event from previous buffer if necessary
+        Event& turnoff = turnoffEvents[size_t(k)];
+        if (turnoff.channel >= 0)
+        {
+            int turnoffOffset = int(std::max<int64_t>(0, turnoff.sampleNumber - startTs));
+            if (turnoffOffset < nSamples)
+            {
+                events.push_back(turnoff);
+                events.back().offset = turnoffOffset;
+                turnoff.channel = -1;
+            }
+        }
+
+        switch (currThreshType)
+        {
+        case CONSTANT:
+            std::fill(pThresh, pThresh + nDetected, settings.constantThresh);
+            break;
+
+        case RANDOM:
+            std::fill(pThresh, pThresh + nDetected, detectors.randomThresh[size_t(k)]);
+            break;
+
+        case CHANNEL:
+            std::copy(threshChan, threshChan + nDetected, pThresh);
+            break;
+
+        case ADAPTIVE:
+            detectors.adaptiveThresh[size_t(k)].process(rp, pThresh, nDetected);
+            break;
+
+        case PHASE:
+            std::fill(pThresh, pThresh + nDetected, 0.0f);
+            break;
+
+        default:
+            break;
+        }
+
+        // record which samples are above threshold, for voting
+        const int64_t bufferPos = detectors.aboveHistory[size_t(k)].append(rp, pThresh, nDetected);
+
+        Host host{ this, k, currThreshType, rp, pThresh, nDetected, nSamples, firstOutput, decimation,
+            PolyphaseDecimator::groupDelay(decimation), startTs, bufferPos };
+
+        // crossing indices are evaluated once enough of their future span is available
+        CrossingKernel::Buffer buffer;
+        buffer.input = rp;
+        buffer.threshold = pThresh;
+        buffer.numSamples = nDetected;
+        buffer.firstIndex = settings.useBufferEndMask
+            ? nDetected - bufferEndMaskSamp
+            : -futureSpan;
+
+        CrossingKernel::State state = detectors.getState(k);
+        numEvaluated += CrossingKernel::detectCrossings(host, config, state, buffer);
+
+        // shift indices so they are relative to the next buffer; no crossing index
+        // before -futureSpan can be evaluated there
+        state.sampToReenable = std::max(-futureSpan, state.sampToReenable - nDetected);
+        state.nextIndex = std::max(-futureSpan, state.nextIndex - nDetected);
+        detectors.setState(k, state);
+
+        thresholdHistory.commit(nDetected);
+    }
+
+    return numEvaluated;
+}
@@ -0,0 +1,364 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CROSSING_ENGINE_H_INCLUDED
+#define CROSSING_ENGINE_H_INCLUDED
+
+/*
+The crossing detector of one stream, independent of the GUI (the crossing_engine library).
+
+It reads buffers of raw samples of the monitored channels, in consecutive calls to process(),
+and returns the events they produce as plain structs: one "on" event per crossing that passes
+all criteria, and an "off" event eventDuration later, which is held back until the buffer it
+falls in. The plugin is an adapter that turns them into TTL events; offline tools use the
+engine directly.
+
+The parameters are the public 'settings'. As in the plugin, changing one during processing
+takes effect with the next buffer, except those that need an update function (listed with
+each group) to be called afterwards, on the same thread as process().
+
+Real-time contract: after start(maxBufferSize), process() doesn't allocate or free memory,
+take locks or make system calls for buffers of up to maxBufferSize samples. Everything it
+writes to is allocated beforehand, and the update functions (and setChannels()) that resize or
+reset the detectors reserve again for maxBufferSize, outside process(). The only exceptions are
+a larger buffer, which grows the storage once, and more than 65536 events in one buffer.
+crossing-detector-tool rt-check checks this.
+*/
+
+#include "AdaptiveThreshold.h"
+#include "BiquadCascade.h"
+#include "BitHistory.h"
+#include "CrossingKernel.h"
+#include "MirroredRing.h"
+#include "PhaseEstimator.h"
+#include "PolyphaseDecimator.h"
+#include "RandomGenerator.h"
+#include "StateSnapshot.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** Detector state for each monitored channel, stored as parallel arrays indexed by the
+ *  channel's position among the monitored ones.
+ */
+class CrossingDetectorBank
+{
+public:
+    CrossingDetectorBank();
+
+    /** Sets the number of monitored channels and resets all detector state */
+    void setChannels(int numChannels, int pastSpan, int futureSpan, float initialThresh);
+
+    /** Resets histories, counters and timeouts (e.g. when the spans change) */
+    void reset(int pastSpan, int futureSpan);
+
+    /** Allocates the histories for buffers of up to maxBufferSize samples */
+    void reserve(int maxBufferSize);
+
+    /** Number of monitored channels */
+    int size() const { return int(sampToReenable.size()); }
+
+    /** Detector state of channel k, for the kernel */
+    CrossingKernel::State getState(int k) const;
+    void setState(int k, const CrossingKernel::State& state);
+
+    /** Writes the state of all channels to a snapshot. */
+    void saveState(StateWriter& out) const;
+
+    /** Restores the state of all channels, which must have the same settings as when it was saved. */
+    void restoreState(StateReader& in);
+
+    std::vector<int> sampToReenable;
+    std::vector<int> jumpLimitElapsed;
+    std::vector<int> nextIndex;         // first crossing index not evaluated yet, relative to the next buffer
+    std::vector<int> armedDirections;   // with hysteresis, the directions that may trigger
+    std::vector<int> pastSamplesAbove;
+    std::vector<int> futureSamplesAbove;
+    std::vector<float> randomThresh;    // current threshold when using random thresholds
+    std::vector<AdaptiveThreshold> adaptiveThresh; // amplitude estimate when using adaptive thresholds
+    std::vector<PolyphaseDecimator> decimators; // to the detection rate, before the input filter
+    std::vector<BiquadCascade> prefilters; // input filter, applied on the way into the input history
+    std::vector<PhaseEstimator> phaseEstimators; // when detecting phases, turns the input into phases
+
+    // Input and threshold values of each channel. The current buffer is written directly after
+    // the last futureSpan + 2 values of the previous ones, for crossings that are evaluated once
+    // their future span has arrived.
+    std::vector<MirroredRing> inputHistory;
+    std::vector<MirroredRing> thresholdHistory;
+
+    // one bit per sample (input > threshold) to implement past/future voting
+    std::vector<BitHistory> aboveHistory;
+};
+
+class CrossingEngine
+{
+public:
+    /** Parameters. Times are in ms and spans in samples of the input. */
+    struct Settings
+    {
+        Settings();
+
+        // Factor by which the monitored channels are decimated before detection (1 = not
+        // decimated). Filters, thresholds and the kernel run at the detection rate; events are
+        // still placed at sample numbers of the input.
+        // Update: updateDecimators(), updateSampleRateDependentValues(), updatePrefilters(),
+        // updatePhaseEstimators(), resetDetectors().
+        int decimation;
+
+        // filter for the monitored channels. Update: updatePrefilters().
+        BiquadCascade::Type prefilterType;
+        int prefilterOrder;         // of each cutoff
+        float prefilterLowCut;      // Hz, the high-pass cutoff
+        float prefilterHighCut;     // Hz, the low-pass cutoff of a band-pass
+
+        ThresholdType thresholdType; // with RANDOM, call resetRandomThresh()
+
+        // if using constant threshold:
+        float constantThresh;
+
+        // if using random thresholds (update: resetRandomThresh()):
+        float randomThreshRange[2];
+
+        // if using adaptive thresholds (multiplier * moving RMS, mean |x| or median |x| of the
+        // input). Update: updateAdaptiveThresholds().
+        AdaptiveThreshold::Estimator adaptiveEstimator;
+        float adaptiveMultiplier;
+        int adaptiveTimeConstMs;
+        int adaptiveUpdateMs;       // how often the median is recomputed
+        bool useAdaptiveFreeze;     // fix the threshold once calibrated
+        int adaptiveCalibrationMs;  // after the start of acquisition
+
+        // if detecting phases (the input's estimated phase reaching a target):
+        float phaseTarget;      // degrees, 0 = peak, 180 = trough
+        float phaseFreq;        // Hz, center of the band the phase is estimated in (update: updatePhaseEstimators())
+        float phaseBandwidth;   // Hz (update: updatePhaseEstimators())
+
+        bool posOn;
+        bool negOn;
+
+        // update: updateSampleRateDependentValues()
+        int eventDuration;
+        int timeout;            // after an event onset when no more events are allowed
+
+        bool useBufferEndMask;
+        int bufferEndMaskMs;    // update: updateSampleRateDependentValues()
+
+        /* Number of *additional* past and future samples to look at at each timepoint (attention span)
+         * With decimation, the spans cover at least as much time at the detection rate.
+         * If futureSpan samples are not available to look ahead from a timepoint, the test is delayed until enough samples are available.
+         * If it succeeds, the event occurs on the first sample in the buffer when the test occurs, but the "crossing point"
+         * metadata field will contain the timepoint of the actual crossing.
+         * Update: resetDetectors().
+         */
+        int pastSpan;
+        int futureSpan;
+
+        // fraction of spans required to be above / below threshold
+        float pastStrict;
+        float futureStrict;
+
+        // Decide as soon as the future samples seen so far guarantee or rule out the future
+        // criterion, instead of always waiting for all futureSpan samples. Update: resetDetectors().
+        bool earlyDecision;
+
+        // maximum absolute difference between x[k] and x[k-1] to trigger an event on x[k]
+        bool useJumpLimit;
+        float jumpLimit;
+        float jumpLimitSleep;   // seconds
+
+        // After an event, the same direction can only trigger again once the signal has been
+        // at least this far on the other side of the threshold (a Schmitt trigger).
+        // Update: disarmHysteresis() when switching it on or off.
+        bool useHysteresis;
+        float hysteresis;
+
+        // how the crossing time is interpolated between samples
+        CrossingKernel::Interpolation interpolation;
+    };
+
+    /** An event of one channel. The "on" and "off" events of a crossing have the same crossing fields. */
+    struct Event
+    {
+        int64_t sampleNumber;   // where the event is placed
+        int offset;             // of sampleNumber from the start of the buffer it was returned for
+        int channel;            // position of the channel among the monitored ones
+        bool on;                // turning on (at the crossing) or off (eventDuration later)
+
+        // With decimation, crossingPoint, crossingTime and latency (and the "on" event, if the
+        // crossing is in the buffer) are corrected for the delay of the anti-aliasing filter.
+        int64_t crossingPoint;  // sample number of the first sample after the crossing
+        float crossingLevel;    // input at crossingPoint (for phase detection, a phase in degrees)
+        float threshold;        // threshold at crossingPoint (likewise)
+        int latency;            // samples from crossingPoint to the end of the buffer in which it was detected
+        double crossingTime;    // sample number of the crossing, interpolated between samples
+
+        /** 1 for a rising crossing, 0 for a falling one */
+        bool rising() const { return crossingLevel > threshold; }
+    };
+
+    CrossingEngine();
+
+    Settings settings;
+
+    float sampleRate; // of the input; update: updateSampleRateDependentValues()
+
+    /** Sets the input's sample rate and the number of monitored channels and applies all
+     *  settings, which resets the detectors (and draws a random threshold). For offline use,
+     *  after changing several settings at once.
+     */
+    void configure(float inputSampleRate, int numChannels);
+
+    /** Sets the number of monitored channels, which resets their state. */
+    void setChannels(int numChannels);
+
+    /** Number of monitored channels */
+    int getNumChannels() const { return detectors.size(); }
+
+    /** Converts parameters specified in ms to samples, and updates the corresponding member variables. */
+    void updateSampleRateDependentValues();
+
+    /** Sample rate the detection runs at, after decimation */
+    float detectionRate() const;
+
+    /** Converts a number of input samples to the number of samples at the detection rate that
+     *  covers them (rounding up).
+     */
+    int toDetectionSamples(int inputSamples) const;
+
+    /** Resets the detector state of all channels for the current spans. */
+    void resetDetectors();
+
+    /** Applies the decimation factor to all channels (and the threshold channel), which clears their history. */
+    void updateDecimators();
+
+    /** Applies the adaptive threshold settings to the estimators of all channels. */
+    void updateAdaptiveThresholds();
+
+    /** Redesigns the input filters of all channels, which clears their state. */
+    void updatePrefilters();
+
+    /** Checks the input filter of the given settings for an input at the given sample rate (not
+     *  checked if 0): a band-pass's low cutoff must be below its high cutoff, and the cutoffs must
+     *  be below the Nyquist frequency of the detection rate. Returns why they aren't, or an empty
+     *  string if they are. updatePrefilters() clamps the cutoffs to the Nyquist frequency, but
+     *  can't make an empty band-pass work.
+     */
+    static std::string checkPrefilter(const Settings& candidate, float inputSampleRate);
+
+    /** Applies the phase estimate's band to all channels, which clears their state. */
+    void updatePhaseEstimators();
+
+    /** Disarms both directions of all channels until the signal has been beyond the hysteresis. */
+    void disarmHysteresis();
+
+    /** Seeds the generator of random thresholds. */
+    void setRandomSeed(int64_t seed);
+
+    /** Selects a new random threshold and uses it for all channels. */
+    void resetRandomThresh();
+
+    /** Most recent random threshold, or the adaptive threshold of the first channel, or the
+     *  constant threshold (or phase target).
+     */
+    float getCurrentThreshold() const;
+
+    /** Maximum number of events that a buffer of up to maxBufferSize samples can return with the current timeout */
+    int maxEventsPerBuffer(int maxBufferSize) const;
+
+    /** Prepares for processing a new recording, starting from the current settings: clears
+     *  the filters and adaptive thresholds and allocates for buffers of up to maxBufferSize
+     *  samples (larger buffers work but allocate). Later changes of the channels, spans or
+     *  timeout keep that reservation.
+     */
+    void start(int maxBufferSize);
+
+    /** Ends a recording: cancels pending "off" events and doesn't trigger on old data when
+     *  starting again.
+     */
+    void stop();
+
+    /** Processes the next numSamples samples of each channel, the first of which has the given
+     *  sample number. input[k] holds the samples of channel k, or is null if the channel is
+     *  missing (it is then skipped). With CHANNEL thresholds, thresholdInput holds the threshold
+     *  for each sample. The events are in getEvents() until the next call.
+     *  Returns the number of crossing indices evaluated.
+     *  Doesn't allocate for buffers of up to the size given to start() (see above).
+     */
+    int process(const float* const* input, const float* thresholdInput, int numSamples, int64_t firstSampleNumber);
+
+    /** Events of the last buffer, in the order they occurred for each channel, channels in order */
+    const std::vector<Event>& getEvents() const { return events; }
+
+    /** Writes the state that process() carries from one buffer to the next to 'snapshot':
+     *  histories, vote counters, timeouts, pending "off" events, filters, thresholds and the
+     *  random generator. Processing the same input after restoring it gives the same events as
+     *  it would have after saving it, and two engines with the same settings whose snapshots are
+     *  equal produce the same events from then on.
+     */
+    void saveState(std::vector<uint8_t>& snapshot) const;
+
+    /** Restores a snapshot saved by an engine with the same settings and number of channels
+     *  (e.g. for another part of a recording). Returns false, leaving the state undefined until
+     *  the next start(), if the snapshot doesn't fit.
+     */
+    bool restoreState(const std::vector<uint8_t>& snapshot);
+
+private:
+    /** Select a new random threshold using randomThreshRange and rng. */
+    float nextRandomThresh();
+
+    /** Adds the on event of a crossing and its off event (now or for a later buffer). */
+    void addCrossing(int k, int64_t firstSampleNumber, int numSamples, int indCross, const Event& crossing);
+
+    /** Writes or reads an event field by field (without padding) */
+    static void saveEvent(StateWriter& out, const Event& event);
+    static void restoreEvent(StateReader& in, Event& event);
+
+    /** Allocates the histories and events for buffers of up to reservedBufferSize samples with
+     *  the current channels and settings (nothing before start()).
+     */
+    void reserveBuffers();
+
+    struct Host;
+
+    int reservedBufferSize; // given to start(), 0 before
+    int eventDurationSamp;  // at the input's sample rate
+    int timeoutSamp;        // at the detection rate
+    int bufferEndMaskSamp;  // at the detection rate
+
+    float currRandomThresh; // most recently drawn threshold
+    RandomGenerator rng;
+
+    CrossingDetectorBank detectors; // one detector per monitored channel
+
+    std::vector<Event> turnoffEvents; // per channel, an "off" event for a later buffer (if channel >= 0)
+
+    // decimates the threshold channel along with the monitored channels
+    PolyphaseDecimator thresholdDecimator;
+    std::vector<float> decimatedThreshold;
+
+    std::vector<Event> events;
+};
+
+#endif // CROSSING_ENGINE_H_INCLUDED
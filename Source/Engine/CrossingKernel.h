@@ -0,0 +1,566 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CROSSING_KERNEL_H_INCLUDED
+#define CROSSING_KERNEL_H_INCLUDED
+
+/*
+Detection kernels for one buffer of one input channel.
+
+Everything that stays fixed during a buffer - threshold type, crossing directions, whether
+past/future voting is used and whether jumps are limited - is a template argument, so each
+instantiation is a loop without configuration branches. detectCrossings selects the
+instantiation once per buffer.
+
+The kernels know nothing about the GUI's event system. The input and threshold arrays of a
+Buffer continue the previous buffers: they must be readable from index -futureSpan - 2 on.
+Voting counts and the reaction to a crossing are provided by a Host object with these members:
+
+    int countAbove(int from, int to);            // number of samples above threshold in [from, to)
+    void trigger(int indCross, int decisionInd, float crossingOffset, float crossingLevel, float threshold);
+
+Indices are relative to the first sample of the current buffer. trigger() is called for each
+crossing that passes all criteria, with the index of the last sample the decision was based on
+(indCross + futureSpan, or earlier with early decisions); with RANDOM thresholds, it is expected
+to write the next threshold into the per-sample threshold array from index decisionInd + 1 on.
+crossingOffset is where the input crossed the threshold, interpolated between the samples around
+the crossing, relative to indCross (in (-1, 0]). It is only computed for crossings that trigger.
+
+With hysteresis, a direction is disarmed when it triggers, and only rearmed once a sample is at
+least the hysteresis below (rising) or above (falling) the threshold. Whether that happened is
+only checked when a crossing in the direction would trigger, and at the end of the buffer, by
+scanning the samples since the last check; so the state is one bit per direction.
+
+With early decisions, a crossing is decided as soon as the future samples that have arrived
+either guarantee that the future criterion holds or make it impossible, so crossing indices up
+to the last sample of the buffer can be evaluated. A crossing that is still undecided at the end
+of a buffer is evaluated again in the next one; State::nextIndex records where to resume.
+*/
+
+#include "CrossingScan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+enum ThresholdType { CONSTANT = 0, RANDOM, CHANNEL, ADAPTIVE, PHASE, NUM_THRESHOLDS };
+
+namespace CrossingKernel
+{
+    /** How the time of a crossing between two samples is estimated */
+    enum Interpolation
+    {
+        LINEAR = 0, // straight line through the samples on either side
+        CUBIC,      // Catmull-Rom spline through those and the next sample on each side
+        NUM_INTERPOLATIONS
+    };
+
+    /** Settings that are constant during one buffer */
+    struct Config
+    {
+        ThresholdType thresholdType;
+        int directions;             // combination of CrossingScan::Direction flags
+
+        int pastSpan;
+        int futureSpan;
+        int pastSamplesNeeded;      // samplesNeeded(pastSpan, pastStrict)
+        int futureSamplesNeeded;    // samplesNeeded(futureSpan, futureStrict)
+
+        bool useJumpLimit;
+        float jumpLimit;
+        float jumpLimitSleepSamp;   // number of evaluations to skip after a jump
+
+        int timeoutSamp;
+        float constantThresh;       // only used with CONSTANT thresholds (PHASE compares with 0)
+
+        bool earlyDecision;         // decide as soon as the future criterion is certain
+
+        bool useHysteresis;
+        float hysteresis;           // distance from the threshold at which a direction is rearmed
+
+        Interpolation interpolation; // of the crossing time
+    };
+
+    /** Detector state that carries over from one buffer to the next */
+    struct State
+    {
+        // the crossing index at which the detector is reenabled after a timeout, relative to the current buffer
+        int sampToReenable;
+        int jumpLimitElapsed;
+
+        // first crossing index that has not been evaluated yet, relative to the current buffer
+        int nextIndex;
+
+        // with hysteresis, the directions that may trigger (CrossingScan::Direction flags);
+        // the samples before nextIndex have been checked
+        int armed;
+
+        // voting counters, describing the windows around crossing index nextIndex - 1
+        // (the future counter is not used with early decisions)
+        int pastSamplesAbove;
+        int futureSamplesAbove;
+    };
+
+    /** The current buffer */
+    struct Buffer
+    {
+        const float* input;         // preceded by at least futureSpan + 2 earlier samples
+        const float* threshold;     // per-sample thresholds, likewise (may be modified by Host::trigger)
+        int numSamples;
+        int firstIndex;             // crossings before this index are skipped (buffer end mask)
+    };
+
+    template <ThresholdType Type>
+    struct ThresholdOf
+    {
+        using type = CrossingScan::ThresholdArray;
+        static type make(const Config&, const Buffer& buffer) { return { buffer.threshold }; }
+    };
+
+    template <>
+    struct ThresholdOf<CONSTANT>
+    {
+        using type = CrossingScan::ThresholdConstant;
+        static type make(const Config& config, const Buffer&) { return { config.constantThresh }; }
+    };
+
+    // the input is the phase relative to the target, so the target is reached where it crosses 0
+    template <>
+    struct ThresholdOf<PHASE>
+    {
+        using type = CrossingScan::ThresholdConstant;
+        static type make(const Config&, const Buffer&) { return { 0.0f }; }
+    };
+
+    /** The number of samples of a span that must be on the correct side for a fraction 'strict'
+     *  of it. The fraction is taken to 0.01%: 0.6f is slightly more than 0.6, and ceil(25 * 0.6f)
+     *  would need 16 samples out of 25 rather than 15.
+     */
+    inline int samplesNeeded(int span, float strict)
+    {
+        const int64_t hundredthsOfPercent = std::lround(double(strict) * 10000.0);
+        return int((int64_t(span) * hundredthsOfPercent + 9999) / 10000);
+    }
+
+    /* Whether a crossing in the given direction should trigger an event, given the past counter,
+     * the number of samples above threshold among the first futureKnown samples of the future
+     * window, and the values and thresholds surrounding the point where a crossing may be.
+     * Also counts down the sleep period after a jump.
+     */
+    template <bool Rising, bool Voting, bool JumpLimit>
+    inline bool shouldTrigger(const Config& config, State& state,
+        float preVal, float postVal, float preThresh, float postThresh, int futureAbove, int futureKnown)
+    {
+        if (JumpLimit && std::abs(postVal - preVal) >= config.jumpLimit)
+        {
+            state.jumpLimitElapsed = 0;
+            return false;
+        }
+
+        if (state.jumpLimitElapsed < config.jumpLimitSleepSamp)
+        {
+            state.jumpLimitElapsed++;
+            return false;
+        }
+
+        bool preSat = Rising != (preVal > preThresh);
+        bool postSat = Rising == (postVal > postThresh);
+
+        if (!Voting)
+            return preSat && postSat;
+
+        bool pastSat = (Rising ? config.pastSpan - state.pastSamplesAbove : state.pastSamplesAbove)
+            >= config.pastSamplesNeeded;
+        bool futureSat = (Rising ? futureAbove : futureKnown - futureAbove) >= config.futureSamplesNeeded;
+
+        return preSat && postSat && pastSat && futureSat;
+    }
+
+    /* Offset from indCross, in (-1, 0], at which input minus threshold crosses zero between samples
+     * indCross - 1 and indCross. The cubic spline also needs the sample after indCross; if that
+     * hasn't arrived yet, the crossing is interpolated linearly.
+     */
+    inline float crossingOffset(Interpolation interpolation, const float* x, const float* thresh,
+        int indCross, int numSamples)
+    {
+        // differences before and after the crossing, which have opposite signs (or d0 is 0)
+        const float d0 = x[indCross - 1] - thresh[indCross - 1];
+        const float d1 = x[indCross] - thresh[indCross];
+        if (d0 == 0.0f)
+        {
+            return -1.0f;
+        }
+
+        float t = d0 / (d0 - d1);
+
+        if (interpolation == CUBIC && indCross + 1 < numSamples)
+        {
+            const float dm = x[indCross - 2] - thresh[indCross - 2];
+            const float d2 = x[indCross + 1] - thresh[indCross + 1];
+
+            // Catmull-Rom spline from d0 (t = 0) to d1 (t = 1): ((c3 t + c2) t + c1) t + d0
+            const float c1 = 0.5f * (d1 - dm);
+            const float c2 = dm - 2.5f * d0 + 2.0f * d1 - 0.5f * d2;
+            const float c3 = 0.5f * (d2 - dm) + 1.5f * (d0 - d1);
+
+            // Newton's method from the linear estimate, falling back to bisection when a step
+            // leaves the interval known to contain the root
+            float lo = 0.0f;
+            float hi = 1.0f;
+            for (int iter = 0; iter < 8; ++iter)
+            {
+                float value = ((c3 * t + c2) * t + c1) * t + d0;
+                float slope = (3.0f * c3 * t + 2.0f * c2) * t + c1;
+                if (value == 0.0f)
+                {
+                    break;
+                }
+
+                ((value > 0.0f) == (d1 > 0.0f) ? hi : lo) = t;
+
+                float next = t - value / slope;
+                if (next >= lo && next <= hi)
+                {
+                    bool converged = std::abs(next - t) < 1e-4f;
+                    t = next;
+                    if (converged)
+                    {
+                        break;
+                    }
+                }
+                else
+                {
+                    t = 0.5f * (lo + hi);
+                }
+            }
+        }
+
+        return t - 1.0f;
+    }
+
+    /* Whether the outcome of a crossing that satisfies everything but possibly the future criterion
+     * still depends on future samples that have not arrived. A sleep period or jump may make the
+     * wait unnecessary, but waiting never changes the outcome.
+     */
+    template <int Dirs>
+    inline bool isUndecided(const Config& config, const State& state,
+        float preVal, float postVal, float preThresh, float postThresh, int futureAbove, int futureKnown)
+    {
+        int missing = config.futureSpan - futureKnown;
+        int needed = config.futureSamplesNeeded;
+
+        auto undecided = [&](int agreeing)
+        {
+            return agreeing < needed && agreeing + missing >= needed;
+        };
+
+        bool preAbove = preVal > preThresh;
+        bool postAbove = postVal > postThresh;
+
+        if ((Dirs & CrossingScan::RISING) && !preAbove && postAbove
+            && config.pastSpan - state.pastSamplesAbove >= config.pastSamplesNeeded
+            && undecided(futureAbove))
+        {
+            return true;
+        }
+
+        return (Dirs & CrossingScan::FALLING) && preAbove && !postAbove
+            && state.pastSamplesAbove >= config.pastSamplesNeeded
+            && undecided(futureKnown - futureAbove);
+    }
+
+    /** Evaluates all crossing indices of one buffer that can be decided.
+     *  Returns the number of crossing indices that were evaluated (candidates).
+     */
+    template <ThresholdType Type, int Dirs, bool Voting, bool JumpLimit, typename Host>
+    int detect(Host& host, const Config& config, State& state, const Buffer& buffer)
+    {
+        const float* const x = buffer.input;
+        const typename ThresholdOf<Type>::type thresh = ThresholdOf<Type>::make(config, buffer);
+        const int pastSpan = Voting ? config.pastSpan : 0;
+        const int futureSpan = Voting ? config.futureSpan : 0;
+        const bool early = Voting && config.earlyDecision && futureSpan > 0;
+        const int n = buffer.numSamples;
+
+        // the last crossing index that can be evaluated needs all of its future span,
+        // or with early decisions just the sample after the crossing
+        const int indEnd = early ? n : n - futureSpan;
+
+        // thresholds as stored with the samples; with CONSTANT thresholds, those before the
+        // buffer may differ from 'thresh' if the threshold was changed in between
+        const CrossingScan::ThresholdArray storedThresh{ buffer.threshold };
+
+        // The voting counters describe the windows around crossing index 'countedInd'.
+        // Rather than being updated at every sample, they are brought up to date when a
+        // candidate is evaluated, by counting what left and entered each window.
+        // With early decisions, the future window is counted as far as it is available instead.
+        int countedInd = state.nextIndex - 1;
+        auto advanceCounters = [&](int indCross)
+        {
+            int gap = indCross - countedInd;
+
+            if (pastSpan > 0)
+            {
+                // past window is [indCross - 1 - pastSpan, indCross - 1)
+                if (gap < 0 || 2 * gap >= pastSpan)
+                {
+                    state.pastSamplesAbove = host.countAbove(indCross - 1 - pastSpan, indCross - 1);
+                }
+                else
+                {
+                    state.pastSamplesAbove += host.countAbove(countedInd - 1, indCross - 1)
+                        - host.countAbove(countedInd - 1 - pastSpan, indCross - 1 - pastSpan);
+                }
+            }
+
+            if (futureSpan > 0 && !early)
+            {
+                // future window is [indCross + 1, indCross + 1 + futureSpan)
+                if (gap < 0 || 2 * gap >= futureSpan)
+                {
+                    state.futureSamplesAbove = host.countAbove(indCross + 1, indCross + 1 + futureSpan);
+                }
+                else
+                {
+                    state.futureSamplesAbove += host.countAbove(countedInd + 1 + futureSpan, indCross + 1 + futureSpan)
+                        - host.countAbove(countedInd + 1, indCross + 1);
+                }
+            }
+
+            countedInd = indCross;
+        };
+
+        // Returns the next candidate from 'from' on. Candidates whose previous sample is in the
+        // history are found by comparing with the stored thresholds.
+        auto nextCandidate = [&](int from)
+        {
+            if (from < 1)
+            {
+                int boundaryEnd = std::min(1, indEnd);
+                from = CrossingScan::findCandidate<Dirs, JumpLimit>(x, storedThresh, from, boundaryEnd,
+                    config.jumpLimit);
+                if (from < boundaryEnd)
+                {
+                    return from;
+                }
+            }
+            return CrossingScan::findCandidate<Dirs, JumpLimit>(x, thresh, from, indEnd, config.jumpLimit);
+        };
+
+        // Returns whether the given direction is armed at crossing index indCross, scanning the
+        // samples since the last check for one that rearms it.
+        int armCheckedTo[2] = { state.nextIndex, state.nextIndex };
+        auto isArmed = [&](int direction, int indCross)
+        {
+            int d = direction == CrossingScan::RISING ? 0 : 1;
+            if (!(state.armed & direction))
+            {
+                for (int j = armCheckedTo[d]; j < indCross; ++j)
+                {
+                    if (direction == CrossingScan::RISING
+                        ? x[j] <= storedThresh[j] - config.hysteresis
+                        : x[j] > storedThresh[j] + config.hysteresis)
+                    {
+                        state.armed |= direction;
+                        break;
+                    }
+                }
+            }
+            armCheckedTo[d] = indCross;
+            return (state.armed & direction) != 0;
+        };
+
+        // Between candidates returned by the scanner, shouldTrigger could neither return true nor
+        // change any state, so those samples are skipped - unless we are sleeping after a jump,
+        // in which case every evaluation counts towards the sleep period.
+        int indCross = std::max(state.nextIndex, buffer.firstIndex);
+        int nextIndex = indEnd;
+        int numEvaluated = 0;
+
+        while (Dirs != 0)
+        {
+            indCross = std::max(indCross, state.sampToReenable);
+
+            if (state.jumpLimitElapsed >= config.jumpLimitSleepSamp)
+            {
+                indCross = nextCandidate(indCross);
+            }
+
+            if (indCross >= indEnd)
+            {
+                break;
+            }
+            ++numEvaluated;
+
+            if (Voting)
+            {
+                advanceCounters(indCross);
+            }
+
+            float preVal = x[indCross - 1];
+            float preThresh = storedThresh[indCross - 1];
+            float postVal = x[indCross];
+            float postThresh = storedThresh[indCross];
+
+            int futureKnown = futureSpan;
+            int futureAbove = state.futureSamplesAbove;
+
+            if (early)
+            {
+                futureKnown = std::min(futureSpan, n - 1 - indCross);
+                futureAbove = host.countAbove(indCross + 1, indCross + 1 + futureKnown);
+
+                if (futureKnown < futureSpan && isUndecided<Dirs>(config, state,
+                        preVal, postVal, preThresh, postThresh, futureAbove, futureKnown))
+                {
+                    // wait for more samples
+                    nextIndex = indCross;
+                    break;
+                }
+            }
+
+            int direction = 0;
+            if ((Dirs & CrossingScan::RISING) &&
+                shouldTrigger<true, Voting, JumpLimit>(config, state, preVal, postVal, preThresh, postThresh,
+                    futureAbove, futureKnown))
+            {
+                direction = CrossingScan::RISING;
+            }
+            else if ((Dirs & CrossingScan::FALLING) &&
+                shouldTrigger<false, Voting, JumpLimit>(config, state, preVal, postVal, preThresh, postThresh,
+                    futureAbove, futureKnown))
+            {
+                direction = CrossingScan::FALLING;
+            }
+
+            if (direction != 0 && config.useHysteresis && !isArmed(direction, indCross))
+            {
+                direction = 0;
+            }
+
+            if (direction != 0)
+            {
+                host.trigger(indCross, indCross + futureKnown,
+                    crossingOffset(config.interpolation, x, buffer.threshold, indCross, n), postVal, postThresh);
+                state.sampToReenable = indCross + 1 + config.timeoutSamp;
+                state.armed &= ~direction;
+            }
+
+            ++indCross;
+        }
+
+        // check the rest of the samples before the next index, so that only the armed bits carry over
+        if (config.useHysteresis)
+        {
+            if (Dirs & CrossingScan::RISING)
+            {
+                isArmed(CrossingScan::RISING, nextIndex);
+            }
+            if (Dirs & CrossingScan::FALLING)
+            {
+                isArmed(CrossingScan::FALLING, nextIndex);
+            }
+        }
+
+        // leave the counters describing the index before the next one to evaluate
+        if (Voting)
+        {
+            advanceCounters(nextIndex - 1);
+        }
+        state.nextIndex = nextIndex;
+        return numEvaluated;
+    }
+
+    namespace Dispatch
+    {
+        template <ThresholdType Type, int Dirs, bool Voting, typename Host>
+        int jumpLimit(Host& host, const Config& config, State& state, const Buffer& buffer)
+        {
+            if (config.useJumpLimit)
+                return detect<Type, Dirs, Voting, true>(host, config, state, buffer);
+            else
+                return detect<Type, Dirs, Voting, false>(host, config, state, buffer);
+        }
+
+        template <ThresholdType Type, int Dirs, typename Host>
+        int voting(Host& host, const Config& config, State& state, const Buffer& buffer)
+        {
+            if (config.pastSpan > 0 || config.futureSpan > 0)
+                return jumpLimit<Type, Dirs, true>(host, config, state, buffer);
+            else
+                return jumpLimit<Type, Dirs, false>(host, config, state, buffer);
+        }
+
+        template <ThresholdType Type, typename Host>
+        int directions(Host& host, const Config& config, State& state, const Buffer& buffer)
+        {
+            switch (config.directions)
+            {
+            case CrossingScan::RISING:
+                return voting<Type, CrossingScan::RISING>(host, config, state, buffer);
+
+            case CrossingScan::FALLING:
+                return voting<Type, CrossingScan::FALLING>(host, config, state, buffer);
+
+            case CrossingScan::BOTH:
+                return voting<Type, CrossingScan::BOTH>(host, config, state, buffer);
+
+            default:
+                // nothing to detect, but the voting counters must still follow the signal
+                if (config.pastSpan > 0 || config.futureSpan > 0)
+                    return detect<Type, 0, true, false>(host, config, state, buffer);
+                return 0;
+            }
+        }
+    }
+
+    /** Runs the kernel instantiation that matches the configuration on one buffer.
+     *  Returns the number of crossing indices that were evaluated.
+     */
+    template <typename Host>
+    int detectCrossings(Host& host, const Config& config, State& state, const Buffer& buffer)
+    {
+        switch (config.thresholdType)
+        {
+        case CONSTANT:
+            return Dispatch::directions<CONSTANT>(host, config, state, buffer);
+
+        case RANDOM:
+            return Dispatch::directions<RANDOM>(host, config, state, buffer);
+
+        case CHANNEL:
+            return Dispatch::directions<CHANNEL>(host, config, state, buffer);
+
+        case ADAPTIVE:
+            return Dispatch::directions<ADAPTIVE>(host, config, state, buffer);
+
+        case PHASE:
+            return Dispatch::directions<PHASE>(host, config, state, buffer);
+
+        default:
+            return 0;
+        }
+    }
+}
+
+#endif // CROSSING_KERNEL_H_INCLUDED
@@ -0,0 +1,377 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CROSSING_SCAN_H_INCLUDED
+#define CROSSING_SCAN_H_INCLUDED
+
+/*
+Vectorized front end for the crossing detector.
+
+Crossings are rare compared to the number of samples, so instead of evaluating the full
+trigger criteria at every sample, the detector asks this scanner for the next "candidate"
+index: a sample whose relation to the threshold differs from the previous sample's (in an
+enabled direction), or, if jump limiting is on, a sample that jumps by at least the limit.
+Every other sample is guaranteed not to change the detector's state.
+
+Samples are scanned in blocks. For each block, the minimum and maximum of (input - threshold)
+are computed first; if the whole block stays strictly on the same side of the threshold as
+the sample before it (and no jump is possible), the block is skipped. Only blocks that might
+contain a candidate are examined sample by sample, using compare masks.
+
+x[from - 1] and t[from - 1] must be readable; 'from' may be negative if the arrays continue
+before index 0.
+The results are exactly those of the scalar definitions in isCandidate and packAbove.
+*/
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CROSSING_SCAN_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#define CROSSING_SCAN_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CROSSING_SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CROSSING_SCAN_TARGET_AVX2
+#endif
+
+namespace CrossingScan
+{
+    /** Crossing directions, combined as a bit set */
+    enum Direction
+    {
+        RISING = 1,     // below-or-at threshold -> above threshold
+        FALLING = 2,    // above threshold -> below-or-at threshold
+        BOTH = RISING | FALLING
+    };
+
+    /** Threshold given for each sample */
+    struct ThresholdArray
+    {
+        const float* t;
+
+        float operator[](int k) const { return t[k]; }
+#if CROSSING_SCAN_SSE2
+        __m128 load4(int k) const { return _mm_loadu_ps(t + k); }
+#endif
+#if CROSSING_SCAN_AVX2
+        CROSSING_SCAN_TARGET_AVX2 __m256 load8(int k) const { return _mm256_loadu_ps(t + k); }
+#endif
+    };
+
+    /** Same threshold for all samples (nothing to load) */
+    struct ThresholdConstant
+    {
+        float value;
+
+        float operator[](int) const { return value; }
+#if CROSSING_SCAN_SSE2
+        __m128 load4(int) const { return _mm_set1_ps(value); }
+#endif
+#if CROSSING_SCAN_AVX2
+        CROSSING_SCAN_TARGET_AVX2 __m256 load8(int) const { return _mm256_set1_ps(value); }
+#endif
+    };
+
+    /** Scalar definition of a candidate sample, for the directions in Dirs and, if CheckJump
+        is set, jumps of |x[k] - x[k-1]| >= jumpLimit.
+    */
+    template <int Dirs, bool CheckJump, typename Threshold>
+    inline bool isCandidate(const float* x, const Threshold& t, int k, float jumpLimit)
+    {
+        bool preAbove = x[k - 1] > t[k - 1];
+        bool postAbove = x[k] > t[k];
+
+        if ((Dirs & RISING) && !preAbove && postAbove)
+            return true;
+
+        if ((Dirs & FALLING) && preAbove && !postAbove)
+            return true;
+
+        return CheckJump && std::abs(x[k] - x[k - 1]) >= jumpLimit;
+    }
+
+    template <int Dirs, bool CheckJump, typename Threshold>
+    inline int findCandidateScalar(const float* x, const Threshold& t, int from, int to, float jumpLimit)
+    {
+        for (int k = from; k < to; ++k)
+        {
+            if (isCandidate<Dirs, CheckJump>(x, t, k, jumpLimit))
+                return k;
+        }
+        return to;
+    }
+
+    inline uint64_t packAboveScalar(const float* x, const float* t, int n)
+    {
+        uint64_t bits = 0;
+        for (int k = 0; k < n; ++k)
+        {
+            bits |= uint64_t(x[k] > t[k] ? 1 : 0) << k;
+        }
+        return bits;
+    }
+
+    inline int countTrailingZeros(unsigned int bits)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, bits);
+        return int(index);
+#else
+        return __builtin_ctz(bits);
+#endif
+    }
+
+#if CROSSING_SCAN_SSE2
+
+    /** SSE2 scanner: blocks of 16 samples (4 vectors) */
+    template <int Dirs, bool CheckJump, typename Threshold>
+    inline int findCandidateSse2(const float* x, const Threshold& t, int from, int to, float jumpLimit)
+    {
+        const int blockSize = 16;
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        const __m128 limit = _mm_set1_ps(jumpLimit);
+
+        int k = from;
+        for (; k + blockSize <= to; k += blockSize)
+        {
+            // pruning pass: min/max of the difference signal and the largest jump
+            __m128 minDiff = _mm_set1_ps(INFINITY);
+            __m128 maxDiff = _mm_set1_ps(-INFINITY);
+            __m128 nanFound = zero;
+            __m128 maxJump = zero;
+
+            for (int v = 0; v < blockSize; v += 4)
+            {
+                __m128 xv = _mm_loadu_ps(x + k + v);
+                __m128 diff = _mm_sub_ps(xv, t.load4(k + v));
+                minDiff = _mm_min_ps(minDiff, diff);
+                maxDiff = _mm_max_ps(maxDiff, diff);
+                nanFound = _mm_or_ps(nanFound, _mm_cmpunord_ps(diff, diff));
+
+                if (CheckJump)
+                {
+                    __m128 jump = _mm_and_ps(_mm_sub_ps(xv, _mm_loadu_ps(x + k + v - 1)), absMask);
+                    maxJump = _mm_max_ps(maxJump, jump);
+                }
+            }
+
+            bool prevAbove = x[k - 1] > t[k - 1];
+            bool sameSide = _mm_movemask_ps(nanFound) == 0 && (prevAbove
+                ? _mm_movemask_ps(_mm_cmpgt_ps(minDiff, zero)) == 0xF
+                : _mm_movemask_ps(_mm_cmplt_ps(maxDiff, zero)) == 0xF);
+            bool noJump = !CheckJump || _mm_movemask_ps(_mm_cmplt_ps(maxJump, limit)) == 0xF;
+
+            if (sameSide && noJump)
+                continue;
+
+            // exact pass
+            for (int v = 0; v < blockSize; v += 4)
+            {
+                const float* xk = x + k + v;
+                __m128 xv = _mm_loadu_ps(xk);
+                __m128 xPrev = _mm_loadu_ps(xk - 1);
+                __m128 above = _mm_cmpgt_ps(xv, t.load4(k + v));
+                __m128 preAbove = _mm_cmpgt_ps(xPrev, t.load4(k + v - 1));
+
+                __m128 cand = zero;
+                if (Dirs & RISING)
+                    cand = _mm_or_ps(cand, _mm_andnot_ps(preAbove, above));
+                if (Dirs & FALLING)
+                    cand = _mm_or_ps(cand, _mm_andnot_ps(above, preAbove));
+                if (CheckJump)
+                    cand = _mm_or_ps(cand, _mm_cmpge_ps(_mm_and_ps(_mm_sub_ps(xv, xPrev), absMask), limit));
+
+                int bits = _mm_movemask_ps(cand);
+                if (bits != 0)
+                    return k + v + countTrailingZeros(unsigned(bits));
+            }
+        }
+
+        return findCandidateScalar<Dirs, CheckJump>(x, t, k, to, jumpLimit);
+    }
+
+    inline uint64_t packAboveSse2(const float* x, const float* t, int n)
+    {
+        uint64_t bits = 0;
+        int k = 0;
+        for (; k + 4 <= n; k += 4)
+        {
+            __m128 above = _mm_cmpgt_ps(_mm_loadu_ps(x + k), _mm_loadu_ps(t + k));
+            bits |= uint64_t(_mm_movemask_ps(above)) << k;
+        }
+        return k < n ? bits | (packAboveScalar(x + k, t + k, n - k) << k) : bits;
+    }
+
+#endif // CROSSING_SCAN_SSE2
+
+#if CROSSING_SCAN_AVX2
+
+    /** AVX2 scanner: blocks of 32 samples (4 vectors) */
+    template <int Dirs, bool CheckJump, typename Threshold>
+    CROSSING_SCAN_TARGET_AVX2
+    inline int findCandidateAvx2(const float* x, const Threshold& t, int from, int to, float jumpLimit)
+    {
+        const int blockSize = 32;
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+        const __m256 limit = _mm256_set1_ps(jumpLimit);
+
+        int k = from;
+        for (; k + blockSize <= to; k += blockSize)
+        {
+            __m256 minDiff = _mm256_set1_ps(INFINITY);
+            __m256 maxDiff = _mm256_set1_ps(-INFINITY);
+            __m256 nanFound = zero;
+            __m256 maxJump = zero;
+
+            for (int v = 0; v < blockSize; v += 8)
+            {
+                __m256 xv = _mm256_loadu_ps(x + k + v);
+                __m256 diff = _mm256_sub_ps(xv, t.load8(k + v));
+                minDiff = _mm256_min_ps(minDiff, diff);
+                maxDiff = _mm256_max_ps(maxDiff, diff);
+                nanFound = _mm256_or_ps(nanFound, _mm256_cmp_ps(diff, diff, _CMP_UNORD_Q));
+
+                if (CheckJump)
+                {
+                    __m256 jump = _mm256_and_ps(_mm256_sub_ps(xv, _mm256_loadu_ps(x + k + v - 1)), absMask);
+                    maxJump = _mm256_max_ps(maxJump, jump);
+                }
+            }
+
+            bool prevAbove = x[k - 1] > t[k - 1];
+            bool sameSide = _mm256_movemask_ps(nanFound) == 0 && (prevAbove
+                ? _mm256_movemask_ps(_mm256_cmp_ps(minDiff, zero, _CMP_GT_OQ)) == 0xFF
+                : _mm256_movemask_ps(_mm256_cmp_ps(maxDiff, zero, _CMP_LT_OQ)) == 0xFF);
+            bool noJump = !CheckJump || _mm256_movemask_ps(_mm256_cmp_ps(maxJump, limit, _CMP_LT_OQ)) == 0xFF;
+
+            if (sameSide && noJump)
+                continue;
+
+            for (int v = 0; v < blockSize; v += 8)
+            {
+                const float* xk = x + k + v;
+                __m256 xv = _mm256_loadu_ps(xk);
+                __m256 xPrev = _mm256_loadu_ps(xk - 1);
+                __m256 above = _mm256_cmp_ps(xv, t.load8(k + v), _CMP_GT_OQ);
+                __m256 preAbove = _mm256_cmp_ps(xPrev, t.load8(k + v - 1), _CMP_GT_OQ);
+
+                __m256 cand = zero;
+                if (Dirs & RISING)
+                    cand = _mm256_or_ps(cand, _mm256_andnot_ps(preAbove, above));
+                if (Dirs & FALLING)
+                    cand = _mm256_or_ps(cand, _mm256_andnot_ps(above, preAbove));
+                if (CheckJump)
+                    cand = _mm256_or_ps(cand, _mm256_cmp_ps(
+                        _mm256_and_ps(_mm256_sub_ps(xv, xPrev), absMask), limit, _CMP_GE_OQ));
+
+                int bits = _mm256_movemask_ps(cand);
+                if (bits != 0)
+                    return k + v + countTrailingZeros(unsigned(bits));
+            }
+        }
+
+        return findCandidateSse2<Dirs, CheckJump>(x, t, k, to, jumpLimit);
+    }
+
+    CROSSING_SCAN_TARGET_AVX2
+    inline uint64_t packAboveAvx2(const float* x, const float* t, int n)
+    {
+        uint64_t bits = 0;
+        int k = 0;
+        for (; k + 8 <= n; k += 8)
+        {
+            __m256 above = _mm256_cmp_ps(_mm256_loadu_ps(x + k), _mm256_loadu_ps(t + k), _CMP_GT_OQ);
+            bits |= uint64_t(_mm256_movemask_ps(above)) << k;
+        }
+        return k < n ? bits | (packAboveSse2(x + k, t + k, n - k) << k) : bits;
+    }
+
+    /** Whether the CPU (and OS) support AVX2. Checked once. */
+    inline bool hasAvx2()
+    {
+        static const bool supported = []
+        {
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+                return false;
+            __cpuid(info, 1);
+            bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+            __cpuidex(info, 7, 0);
+            return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") != 0;
+#endif
+        }();
+        return supported;
+    }
+
+#endif // CROSSING_SCAN_AVX2
+
+    /** Returns the first candidate index in [from, to), or 'to' if there is none. */
+    template <int Dirs, bool CheckJump, typename Threshold>
+    inline int findCandidate(const float* x, const Threshold& t, int from, int to, float jumpLimit)
+    {
+#if CROSSING_SCAN_AVX2
+        if (hasAvx2())
+            return findCandidateAvx2<Dirs, CheckJump>(x, t, from, to, jumpLimit);
+#endif
+#if CROSSING_SCAN_SSE2
+        return findCandidateSse2<Dirs, CheckJump>(x, t, from, to, jumpLimit);
+#else
+        return findCandidateScalar<Dirs, CheckJump>(x, t, from, to, jumpLimit);
+#endif
+    }
+
+    /** Returns a word whose bit k (for k < n <= 64) is set iff x[k] > t[k]. */
+    inline uint64_t packAbove(const float* x, const float* t, int n)
+    {
+#if CROSSING_SCAN_AVX2
+        if (hasAvx2())
+            return packAboveAvx2(x, t, n);
+#endif
+#if CROSSING_SCAN_SSE2
+        return packAboveSse2(x, t, n);
+#else
+        return packAboveScalar(x, t, n);
+#endif
+    }
+}
+
+#endif // CROSSING_SCAN_H_INCLUDED
@@ -0,0 +1,179 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef LOG_HISTOGRAM_H_INCLUDED
+#define LOG_HISTOGRAM_H_INCLUDED
+
+/*
+Streaming quantile sketch of the magnitudes |x| of a signal, with exponentially decaying weights.
+
+Magnitudes are counted in logarithmically spaced bins: 8 per octave from 2^-20 to 2^24, plus
+one bin below and one above that range. The bin of a value is read directly from the exponent
+and the top mantissa bits of its float representation, so adding a sample is a shift and an
+increment. Quantiles are interpolated linearly within their bin, which keeps the relative error
+below 1/8.
+
+Older samples are forgotten with a time constant given in samples. Rather than decaying every
+bin after each buffer, new samples are added with a weight that grows by the decay factor, and
+everything is rescaled once that weight gets large. Memory and cost per sample are therefore
+constant, whatever the time constant. Samples added in one call share a weight.
+*/
+
+#include "StateSnapshot.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+class LogHistogram
+{
+public:
+    /** Creates an empty histogram without decay. */
+    LogHistogram() : timeConstant(HUGE_VAL), weight(1.0), total(0.0)
+    {
+        reset();
+    }
+
+    /** Removes all samples. */
+    void reset()
+    {
+        bins.fill(0.0);
+        weight = 1.0;
+        total = 0.0;
+    }
+
+    /** Sets the time constant (in samples) with which older samples are forgotten. */
+    void setTimeConstant(double samples)
+    {
+        timeConstant = std::max(samples, 1.0);
+    }
+
+    /** Adds the magnitudes of numSamples samples. */
+    void add(const float* x, int numSamples)
+    {
+        if (numSamples <= 0)
+        {
+            return;
+        }
+
+        // older samples weigh exp(numSamples / timeConstant) times less relative to these ones
+        weight *= std::exp(double(numSamples) / timeConstant);
+        if (weight > MAX_WEIGHT)
+        {
+            // (if the weight overflowed, the older samples are negligible and become 0)
+            for (double& bin : bins)
+            {
+                bin /= weight;
+            }
+            total /= weight;
+            weight = 1.0;
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            bins[binOf(x[i])] += weight;
+        }
+        total += weight * numSamples;
+    }
+
+    /** True if no samples have been added since the last reset. */
+    bool isEmpty() const { return total <= 0.0; }
+
+    /** Estimates the magnitude below which the given fraction of the (weighted) samples lie. */
+    float quantile(double fraction) const
+    {
+        double target = std::min(std::max(fraction, 0.0), 1.0) * total;
+        double cumulative = 0.0;
+
+        for (int bin = 0; bin < NUM_BINS; ++bin)
+        {
+            if (bins[bin] > 0.0 && cumulative + bins[bin] >= target)
+            {
+                double position = (target - cumulative) / bins[bin];
+                float lower = lowerEdge(bin);
+                float upper = bin + 1 < NUM_BINS ? lowerEdge(bin + 1) : lower;
+                return lower + float(position) * (upper - lower);
+            }
+            cumulative += bins[bin];
+        }
+
+        return 0.0f;
+    }
+
+    /** Writes the weighted samples to a snapshot. */
+    void saveState(StateWriter& out) const
+    {
+        out.write(bins.data(), bins.size());
+        out.write(weight);
+        out.write(total);
+    }
+
+    /** Restores the weighted samples from a snapshot. */
+    void restoreState(StateReader& in)
+    {
+        in.read(bins.data(), bins.size());
+        in.read(weight);
+        in.read(total);
+    }
+
+private:
+    static const int BINS_PER_OCTAVE_BITS = 3;  // 8 bins per octave
+    static const int MIN_EXPONENT = -20;
+    static const int MAX_EXPONENT = 24;
+    static const int MANTISSA_SHIFT = 23 - BINS_PER_OCTAVE_BITS;
+    static const int FIRST_BIN_KEY = (127 + MIN_EXPONENT) << BINS_PER_OCTAVE_BITS;
+    static const int NUM_BINS = ((MAX_EXPONENT - MIN_EXPONENT) << BINS_PER_OCTAVE_BITS) + 2;
+    static constexpr double MAX_WEIGHT = 1e100;
+
+    /** Bin 0 holds magnitudes below 2^MIN_EXPONENT, the last bin those from 2^MAX_EXPONENT on (and NaN). */
+    static int binOf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof bits);
+        int key = int((bits & 0x7fffffffu) >> MANTISSA_SHIFT); // exponent and top mantissa bits of |value|
+        return std::min(std::max(key - FIRST_BIN_KEY + 1, 0), NUM_BINS - 1);
+    }
+
+    /** Smallest magnitude in a bin */
+    static float lowerEdge(int bin)
+    {
+        if (bin == 0)
+        {
+            return 0.0f;
+        }
+
+        uint32_t bits = uint32_t(bin - 1 + FIRST_BIN_KEY) << MANTISSA_SHIFT;
+        float value;
+        std::memcpy(&value, &bits, sizeof value);
+        return value;
+    }
+
+    std::array<double, NUM_BINS> bins;
+    double timeConstant;
+    double weight;      // weight of the next samples
+    double total;       // sum of all bins
+};
+
+#endif // LOG_HISTOGRAM_H_INCLUDED
@@ -0,0 +1,167 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef MIRRORED_RING_H_INCLUDED
+#define MIRRORED_RING_H_INCLUDED
+
+/*
+Ring of float samples in which the retained history and the samples being added always form
+one contiguous array, so a detector can read x[-historyLength] ... x[numSamples - 1] through
+a single pointer, without wrapping or branching on the index.
+
+The storage holds two copies ("halves") of a ring with a power-of-two capacity. New samples
+are written where the history directly before them is contiguous: at their ring position in
+the lower half if the history fits below it, otherwise at the same position in the upper half.
+For that to work, the last historyLength samples must be readable in either half, so each
+commit copies them to the other half as well.
+*/
+
+#include "StateSnapshot.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class MirroredRing
+{
+public:
+    /** Creates an empty ring. */
+    MirroredRing() : historyLength(0), capacity(0), endPos(0) {}
+
+    /** Sets the number of samples that must be retained behind the end and zeroes them. */
+    void reset(int length)
+    {
+        historyLength = length > 0 ? length : 0;
+        endPos = 0;
+        std::fill(values.begin(), values.end(), 0.0f);
+        reserve(1);
+    }
+
+    /** Makes room for writing numNewSamples at once without losing any of the retained
+        samples. Only allocates if the current capacity is too small.
+    */
+    void reserve(int numNewSamples)
+    {
+        size_t needed = size_t(historyLength) + size_t(numNewSamples > 0 ? numNewSamples : 0);
+        if (needed <= capacity)
+            return;
+
+        size_t newCapacity = 16;
+        while (newCapacity < needed)
+            newCapacity *= 2;
+
+        // copy the retained samples to the same positions of both halves of the new ring
+        std::vector<float> grown(2 * newCapacity, 0.0f);
+        for (uint64_t pos = endPos - uint64_t(historyLength); pos != endPos; ++pos)
+        {
+            float value = capacity > 0 ? values[size_t(pos & (capacity - 1))] : 0.0f;
+            grown[size_t(pos & (newCapacity - 1))] = value;
+            grown[size_t(pos & (newCapacity - 1)) + newCapacity] = value;
+        }
+
+        values.swap(grown);
+        capacity = newCapacity;
+    }
+
+    /** Returns where the next numNewSamples samples must be written. The retained history
+        is readable at negative indices of the returned pointer. Call commit() once written.
+    */
+    float* prepare(int numNewSamples)
+    {
+        reserve(numNewSamples);
+        return values.data() + writeIndex();
+    }
+
+    /** Appends the numNewSamples samples written to the pointer returned by prepare(). */
+    void commit(int numNewSamples)
+    {
+        // mirror the part of the new samples that becomes the retained history
+        size_t n = size_t(std::min(numNewSamples, historyLength));
+        size_t first = writeIndex() + size_t(numNewSamples) - n;
+        size_t last = first + n;
+
+        if (first < capacity)
+        {
+            size_t end = std::min(last, capacity);
+            std::memcpy(values.data() + first + capacity, values.data() + first, (end - first) * sizeof(float));
+        }
+        if (last > capacity)
+        {
+            size_t start = std::max(first, capacity);
+            std::memcpy(values.data() + start - capacity, values.data() + start, (last - start) * sizeof(float));
+        }
+
+        endPos += uint64_t(numNewSamples);
+    }
+
+    /** Copies numNewSamples samples to the end of the ring and returns where they are. */
+    const float* append(const float* x, int numNewSamples)
+    {
+        float* dest = prepare(numNewSamples);
+        std::memcpy(dest, x, size_t(numNewSamples) * sizeof(float));
+        commit(numNewSamples);
+        return dest;
+    }
+
+    /** Writes the retained samples to a snapshot. */
+    void saveState(StateWriter& out) const
+    {
+        out.write(historyLength);
+        for (uint64_t pos = endPos - uint64_t(historyLength); pos != endPos; ++pos)
+        {
+            out.write(capacity > 0 ? values[size_t(pos & (capacity - 1))] : 0.0f);
+        }
+    }
+
+    /** Restores the retained samples of a ring with the same history length. */
+    void restoreState(StateReader& in)
+    {
+        if (!in.expect(historyLength))
+        {
+            return;
+        }
+
+        std::vector<float> history(static_cast<size_t>(historyLength));
+        if (in.read(history.data(), history.size()))
+        {
+            reset(historyLength);
+            append(history.data(), historyLength);
+        }
+    }
+
+private:
+    /** Position in the storage where the samples after the current end are written */
+    size_t writeIndex() const
+    {
+        size_t index = size_t(endPos & (capacity - 1));
+        return index < size_t(historyLength) ? index + capacity : index;
+    }
+
+    std::vector<float> values; // two halves of 'capacity' samples
+    int historyLength;
+    size_t capacity;           // a power of two, > historyLength
+    uint64_t endPos;
+};
+
+#endif // MIRRORED_RING_H_INCLUDED
@@ -0,0 +1,153 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef PHASE_ESTIMATOR_H_INCLUDED
+#define PHASE_ESTIMATOR_H_INCLUDED
+
+/*
+Causal estimate of the instantaneous phase of one channel in a frequency band, for detecting
+when the phase reaches a target.
+
+The analytic signal is estimated with a complex band-pass filter: two cascaded one-pole
+resonators with their pole at the center frequency (on the positive side only), so negative
+frequencies are suppressed along with everything outside the band. Each pole is normalized to
+unit gain and zero phase shift at the center frequency, so like an endpoint-corrected Hilbert
+transform, the phase of the newest sample is not delayed for signals at the center frequency.
+Unlike a windowed transform, each sample costs a few multiply-adds and an atan2.
+
+Phases are in degrees, in (-180, 180]: 0 at a peak of the band-passed signal, 180 at a trough,
+-90 where it crosses zero going up. process() writes the phase relative to the target, wrapped
+to the same range, so the target is reached where the output crosses 0 going up; the wraps
+happen half a cycle away, as jumps of almost 360 degrees.
+*/
+
+#include "StateSnapshot.h"
+
+#include <algorithm>
+#include <cmath>
+
+class PhaseEstimator
+{
+public:
+    /** Creates an estimator that must be designed before use. */
+    PhaseEstimator() : poleRe(0.0), poleIm(0.0), gain(1.0)
+    {
+        reset();
+    }
+
+    /** Sets the band (in Hz) and clears the state. bandwidth is the -3 dB width of each pole. */
+    void design(double centerFreq, double bandwidth, double sampleRate)
+    {
+        if (sampleRate > 0)
+        {
+            const double pi = 3.14159265358979323846;
+            double r = std::exp(-pi * std::max(bandwidth, 1e-3) / sampleRate);
+            double w = 2.0 * pi * centerFreq / sampleRate;
+            poleRe = r * std::cos(w);
+            poleIm = r * std::sin(w);
+            gain = 1.0 - r;
+        }
+
+        reset();
+    }
+
+    /** Clears the state, as if the input had been 0 so far. */
+    void reset()
+    {
+        re1 = im1 = re2 = im2 = 0.0;
+    }
+
+    /** Writes the phase (in degrees) of each input sample relative to targetPhase to 'out',
+     *  which may be the same array as 'in'.
+     */
+    void process(const float* in, float* out, int numSamples, float targetPhase)
+    {
+        const double degPerRad = 180.0 / 3.14159265358979323846;
+        const double pr = poleRe;
+        const double pi = poleIm;
+        double r1 = re1, i1 = im1, r2 = re2, i2 = im2;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            // s1 = gain * x + pole * s1; s2 = gain * s1 + pole * s2
+            double nr1 = gain * in[i] + pr * r1 - pi * i1;
+            double ni1 = pr * i1 + pi * r1;
+            double nr2 = gain * nr1 + pr * r2 - pi * i2;
+            double ni2 = gain * ni1 + pr * i2 + pi * r2;
+            r1 = nr1;
+            i1 = ni1;
+            r2 = nr2;
+            i2 = ni2;
+
+            float relative = float(std::atan2(i2, r2) * degPerRad) - targetPhase;
+            out[i] = wrap(relative);
+        }
+
+        re1 = r1;
+        im1 = i1;
+        re2 = r2;
+        im2 = i2;
+    }
+
+    /** Wraps a difference of two phases to (-180, 180]. */
+    static float wrap(float phase)
+    {
+        if (phase > 180.0f)
+        {
+            return phase - 360.0f;
+        }
+        if (phase <= -180.0f)
+        {
+            return phase + 360.0f;
+        }
+        return phase;
+    }
+
+    /** Writes the state of the poles to a snapshot. */
+    void saveState(StateWriter& out) const
+    {
+        const double values[] = { re1, im1, re2, im2 };
+        out.write(values, 4);
+    }
+
+    /** Restores the state of the poles from a snapshot. */
+    void restoreState(StateReader& in)
+    {
+        double values[4];
+        if (in.read(values, 4))
+        {
+            re1 = values[0];
+            im1 = values[1];
+            re2 = values[2];
+            im2 = values[3];
+        }
+    }
+
+private:
+    double poleRe, poleIm;
+    double gain;
+    double re1, im1;    // output of the first pole
+    double re2, im2;    // analytic signal estimate
+};
+
+#endif // PHASE_ESTIMATOR_H_INCLUDED
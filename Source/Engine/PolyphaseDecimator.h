@@ -0,0 +1,243 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef POLYPHASE_DECIMATOR_H_INCLUDED
+#define POLYPHASE_DECIMATOR_H_INCLUDED
+
+/*
+Anti-aliased decimation of one channel by an integer factor, so that detection can run at a
+lower rate than the stream.
+
+The anti-aliasing filter is a linear-phase FIR low-pass (a Hamming-windowed sinc) with
+TAPS_PER_PHASE taps per output sample. It passes frequencies up to about 0.28 times the output
+rate (within 1 dB) and attenuates everything at or above the output Nyquist frequency by more
+than 50 dB. Only every factor-th output of the filter is computed, which is what a polyphase
+decimator does: each output costs TAPS_PER_PHASE * factor multiply-adds, i.e. TAPS_PER_PHASE
+per input sample. The filter delays the signal by (TAPS_PER_PHASE * factor - 1) / 2 input
+samples, i.e. about TAPS_PER_PHASE / 2 output samples (see groupDelay()), which the engine
+subtracts from the times of the crossings it reports.
+
+Which input samples produce an output is decided by the caller (see firstOutput()), so that all
+channels of a stream, and the sample numbers of their events, stay on the same grid however
+the stream is split into buffers. The coefficients and history are stored in fixed-size arrays,
+so changing the factor never allocates.
+*/
+
+#include "StateSnapshot.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POLYPHASE_DECIMATOR_SSE2 1
+#include <emmintrin.h>
+#endif
+
+class PolyphaseDecimator
+{
+public:
+    /** Largest supported decimation factor */
+    static const int MAX_FACTOR = 32;
+
+    /** Number of filter taps per output sample */
+    static const int TAPS_PER_PHASE = 12; // a multiple of 4
+
+    /** Creates a decimator with a factor of 1, which passes its input through. */
+    PolyphaseDecimator()
+    {
+        design(1);
+    }
+
+    /** Sets the decimation factor, designs the anti-aliasing filter and clears the history. */
+    void design(int newFactor)
+    {
+        factor = std::min(std::max(newFactor, 1), int(MAX_FACTOR));
+
+        if (factor == 1)
+        {
+            numTaps = 1;
+            coeffs[0] = 1.0f;
+        }
+        else
+        {
+            const double pi = 3.14159265358979323846;
+            const double cutoff = 0.35 / factor; // fraction of the input rate
+            numTaps = TAPS_PER_PHASE * factor;
+
+            double sum = 0;
+            for (int i = 0; i < numTaps; ++i)
+            {
+                double t = i - (numTaps - 1) / 2.0;
+                double sinc = t == 0 ? 2 * cutoff : std::sin(2 * pi * cutoff * t) / (pi * t);
+                double window = 0.54 - 0.46 * std::cos(2 * pi * i / (numTaps - 1));
+                coeffs[size_t(i)] = float(sinc * window);
+                sum += sinc * window;
+            }
+
+            // unit gain at DC
+            for (int i = 0; i < numTaps; ++i)
+            {
+                coeffs[size_t(i)] = float(coeffs[size_t(i)] / sum);
+            }
+        }
+
+        reset();
+    }
+
+    /** Clears the history, as if the input had been 0 so far. */
+    void reset()
+    {
+        std::fill(staging.begin(), staging.end(), 0.0f);
+    }
+
+    /** Decimation factor */
+    int getFactor() const { return factor; }
+
+    /** Delay of the anti-aliasing filter in input samples, (TAPS_PER_PHASE * factor - 1) / 2
+     *  (0 without decimation).
+     */
+    static double groupDelay(int factor)
+    {
+        return factor > 1 ? (TAPS_PER_PHASE * factor - 1) / 2.0 : 0.0;
+    }
+
+    /** Index within a buffer of the first input sample that produces an output, given the sample
+     *  number of the buffer's first sample. Outputs are produced by the samples whose sample
+     *  number + 1 is a multiple of the factor.
+     */
+    static int firstOutput(long long firstSampleNumber, int factor)
+    {
+        long long pos = firstSampleNumber % factor;
+        return int((2 * factor - 1 - pos) % factor);
+    }
+
+    /** Number of outputs that numSamples input samples produce, with the first one at firstOutputInd. */
+    static int numOutputs(int numSamples, int firstOutputInd, int factor)
+    {
+        return firstOutputInd < numSamples ? (numSamples - 1 - firstOutputInd) / factor + 1 : 0;
+    }
+
+    /** Filters numSamples input samples and writes the outputs produced by the samples at
+     *  firstOutputInd, firstOutputInd + factor, ... to 'out', which may be the same array as 'in'.
+     *  Returns the number of outputs written.
+     */
+    int process(const float* in, float* out, int numSamples, int firstOutputInd)
+    {
+        if (factor == 1)
+        {
+            if (out != in)
+            {
+                std::copy(in, in + numSamples, out);
+            }
+            return numSamples;
+        }
+
+        // The input is copied in chunks after the last numTaps - 1 samples, so that the inputs of
+        // each output are contiguous.
+        const int historySize = numTaps - 1;
+        int numOut = 0;
+        int next = firstOutputInd;
+
+        for (int chunkStart = 0; chunkStart < numSamples; chunkStart += CHUNK_SIZE)
+        {
+            const int chunkSize = std::min(int(CHUNK_SIZE), numSamples - chunkStart);
+            std::copy(in + chunkStart, in + chunkStart + chunkSize, staging.begin() + historySize);
+
+            for (; next < chunkStart + chunkSize; next += factor)
+            {
+                // inputs [next - numTaps + 1, next], oldest first; the filter is symmetric
+                out[numOut++] = dot(staging.data() + (next - chunkStart));
+            }
+
+            // keep the last numTaps - 1 samples for the next chunk
+            std::copy(staging.begin() + chunkSize, staging.begin() + chunkSize + historySize, staging.begin());
+        }
+
+        return numOut;
+    }
+
+    /** Writes the history to a snapshot. */
+    void saveState(StateWriter& out) const
+    {
+        out.write(factor);
+        out.write(staging.data(), size_t(numTaps - 1));
+    }
+
+    /** Restores the history of a decimator with the same factor from a snapshot. */
+    void restoreState(StateReader& in)
+    {
+        if (in.expect(factor))
+        {
+            in.read(staging.data(), size_t(numTaps - 1));
+        }
+    }
+
+private:
+    /** Sum of the products of the coefficients and numTaps samples. numTaps is a multiple of 4,
+     *  so the sum is split into 4 independent partial sums (one vector with SSE2).
+     */
+    float dot(const float* x) const
+    {
+        const float* h = coeffs.data();
+
+#if POLYPHASE_DECIMATOR_SSE2
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        int t = 0;
+        for (; t + 8 <= numTaps; t += 8)
+        {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(h + t), _mm_loadu_ps(x + t)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(h + t + 4), _mm_loadu_ps(x + t + 4)));
+        }
+        if (t < numTaps)
+        {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(h + t), _mm_loadu_ps(x + t)));
+        }
+
+        float sums[4];
+        _mm_storeu_ps(sums, _mm_add_ps(acc0, acc1));
+        return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+#else
+        float y0 = 0, y1 = 0, y2 = 0, y3 = 0;
+        for (int t = 0; t < numTaps; t += 4)
+        {
+            y0 += h[t] * x[t];
+            y1 += h[t + 1] * x[t + 1];
+            y2 += h[t + 2] * x[t + 2];
+            y3 += h[t + 3] * x[t + 3];
+        }
+        return (y0 + y1) + (y2 + y3);
+#endif
+    }
+
+    static const int MAX_TAPS = TAPS_PER_PHASE * MAX_FACTOR;
+    static const int CHUNK_SIZE = 1024;
+
+    int factor;
+    int numTaps;
+    std::array<float, MAX_TAPS> coeffs;
+    std::array<float, MAX_TAPS - 1 + CHUNK_SIZE> staging; // the last numTaps - 1 inputs, then a chunk
+};
+
+#endif // POLYPHASE_DECIMATOR_H_INCLUDED
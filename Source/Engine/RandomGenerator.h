@@ -0,0 +1,68 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef RANDOM_GENERATOR_H_INCLUDED
+#define RANDOM_GENERATOR_H_INCLUDED
+
+/*
+Pseudo-random numbers for random thresholds.
+
+This is the 48-bit linear congruential generator of juce::Random, so that a given seed produces
+the same thresholds with or without the GUI (and the same as before the detector was separated
+from it). It is seeded explicitly: the plugin passes a random seed, offline tools a fixed one
+so that runs are reproducible.
+*/
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+
+class RandomGenerator
+{
+public:
+    explicit RandomGenerator(int64_t initialSeed = 1)
+        : seed(initialSeed)
+    {}
+
+    void setSeed(int64_t newSeed) { seed = newSeed; }
+    int64_t getSeed() const { return seed; }
+
+    /** Returns a random 32-bit integer */
+    int32_t nextInt()
+    {
+        seed = int64_t((uint64_t(seed) * 0x5deece66dULL + 11) & 0xffffffffffffULL);
+        return int32_t(seed >> 16);
+    }
+
+    /** Returns a random float in [0, 1) */
+    float nextFloat()
+    {
+        const float r = float(uint32_t(nextInt())) / (float(UINT32_MAX) + 1.0f);
+        return std::min(r, 1.0f - FLT_EPSILON); // rounding may give 1
+    }
+
+private:
+    int64_t seed;
+};
+
+#endif // RANDOM_GENERATOR_H_INCLUDED
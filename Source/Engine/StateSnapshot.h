@@ -0,0 +1,125 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef STATE_SNAPSHOT_H_INCLUDED
+#define STATE_SNAPSHOT_H_INCLUDED
+
+/*
+Serialization of the detector's state between two buffers (see CrossingEngine::saveState()).
+
+A snapshot is a flat array of bytes: the values are written one after the other in their native
+representation, without padding, so snapshots can be stored and compared byte for byte, but
+only restored on a machine of the same architecture. Each part of the state is written as what
+it means for later buffers (e.g. the retained history, not where it is in a ring), so that two
+detectors that will behave identically from then on have identical snapshots.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+class StateWriter
+{
+public:
+    explicit StateWriter(std::vector<uint8_t>& destination) : bytes(destination) {}
+
+    template <typename T>
+    void write(const T* values, size_t count)
+    {
+        static_assert(std::is_arithmetic<T>::value, "only numbers are written, to leave out padding");
+        const size_t start = bytes.size();
+        bytes.resize(start + count * sizeof(T));
+        if (count > 0)
+        {
+            std::memcpy(bytes.data() + start, values, count * sizeof(T));
+        }
+    }
+
+    template <typename T>
+    void write(T value)
+    {
+        write(&value, 1);
+    }
+
+private:
+    std::vector<uint8_t>& bytes;
+};
+
+class StateReader
+{
+public:
+    explicit StateReader(const std::vector<uint8_t>& source) : bytes(source), pos(0), failed(false) {}
+
+    /** Reads values, or fails (leaving them unchanged) if the snapshot is too short. */
+    template <typename T>
+    bool read(T* values, size_t count)
+    {
+        static_assert(std::is_arithmetic<T>::value, "only numbers are read");
+        if (failed || bytes.size() - pos < count * sizeof(T))
+        {
+            failed = true;
+            return false;
+        }
+        if (count > 0)
+        {
+            std::memcpy(values, bytes.data() + pos, count * sizeof(T));
+        }
+        pos += count * sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool read(T& value)
+    {
+        return read(&value, 1);
+    }
+
+    /** Reads a value that must equal 'expected' (e.g. a size), failing otherwise. */
+    template <typename T>
+    bool expect(T expected)
+    {
+        T value;
+        if (read(value) && value != expected)
+        {
+            failed = true;
+        }
+        return !failed;
+    }
+
+    /** Marks the snapshot as not fitting */
+    void fail() { failed = true; }
+
+    /** True if everything read so far was there and as expected */
+    bool ok() const { return !failed; }
+
+    /** True if the whole snapshot has been read */
+    bool atEnd() const { return pos == bytes.size(); }
+
+private:
+    const std::vector<uint8_t>& bytes;
+    size_t pos;
+    bool failed;
+};
+
+#endif // STATE_SNAPSHOT_H_INCLUDED
@@ -0,0 +1,124 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef PERF_COUNTERS_H_INCLUDED
+#define PERF_COUNTERS_H_INCLUDED
+
+/*
+Runtime statistics of the detector, one record per processed buffer, passed from the audio
+thread to the message thread without locks.
+
+The records go into a ring of the last CAPACITY buffers. The audio thread (the only writer)
+fills a slot and then publishes it by incrementing a counter; the reader copies the slots
+published since its last read and then checks the counter again, dropping any slot that the
+writer may have reused in the meantime (as with a seqlock). The fields are relaxed atomics, so
+neither side ever waits and a slow reader only loses old records.
+*/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+class PerfCounters
+{
+public:
+    /** Statistics of one buffer */
+    struct Record
+    {
+        float processUs;        // wall-clock time of the process() call
+        int samples;            // input samples processed, summed over the monitored channels
+        int candidates;         // crossing indices evaluated by the kernel
+        int events;             // events added (turning on and off)
+        float maxLatencyMs;     // longest decision latency of the buffer's crossings (0 if none)
+    };
+
+    /** Number of buffers kept in the ring */
+    static const int CAPACITY = 1024;
+
+    PerfCounters() : numWritten(0) {}
+
+    /** Publishes the record of one buffer. Must only be called by one thread. */
+    void push(const Record& record)
+    {
+        const int64_t n = numWritten.load(std::memory_order_relaxed);
+        Slot& slot = slots[size_t(n % CAPACITY)];
+        slot.processUs.store(record.processUs, std::memory_order_relaxed);
+        slot.samples.store(record.samples, std::memory_order_relaxed);
+        slot.candidates.store(record.candidates, std::memory_order_relaxed);
+        slot.events.store(record.events, std::memory_order_relaxed);
+        slot.maxLatencyMs.store(record.maxLatencyMs, std::memory_order_relaxed);
+        numWritten.store(n + 1, std::memory_order_release);
+    }
+
+    /** Copies the records published since the previous call (at most CAPACITY, oldest first) to
+     *  'out', which must have room for CAPACITY records. readCount is the number of records the
+     *  caller has seen, and is updated. Returns the number of records copied.
+     */
+    int pull(Record* out, int64_t& readCount) const
+    {
+        const int64_t end = numWritten.load(std::memory_order_acquire);
+        int64_t begin = std::max(readCount, end - CAPACITY);
+
+        for (int64_t i = begin; i < end; ++i)
+        {
+            const Slot& slot = slots[size_t(i % CAPACITY)];
+            Record& r = out[i - begin];
+            r.processUs = slot.processUs.load(std::memory_order_relaxed);
+            r.samples = slot.samples.load(std::memory_order_relaxed);
+            r.candidates = slot.candidates.load(std::memory_order_relaxed);
+            r.events = slot.events.load(std::memory_order_relaxed);
+            r.maxLatencyMs = slot.maxLatencyMs.load(std::memory_order_relaxed);
+        }
+
+        // the writer may have started reusing slots while they were copied: it is writing
+        // record 'after' at most, in the slot of record after - CAPACITY
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const int64_t after = numWritten.load(std::memory_order_relaxed);
+        const int64_t firstValid = std::max(begin, after - CAPACITY + 1);
+
+        int numValid = int(std::max<int64_t>(end - firstValid, 0));
+        if (firstValid > begin && numValid > 0)
+        {
+            std::copy(out + (firstValid - begin), out + (end - begin), out);
+        }
+
+        readCount = end;
+        return numValid;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<float> processUs { 0.0f };
+        std::atomic<int> samples { 0 };
+        std::atomic<int> candidates { 0 };
+        std::atomic<int> events { 0 };
+        std::atomic<float> maxLatencyMs { 0.0f };
+    };
+
+    std::array<Slot, CAPACITY> slots;
+    std::atomic<int64_t> numWritten;
+};
+
+#endif // PERF_COUNTERS_H_INCLUDED
@@ -0,0 +1,405 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef TRACE_RECORDER_H_INCLUDED
+#define TRACE_RECORDER_H_INCLUDED
+
+/*
+Optional timeline of the detector's activity, written as a Chrome trace (JSON) file that can be
+opened in Perfetto (ui.perfetto.dev) or chrome://tracing.
+
+Code is instrumented with the CROSSING_TRACE_SPAN macros, which record the time spent in the
+enclosing scope. They expand to nothing unless the plugin is built with
+CROSSING_DETECTOR_TRACING=1 (the ENABLE_TRACING CMake option), so tracing costs nothing in
+normal builds.
+
+When compiled in, a span is recorded only while the recorder is running: two reads of the time
+stamp counter (the steady clock on other architectures) and one slot of a preallocated
+multi-producer ring, claimed with a compare-and-swap. Any thread may record spans. If the ring
+is full, the span is dropped and counted rather than waited for. A background thread drains
+the ring to the file a few times per second, converting time stamps to microseconds.
+
+There is one recorder per process, shared by all instances of the plugin, so that they appear
+on the same timeline; it runs while at least one of them has started it.
+*/
+
+#ifndef CROSSING_DETECTOR_TRACING
+#define CROSSING_DETECTOR_TRACING 0
+#endif
+
+#if CROSSING_DETECTOR_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TRACE_RECORDER_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+class TraceRecorder
+{
+public:
+    /** Number of spans the ring holds (a power of 2) */
+    static const int CAPACITY = 16384;
+
+    /** The recorder shared by all instances of the plugin */
+    static TraceRecorder& getInstance()
+    {
+        static TraceRecorder instance;
+        return instance;
+    }
+
+    /** Starts recording to the given file, unless already running (in which case only the number
+     *  of users is incremented). Returns false if the file can't be opened.
+     */
+    bool start(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+
+        if (numUsers > 0)
+        {
+            ++numUsers;
+            return true;
+        }
+
+        file = std::fopen(path.c_str(), "w");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        filePath = path;
+
+        // discard anything left from the previous run
+        drain(false);
+        numDropped.store(0, std::memory_order_relaxed);
+        numWrittenToFile = 0;
+
+        std::fprintf(file, "{\"traceEvents\":[\n"
+            "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Crossing Detector\"}}");
+
+        originTicks = now();
+        originTime = std::chrono::steady_clock::now();
+        stopRequested = false;
+        ++numUsers;
+        recording.store(true, std::memory_order_release);
+
+        drainThread = std::thread([this] { run(); });
+        return true;
+    }
+
+    /** Stops recording once every user that started it has stopped it, and completes the file. */
+    void stop()
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+
+        if (numUsers == 0 || --numUsers > 0)
+        {
+            return;
+        }
+
+        recording.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> wakeLock(wakeMutex);
+            stopRequested = true;
+        }
+        wake.notify_one();
+        drainThread.join();
+
+        std::fprintf(file, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"spans\":\"%llu\",\"dropped_spans\":\"%llu\"}}\n",
+            (unsigned long long) numWrittenToFile,
+            (unsigned long long) numDropped.load(std::memory_order_relaxed));
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    /** File being written, or that was written last */
+    std::string getPath() const
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        return filePath;
+    }
+
+    /** Whether spans are being recorded */
+    bool isRecording() const
+    {
+        return recording.load(std::memory_order_relaxed);
+    }
+
+    /** Current time stamp, in ticks of an unspecified clock */
+    static uint64_t now()
+    {
+#if TRACE_RECORDER_TSC
+        return __rdtsc();
+#else
+        return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    /** Records a span of the calling thread. The name, category and argument name (which may be
+     *  null if there is no argument) must be string literals, as they are written out later.
+     */
+    void record(const char* category, const char* name, uint64_t begin, uint64_t end,
+        const char* argName, int arg)
+    {
+        uint64_t pos = writeCount.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        for (;;)
+        {
+            slot = &slots[size_t(pos & (CAPACITY - 1))];
+            const int64_t diff = int64_t(slot->sequence.load(std::memory_order_acquire) - pos);
+
+            if (diff == 0)
+            {
+                if (writeCount.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                // the ring is full
+                numDropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else
+            {
+                pos = writeCount.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->span = { category, name, argName, begin, end, threadIndex(), arg };
+        slot->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    /** Records the time spent in its scope, if the recorder is running when it is created */
+    class ScopedSpan
+    {
+    public:
+        ScopedSpan(const char* category_, const char* name_, const char* argName_ = nullptr, int arg_ = 0)
+            : category (category_)
+            , name     (name_)
+            , argName  (argName_)
+            , arg      (arg_)
+            , active   (getInstance().isRecording())
+            , begin    (active ? now() : 0)
+        {}
+
+        ~ScopedSpan()
+        {
+            if (active)
+            {
+                getInstance().record(category, name, begin, now(), argName, arg);
+            }
+        }
+
+        ScopedSpan(const ScopedSpan&) = delete;
+        ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+    private:
+        const char* category;
+        const char* name;
+        const char* argName;
+        int arg;
+        bool active;
+        uint64_t begin;
+    };
+
+private:
+    struct Span
+    {
+        const char* category;
+        const char* name;
+        const char* argName;
+        uint64_t begin;
+        uint64_t end;
+        int thread;
+        int arg;
+    };
+
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;     // pos while free for the write number pos, pos + 1 once written
+        Span span;
+    };
+
+    TraceRecorder()
+        : slots            (new Slot[CAPACITY])
+        , writeCount       (0)
+        , readCount        (0)
+        , numDropped       (0)
+        , recording        (false)
+        , numUsers         (0)
+        , file             (nullptr)
+        , numWrittenToFile (0)
+        , originTicks      (0)
+        , stopRequested    (false)
+    {
+        for (int i = 0; i < CAPACITY; ++i)
+        {
+            slots[size_t(i)].sequence.store(uint64_t(i), std::memory_order_relaxed);
+        }
+    }
+
+    ~TraceRecorder()
+    {
+        if (numUsers > 0)
+        {
+            numUsers = 1;
+            stop();
+        }
+    }
+
+    /** Small number identifying the calling thread in the trace */
+    static int threadIndex()
+    {
+        static std::atomic<int> numThreads(0);
+        thread_local int index = ++numThreads;
+        return index;
+    }
+
+    /** Drains the ring every DRAIN_INTERVAL until stopped, then once more. */
+    void run()
+    {
+        for (;;)
+        {
+            bool stopping;
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wake.wait_for(lock, DRAIN_INTERVAL, [this] { return stopRequested; });
+                stopping = stopRequested;
+            }
+
+            drain(true);
+
+            if (stopping)
+            {
+                return;
+            }
+        }
+    }
+
+    /** Takes the spans written so far from the ring, writing them to the file if 'write' is true. */
+    void drain(bool write)
+    {
+        // ticks per microsecond, measured over the time since the start
+        double ticksPerUs = 1000.0;
+#if TRACE_RECORDER_TSC
+        if (write)
+        {
+            const uint64_t ticks = now();
+            const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - originTime).count();
+            if (us > 0)
+            {
+                ticksPerUs = double(ticks - originTicks) / us;
+            }
+        }
+#endif
+
+        for (;;)
+        {
+            Slot& slot = slots[size_t(readCount & (CAPACITY - 1))];
+            if (slot.sequence.load(std::memory_order_acquire) != readCount + 1)
+            {
+                break;
+            }
+
+            if (write)
+            {
+                const Span& s = slot.span;
+                std::fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                    s.name, s.category, s.thread,
+                    double(int64_t(s.begin - originTicks)) / ticksPerUs,
+                    double(s.end - s.begin) / ticksPerUs);
+
+                if (s.argName != nullptr)
+                {
+                    std::fprintf(file, ",\"args\":{\"%s\":%d}", s.argName, s.arg);
+                }
+                std::fputs("}", file);
+                ++numWrittenToFile;
+            }
+
+            slot.sequence.store(readCount + CAPACITY, std::memory_order_release);
+            ++readCount;
+        }
+
+        if (write)
+        {
+            std::fflush(file);
+        }
+    }
+
+    static constexpr std::chrono::milliseconds DRAIN_INTERVAL { 100 };
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> writeCount;
+    uint64_t readCount;                 // only used by the draining thread (or with it stopped)
+    std::atomic<uint64_t> numDropped;
+    std::atomic<bool> recording;
+
+    mutable std::mutex controlMutex;    // serializes start() and stop()
+    int numUsers;
+    FILE* file;
+    std::string filePath;
+    uint64_t numWrittenToFile;
+    uint64_t originTicks;
+    std::chrono::steady_clock::time_point originTime;
+
+    std::thread drainThread;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopRequested;
+};
+
+#define CROSSING_TRACE_CONCAT_(a, b) a##b
+#define CROSSING_TRACE_CONCAT(a, b) CROSSING_TRACE_CONCAT_(a, b)
+
+/** Records the time spent in the enclosing scope */
+#define CROSSING_TRACE_SPAN(category, name) \
+    TraceRecorder::ScopedSpan CROSSING_TRACE_CONCAT(traceSpan_, __LINE__) (category, name)
+
+/** Records the time spent in the enclosing scope, with a named integer argument */
+#define CROSSING_TRACE_SPAN_ARG(category, name, argName, arg) \
+    TraceRecorder::ScopedSpan CROSSING_TRACE_CONCAT(traceSpan_, __LINE__) (category, name, argName, int(arg))
+
+#else
+
+#define CROSSING_TRACE_SPAN(category, name)
+#define CROSSING_TRACE_SPAN_ARG(category, name, argName, arg)
+
+#endif // CROSSING_DETECTOR_TRACING
+
+#endif // TRACE_RECORDER_H_INCLUDED
@@ -0,0 +1,392 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+Benchmark suite of the whole detection path: CrossingEngine::process(), as the plugin calls it
+for each buffer of a stream, on synthetic signals.
+
+Starting from a base case (constant threshold, sparse crossings, buffers of 1024 samples, spans
+of 10 samples, 16 channels), one dimension is varied at a time: the buffer size (64 to 16384),
+the spans (0 to 100000), the threshold type with sparse and dense crossings, and the number of
+channels (1 to 384). Sparse crossings are spikes well above the noise, about 20 per second per
+channel; dense ones are noise around the threshold, which crosses it every few samples.
+
+Each case is run a few times (and for at least a quarter of a second) from a fresh start, and
+the fastest run is kept. The results are
+printed as a table and written as CSV (one row per case: time per sample, summed over the
+channels, and events per second of processing). The previous results in that file are moved
+aside and each case is compared with them, so running the suite before and after a change shows
+what it costs.
+*/
+
+#include "EngineBenchmark.h"
+
+#include "CrossingEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const float sampleRate = 30000.0f;
+
+    /** One configuration of the engine and its input */
+    struct Case
+    {
+        ThresholdType thresholdType;
+        bool dense;
+        int bufferSize;
+        int span;
+        int numChannels;
+
+        std::string getName() const
+        {
+            static const char* const typeNames[] = { "constant", "random", "channel", "adaptive", "phase" };
+            char name[96];
+            std::snprintf(name, sizeof(name), "%s/%s/buffer=%d/span=%d/channels=%d", typeNames[thresholdType],
+                dense ? "dense" : "sparse", bufferSize, span, numChannels);
+            return name;
+        }
+    };
+
+    struct Result
+    {
+        double nsPerSample;
+        long long numEvents;
+        double eventsPerSecond;
+    };
+
+    /** Synthetic input of one density. Channels read it from different offsets. */
+    struct Signal
+    {
+        std::vector<float> input;
+        std::vector<float> threshold;   // for CHANNEL thresholds
+        int channelOffset;              // between consecutive channels
+
+        Signal(bool dense, int numSamples) : channelOffset(7919)
+        {
+            const size_t length = size_t(numSamples) + 64 * size_t(channelOffset);
+            input.resize(length);
+            threshold.resize(length);
+
+            std::mt19937 random(12345);
+            std::normal_distribution<float> noise(0.0f, 3.0f);
+            std::exponential_distribution<double> interval(20.0 / sampleRate);
+            const double twoPi = 6.283185307179586;
+
+            double nextSpike = interval(random);
+            for (size_t i = 0; i < length; ++i)
+            {
+                const double t = double(i) / sampleRate;
+                float x = noise(random);
+
+                if (dense)
+                {
+                    threshold[i] = float(std::sin(twoPi * 0.5 * t));
+                }
+                else
+                {
+                    x += float(20.0 * std::sin(twoPi * 8.0 * t));
+                    threshold[i] = float(50.0 + 5.0 * std::sin(twoPi * 0.5 * t));
+
+                    // spikes of 10 samples
+                    if (double(i) >= nextSpike)
+                    {
+                        const double phase = (double(i) - nextSpike) / 10.0;
+                        x += float(150.0 * std::sin(3.141592653589793 * phase));
+                        if (phase >= 1.0)
+                        {
+                            nextSpike = double(i) + interval(random);
+                        }
+                    }
+                }
+                input[i] = x;
+            }
+        }
+    };
+
+    void configure(CrossingEngine& engine, const Case& c)
+    {
+        CrossingEngine::Settings& s = engine.settings;
+        s = CrossingEngine::Settings();
+        s.thresholdType = c.thresholdType;
+        s.posOn = true;
+        s.negOn = c.dense;
+        s.timeout = c.dense ? 0 : 1;
+        s.eventDuration = 1;
+        s.pastSpan = c.span;
+        s.futureSpan = c.span;
+        s.pastStrict = 0.5f;
+        s.futureStrict = 0.5f;
+
+        s.constantThresh = c.dense ? 0.0f : 50.0f;
+        s.randomThreshRange[0] = c.dense ? -1.0f : 45.0f;
+        s.randomThreshRange[1] = c.dense ? 1.0f : 55.0f;
+        s.adaptiveEstimator = AdaptiveThreshold::RMS;
+        s.adaptiveMultiplier = c.dense ? 0.1f : 6.0f;
+        s.phaseTarget = 0.0f;
+        s.phaseFreq = c.dense ? 3000.0f : 8.0f;
+        s.phaseBandwidth = c.dense ? 2000.0f : 4.0f;
+
+        engine.setRandomSeed(1);
+        engine.configure(sampleRate, c.numChannels);
+        engine.start(c.bufferSize);
+    }
+
+    Result run(const Case& c, const Signal& signal, int numSamples, int numRepeats)
+    {
+        CrossingEngine engine;
+        std::vector<const float*> input(size_t(c.numChannels));
+        const float* threshold = signal.threshold.data();
+
+        // short cases are repeated more, so that their best run isn't down to chance
+        const double minTotalSeconds = 0.25;
+        double totalSeconds = 0;
+
+        Result result = { 1e30, 0, 0.0 };
+        for (int r = 0; r < numRepeats || (totalSeconds < minTotalSeconds && r < 1000); ++r)
+        {
+            configure(engine, c);
+            long long numEvents = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+            for (int pos = 0; pos < numSamples; pos += c.bufferSize)
+            {
+                const int count = std::min(c.bufferSize, numSamples - pos);
+                for (int k = 0; k < c.numChannels; ++k)
+                {
+                    input[size_t(k)] = signal.input.data() + pos + (k % 64) * signal.channelOffset;
+                }
+
+                engine.process(input.data(), threshold + pos, count, pos);
+                numEvents += (long long) engine.getEvents().size();
+            }
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            totalSeconds += seconds;
+
+            const double ns = seconds * 1e9 / (double(numSamples) * c.numChannels);
+            if (ns < result.nsPerSample)
+            {
+                result = { ns, numEvents, seconds > 0 ? numEvents / seconds : 0.0 };
+            }
+        }
+        return result;
+    }
+
+    /** The base case and its variations along each dimension, without repeats */
+    std::vector<Case> getCases()
+    {
+        const Case base = { CONSTANT, false, 1024, 10, 16 };
+        std::vector<Case> cases;
+        std::vector<std::string> names;
+
+        auto add = [&](const Case& c)
+        {
+            const std::string name = c.getName();
+            if (std::find(names.begin(), names.end(), name) == names.end())
+            {
+                names.push_back(name);
+                cases.push_back(c);
+            }
+        };
+
+        for (int bufferSize = 64; bufferSize <= 16384; bufferSize *= 2)
+        {
+            Case c = base;
+            c.bufferSize = bufferSize;
+            add(c);
+        }
+        for (int span : { 0, 10, 100, 1000, 10000, 100000 })
+        {
+            Case c = base;
+            c.span = span;
+            add(c);
+        }
+        for (int type = CONSTANT; type < NUM_THRESHOLDS; ++type)
+        {
+            for (bool dense : { false, true })
+            {
+                Case c = base;
+                c.thresholdType = ThresholdType(type);
+                c.dense = dense;
+                add(c);
+            }
+        }
+        for (int numChannels : { 1, 4, 16, 64, 128, 384 })
+        {
+            Case c = base;
+            c.numChannels = numChannels;
+            add(c);
+        }
+        return cases;
+    }
+
+    /** Reads the time per sample of each case from a results file */
+    std::map<std::string, double> readResults(const std::string& path)
+    {
+        std::map<std::string, double> results;
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line); // header
+
+        while (std::getline(in, line))
+        {
+            std::istringstream fields(line);
+            std::string name, value;
+            if (std::getline(fields, name, ',') && std::getline(fields, value, ','))
+            {
+                results[name] = std::atof(value.c_str());
+            }
+        }
+        return results;
+    }
+
+    void printUsage()
+    {
+        std::fprintf(stderr,
+            "usage: crossing-detector-bench suite [options]\n"
+            "\n"
+            "  --seconds <s>          seconds of data per case (default: 10)\n"
+            "  --repeats <n>          minimum runs per case, the fastest is kept (default: 3)\n"
+            "  --filter <text>        only the cases whose name contains the text\n"
+            "  --output <file>        results (default: crossing-detector-bench.csv); the previous\n"
+            "                         results in it are moved to <file>.previous\n"
+            "  --baseline <file>      compare with these results instead of the previous ones\n"
+            "  --max-slowdown <%%>     exit with 1 if a case got slower than this\n");
+    }
+}
+
+int runEngineBenchmark(int argc, char* argv[])
+{
+    double seconds = 10.0;
+    int numRepeats = 3;
+    std::string filter;
+    std::string outputPath = "crossing-detector-bench.csv";
+    std::string baselinePath;
+    double maxSlowdown = -1;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+        {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc)
+        {
+            std::fprintf(stderr, "missing value for %s\n", arg);
+            return 2;
+        }
+
+        const char* value = argv[++i];
+        if (std::strcmp(arg, "--seconds") == 0) seconds = std::atof(value);
+        else if (std::strcmp(arg, "--repeats") == 0) numRepeats = std::max(1, std::atoi(value));
+        else if (std::strcmp(arg, "--filter") == 0) filter = value;
+        else if (std::strcmp(arg, "--output") == 0) outputPath = value;
+        else if (std::strcmp(arg, "--baseline") == 0) baselinePath = value;
+        else if (std::strcmp(arg, "--max-slowdown") == 0) maxSlowdown = std::atof(value);
+        else
+        {
+            std::fprintf(stderr, "unexpected argument: %s\n\n", arg);
+            printUsage();
+            return 2;
+        }
+    }
+
+    const int numSamples = int(seconds * sampleRate);
+    if (numSamples <= 0)
+    {
+        printUsage();
+        return 2;
+    }
+
+    // keep the last results for comparison
+    const std::string previousPath = outputPath + ".previous";
+    if (std::ifstream(outputPath).good())
+    {
+        std::remove(previousPath.c_str());
+        std::rename(outputPath.c_str(), previousPath.c_str());
+    }
+    const std::map<std::string, double> baseline = readResults(baselinePath.empty() ? previousPath : baselinePath);
+
+    FILE* csv = std::fopen(outputPath.c_str(), "w");
+    if (csv == nullptr)
+    {
+        std::fprintf(stderr, "can't create %s\n", outputPath.c_str());
+        return 1;
+    }
+    std::fprintf(csv, "case,ns_per_sample,events,events_per_sec,threshold,density,buffer,span,channels\n");
+
+    std::printf("%.1f s of data per case at %.0f Hz, best of at least %d runs%s\n\n", seconds, sampleRate, numRepeats,
+        CrossingScan::hasAvx2() ? ", AVX2" : "");
+    std::printf("%-52s %10s %10s %12s %10s %8s\n", "case", "ns/sample", "events", "events/s", "previous", "change");
+
+    const Signal signals[] = { Signal(false, numSamples), Signal(true, numSamples) };
+    int numSlower = 0;
+
+    for (const Case& c : getCases())
+    {
+        const std::string name = c.getName();
+        if (name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        const Result result = run(c, signals[c.dense ? 1 : 0], numSamples, numRepeats);
+
+        std::fprintf(csv, "%s,%.4f,%lld,%.1f,%d,%s,%d,%d,%d\n", name.c_str(), result.nsPerSample, result.numEvents,
+            result.eventsPerSecond, int(c.thresholdType), c.dense ? "dense" : "sparse", c.bufferSize, c.span, c.numChannels);
+        std::fflush(csv);
+
+        std::printf("%-52s %10.3f %10lld %12.0f", name.c_str(), result.nsPerSample, result.numEvents, result.eventsPerSecond);
+
+        const auto previous = baseline.find(name);
+        if (previous != baseline.end() && previous->second > 0)
+        {
+            const double change = 100.0 * (result.nsPerSample / previous->second - 1.0);
+            const bool slower = maxSlowdown >= 0 && change > maxSlowdown;
+            numSlower += slower ? 1 : 0;
+            std::printf(" %10.3f %+7.1f%%%s", previous->second, change, slower ? "  SLOWER" : "");
+        }
+        std::printf("\n");
+    }
+
+    if (std::fclose(csv) != 0)
+    {
+        std::fprintf(stderr, "could not write %s\n", outputPath.c_str());
+        return 1;
+    }
+    std::printf("\nresults written to %s\n", outputPath.c_str());
+    return numSlower == 0 ? 0 : 1;
+}
@@ -0,0 +1,32 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ENGINE_BENCHMARK_H_INCLUDED
+#define ENGINE_BENCHMARK_H_INCLUDED
+
+/** Runs the benchmark suite of the whole detection path (crossing-detector-bench suite ...),
+ *  with the arguments following "suite". Returns the exit code.
+ */
+int runEngineBenchmark(int argc, char* argv[]);
+
+#endif // ENGINE_BENCHMARK_H_INCLUDED
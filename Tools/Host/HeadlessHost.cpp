@@ -0,0 +1,240 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "HeadlessHost.h"
+
+/** Beginning of the chain: creates the streams and stamps each block with its sample numbers,
+ *  as the GUI's source nodes do. The samples themselves are written into the buffer by the caller.
+ */
+class HeadlessHost::Source : public GenericProcessor
+{
+public:
+    struct StreamSpec
+    {
+        String name;
+        float sampleRate;
+        int numChannels;
+    };
+
+    Source() : GenericProcessor("Headless host source")
+    {
+        setProcessorType(Plugin::Processor::SOURCE);
+    }
+
+    void updateSettings() override
+    {
+        for (const StreamSpec& spec : specs)
+        {
+            DataStream::Settings streamSettings{
+                spec.name,
+                "Stream of the headless host",
+                "headless-host." + spec.name,
+                spec.sampleRate
+            };
+            DataStream* stream = new DataStream(streamSettings);
+            dataStreams.add(stream);
+
+            for (int c = 0; c < spec.numChannels; ++c)
+            {
+                // samples are in microvolts already
+                ContinuousChannel::Settings channelSettings{
+                    ContinuousChannel::Type::ELECTRODE,
+                    "CH" + String(c + 1),
+                    "Channel of the headless host",
+                    "headless-host.continuous",
+                    1.0f,
+                    stream
+                };
+                continuousChannels.add(new ContinuousChannel(channelSettings));
+            }
+        }
+
+        blockSizes.resize(specs.size());
+        nextSampleNumbers.resize(specs.size());
+    }
+
+    void process(AudioBuffer<float>&) override
+    {
+        for (int s = 0; s < dataStreams.size(); ++s)
+        {
+            const juce::int64 first = nextSampleNumbers[s];
+            setTimestampAndSamples(first, double(first) / dataStreams[s]->getSampleRate(),
+                juce::uint32(blockSizes[s]), dataStreams[s]->getStreamId());
+            nextSampleNumbers.set(s, first + blockSizes[s]);
+        }
+    }
+
+    bool startAcquisition() override
+    {
+        nextSampleNumbers.fill(0);
+        return true;
+    }
+
+    Array<StreamSpec> specs;
+    Array<int> blockSizes;
+    Array<juce::int64> nextSampleNumbers;
+};
+
+/** End of the chain: records the TTL events that reach it, as a downstream processor sees them */
+class HeadlessHost::Sink : public GenericProcessor
+{
+public:
+    Sink() : GenericProcessor("Headless host sink")
+    {
+        setProcessorType(Plugin::Processor::SINK);
+    }
+
+    void process(AudioBuffer<float>&) override
+    {
+        checkForEvents();
+    }
+
+    void handleTTLEvent(TTLEventPtr event) override
+    {
+        events.add({ event->getStreamId(), int(event->getLine()), event->getState(), event->getSampleNumber() });
+    }
+
+    Array<HostEvent> events;
+};
+
+HeadlessHost::HeadlessHost()
+    : source(std::make_unique<Source>())
+    , sink(std::make_unique<Sink>())
+{
+    sink->setSourceNode(source.get());
+    source->setDestNode(sink.get());
+}
+
+HeadlessHost::~HeadlessHost() {}
+
+void HeadlessHost::addStream(const String& name, float sampleRate, int numChannels)
+{
+    source->specs.add({ name, sampleRate, numChannels });
+}
+
+void HeadlessHost::setProcessor(std::unique_ptr<GenericProcessor> newProcessor)
+{
+    processor = std::move(newProcessor);
+
+    GenericProcessor* upstream = source.get();
+    if (processor != nullptr)
+    {
+        processor->setSourceNode(source.get());
+        source->setDestNode(processor.get());
+        upstream = processor.get();
+    }
+    sink->setSourceNode(upstream);
+    upstream->setDestNode(sink.get());
+}
+
+void HeadlessHost::update()
+{
+    source->update();
+    if (processor != nullptr)
+    {
+        processor->update();
+    }
+    sink->update();
+}
+
+int HeadlessHost::getNumStreams() const
+{
+    return source->getDataStreams().size();
+}
+
+juce::uint16 HeadlessHost::getStreamId(int streamIndex) const
+{
+    return source->getDataStreams()[streamIndex]->getStreamId();
+}
+
+bool HeadlessHost::setParameter(int streamIndex, const String& name, const var& value)
+{
+    if (processor == nullptr || streamIndex < 0 || streamIndex >= getNumStreams())
+    {
+        return false;
+    }
+
+    DataStream* stream = processor->getDataStream(getStreamId(streamIndex));
+    Parameter* param = stream != nullptr ? stream->getParameter(name) : nullptr;
+    if (param == nullptr)
+    {
+        return false;
+    }
+
+    param->setNextValue(value);
+    return true;
+}
+
+bool HeadlessHost::startAcquisition()
+{
+    clearEvents();
+
+    bool started = source->startAcquisition();
+    if (processor != nullptr)
+    {
+        started = processor->startAcquisition() && started;
+    }
+    return sink->startAcquisition() && started;
+}
+
+void HeadlessHost::stopAcquisition()
+{
+    source->stopAcquisition();
+    if (processor != nullptr)
+    {
+        processor->stopAcquisition();
+    }
+    sink->stopAcquisition();
+}
+
+void HeadlessHost::processBlock(AudioBuffer<float>& buffer, const Array<int>& numSamples)
+{
+    for (int s = 0; s < source->blockSizes.size(); ++s)
+    {
+        source->blockSizes.set(s, jmin(numSamples[s], buffer.getNumSamples()));
+    }
+
+    // one event buffer travels down the chain, carrying the block's sample numbers and the events
+    eventBuffer.clear();
+    source->processBlock(buffer, eventBuffer);
+    if (processor != nullptr)
+    {
+        processor->processBlock(buffer, eventBuffer);
+    }
+    sink->processBlock(buffer, eventBuffer);
+}
+
+juce::int64 HeadlessHost::getNextSampleNumber(int streamIndex) const
+{
+    return source->nextSampleNumbers[streamIndex];
+}
+
+const Array<HostEvent>& HeadlessHost::getEvents() const
+{
+    return sink->events;
+}
+
+void HeadlessHost::clearEvents()
+{
+    sink->events.clearQuick();
+}
@@ -0,0 +1,108 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef HEADLESS_HOST_H_INCLUDED
+#define HEADLESS_HOST_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+
+/*
+A stand-in for the GUI's processor graph, to run a processor (such as the CrossingDetector)
+without the GUI window, e.g. on a build machine with no display.
+
+The host is a signal chain of three processors: a source that has the streams given to
+addStream() and stamps each block with its sample numbers, the processor under test, and a sink
+that records the TTL events reaching it. Like the GUI, update() propagates the streams down the
+chain (calling the processor's updateSettings()), parameters are set through the processor's
+Parameter objects (calling parameterValueChanged()), and each block goes through processBlock()
+of the three processors with one event buffer, as the graph does. Processors run without an
+editor.
+
+Everything runs on the calling thread; a parameter set between two blocks takes effect from the
+second one.
+*/
+
+/** A TTL event that reached the end of the chain */
+struct HostEvent
+{
+    juce::uint16 streamId;
+    int line;
+    bool state;
+    juce::int64 sampleNumber;
+};
+
+class HeadlessHost
+{
+public:
+    HeadlessHost();
+    ~HeadlessHost();
+
+    /** Adds a stream of continuous channels to the source; call update() afterwards. */
+    void addStream(const String& name, float sampleRate, int numChannels);
+
+    /** Connects the processor under test between the source and the sink; call update() afterwards. */
+    void setProcessor(std::unique_ptr<GenericProcessor> processor);
+
+    GenericProcessor* getProcessor() const { return processor.get(); }
+
+    /** Propagates the streams down the chain, as the GUI does when the signal chain changes. */
+    void update();
+
+    int getNumStreams() const;
+
+    /** ID of a stream of the source, in the order they were added */
+    juce::uint16 getStreamId(int streamIndex) const;
+
+    /** Sets a stream-scoped parameter of the processor. Returns false if there is no such parameter. */
+    bool setParameter(int streamIndex, const String& name, const var& value);
+
+    /** Starts and stops acquisition of all processors in the chain */
+    bool startAcquisition();
+    void stopAcquisition();
+
+    /** Processes one block, of numSamples[s] samples of stream s (at most the buffer's length).
+     *  The buffer has the channels of all streams, one stream after the other.
+     */
+    void processBlock(AudioBuffer<float>& buffer, const Array<int>& numSamples);
+
+    /** Sample number of the next block of a stream */
+    juce::int64 getNextSampleNumber(int streamIndex) const;
+
+    /** Events that reached the sink since the last call to clearEvents() */
+    const Array<HostEvent>& getEvents() const;
+    void clearEvents();
+
+private:
+    class Source;
+    class Sink;
+
+    std::unique_ptr<Source> source;
+    std::unique_ptr<GenericProcessor> processor;
+    std::unique_ptr<Sink> sink;
+
+    MidiBuffer eventBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE(HeadlessHost);
+};
+
+#endif // HEADLESS_HOST_H_INCLUDED
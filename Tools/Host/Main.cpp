@@ -0,0 +1,376 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+crossing-detector-host: runs the CrossingDetector processor in a HeadlessHost, end to end, on
+synthetic signals: noise with spikes (about 20 per second per channel, going down to -100 µV)
+on every channel of every stream.
+
+Blocks go through the processor as in the GUI, with parameters set before acquisition and
+changed between blocks. It prints the TTL events that came out of each stream and the time
+spent per block, and optionally writes the events as CSV, e.g. to compare them with those of
+crossing-detector-tool on the same data, or between two builds.
+*/
+
+#include "HeadlessHost.h"
+#include "CrossingDetector.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    struct ParameterChange
+    {
+        juce::int64 sampleNumber; // applied before the first block that starts at or after it
+        String name;
+        var value;
+    };
+
+    /** Turns a command-line value into the type of a parameter: true/false, a number, or for
+     *  "Channel" a list of channels from 1 (selected channels parameters are lists from 0).
+     */
+    var parseValue(const String& name, const String& text)
+    {
+        if (name.equalsIgnoreCase("Channel"))
+        {
+            Array<var> channels;
+            for (const String& channel : StringArray::fromTokens(text, ",", ""))
+            {
+                channels.add(channel.getIntValue() - 1);
+            }
+            return channels;
+        }
+        if (text.equalsIgnoreCase("true") || text.equalsIgnoreCase("false"))
+        {
+            return text.equalsIgnoreCase("true");
+        }
+        if (text.containsAnyOf(".eE"))
+        {
+            return text.getDoubleValue();
+        }
+        return text.getIntValue();
+    }
+
+    bool parseAssignment(const String& text, String& name, var& value)
+    {
+        if (!text.contains("="))
+        {
+            return false;
+        }
+        name = text.upToFirstOccurrenceOf("=", false, false).trim();
+        value = parseValue(name, text.fromFirstOccurrenceOf("=", false, false).trim());
+        return name.isNotEmpty();
+    }
+
+    /** Noise with spikes, per channel */
+    class SpikeSignal
+    {
+    public:
+        SpikeSignal(int numChannels, float sampleRate, unsigned seed)
+            : random(seed)
+            , noise(0.0f, 10.0f)
+            , interval(20.0 / sampleRate)
+            , untilSpike(size_t(numChannels))
+        {
+            for (double& wait : untilSpike)
+            {
+                wait = interval(random);
+            }
+        }
+
+        void fill(float* const* channels, int numChannels, int numSamples)
+        {
+            for (int c = 0; c < numChannels; ++c)
+            {
+                float* samples = channels[c];
+                double& wait = untilSpike[size_t(c)];
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    samples[i] = noise(random);
+                    if (--wait < 0.0)
+                    {
+                        samples[i] -= 100.0f;
+                        wait = interval(random);
+                    }
+                }
+            }
+        }
+
+    private:
+        std::mt19937 random;
+        std::normal_distribution<float> noise;
+        std::exponential_distribution<double> interval;
+        std::vector<double> untilSpike;
+    };
+
+    void printUsage()
+    {
+        std::fprintf(stderr,
+            "usage: crossing-detector-host [options]\n"
+            "\n"
+            "Runs the Crossing Detector processor without the GUI on noise with spikes, in blocks as the\n"
+            "GUI does, and reports its events and the time spent per block.\n"
+            "\n"
+            "  --streams <n>                  number of streams (default: 1)\n"
+            "  --channels <n>                 channels per stream, all monitored (default: 16)\n"
+            "  --rate <Hz>                    sample rate (default: 30000)\n"
+            "  --buffer <n>[:<max>]           block size, or a range of random sizes (default: 1024)\n"
+            "  --seconds <s>                  length of the signal (default: 10)\n"
+            "  --seed <n>                     seed of the signal and the block sizes (default: 1)\n"
+            "  --set <name=value>             parameter of all streams before acquisition (repeatable)\n"
+            "  --change <sample:name=value>   parameter change from a sample number on (repeatable)\n"
+            "  --csv <file>                   write the events (stream, line, state, sample number)\n"
+            "\n"
+            "Parameters are the processor's, e.g. --set past_span=10 --change 150000:constant_threshold=-70.\n"
+            "By default the threshold is -50 and only falling crossings are detected.\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // parameters and processors may post to the message thread
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    int numStreams = 1;
+    int numChannels = 16;
+    float sampleRate = 30000.0f;
+    int minBuffer = 1024;
+    int maxBuffer = 1024;
+    double seconds = 10.0;
+    unsigned seed = 1;
+    Array<std::pair<String, var>> settings;
+    Array<ParameterChange> changes;
+    String csvPath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const String arg(argv[i]);
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc)
+        {
+            std::fprintf(stderr, "missing value for %s\n\n", argv[i]);
+            printUsage();
+            return 2;
+        }
+
+        const String value(argv[++i]);
+        if (arg == "--streams") numStreams = jmax(1, value.getIntValue());
+        else if (arg == "--channels") numChannels = jmax(1, value.getIntValue());
+        else if (arg == "--rate") sampleRate = value.getFloatValue();
+        else if (arg == "--seconds") seconds = value.getDoubleValue();
+        else if (arg == "--seed") seed = unsigned(value.getLargeIntValue());
+        else if (arg == "--csv") csvPath = value;
+        else if (arg == "--buffer")
+        {
+            minBuffer = jmax(1, value.upToFirstOccurrenceOf(":", false, false).getIntValue());
+            maxBuffer = value.contains(":") ? jmax(minBuffer, value.fromFirstOccurrenceOf(":", false, false).getIntValue())
+                                            : minBuffer;
+        }
+        else if (arg == "--set" || arg == "--change")
+        {
+            String assignment = value;
+            ParameterChange change{ 0, {}, {} };
+            if (arg == "--change")
+            {
+                change.sampleNumber = value.upToFirstOccurrenceOf(":", false, false).getLargeIntValue();
+                assignment = value.fromFirstOccurrenceOf(":", false, false);
+            }
+            if (!parseAssignment(assignment, change.name, change.value))
+            {
+                std::fprintf(stderr, "expected name=value: %s\n", value.toRawUTF8());
+                return 2;
+            }
+            if (arg == "--set")
+            {
+                settings.add({ change.name, change.value });
+            }
+            else
+            {
+                changes.add(change);
+            }
+        }
+        else
+        {
+            std::fprintf(stderr, "unexpected argument: %s\n\n", argv[i - 1]);
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (sampleRate <= 0.0f || seconds <= 0.0)
+    {
+        std::fprintf(stderr, "the sample rate and the length must be positive\n");
+        return 2;
+    }
+
+    std::stable_sort(changes.begin(), changes.end(),
+        [](const ParameterChange& a, const ParameterChange& b) { return a.sampleNumber < b.sampleNumber; });
+
+    HeadlessHost host;
+    for (int s = 0; s < numStreams; ++s)
+    {
+        host.addStream("stream" + String(s + 1), sampleRate, numChannels);
+    }
+    host.setProcessor(std::make_unique<CrossingDetector>());
+    host.update();
+
+    // defaults that detect the spikes on all channels, then the given settings
+    Array<var> allChannels;
+    for (int c = 0; c < jmin(numChannels, 64); ++c)
+    {
+        allChannels.add(c);
+    }
+    for (int s = 0; s < numStreams; ++s)
+    {
+        host.setParameter(s, "Channel", allChannels);
+        host.setParameter(s, "constant_threshold", -50.0);
+        host.setParameter(s, "Rising", false);
+        host.setParameter(s, "Falling", true);
+
+        for (const auto& setting : settings)
+        {
+            if (!host.setParameter(s, setting.first, setting.second))
+            {
+                std::fprintf(stderr, "unknown parameter: %s\n", setting.first.toRawUTF8());
+                return 2;
+            }
+        }
+    }
+
+    if (!host.startAcquisition())
+    {
+        std::fprintf(stderr, "the processor did not start acquisition\n");
+        return 1;
+    }
+
+    AudioBuffer<float> buffer(numStreams * numChannels, maxBuffer);
+    std::vector<SpikeSignal> signals;
+    for (int s = 0; s < numStreams; ++s)
+    {
+        signals.emplace_back(numChannels, sampleRate, seed + unsigned(s));
+    }
+    std::mt19937 blockRandom(seed);
+    std::uniform_int_distribution<int> blockSizes(minBuffer, maxBuffer);
+
+    const juce::int64 totalSamples = juce::int64(seconds * sampleRate);
+    std::vector<double> blockMicroseconds;
+    Array<HostEvent> events;
+    int nextChange = 0;
+
+    while (host.getNextSampleNumber(0) < totalSamples)
+    {
+        const juce::int64 position = host.getNextSampleNumber(0);
+        for (; nextChange < changes.size() && changes[nextChange].sampleNumber <= position; ++nextChange)
+        {
+            for (int s = 0; s < numStreams; ++s)
+            {
+                if (!host.setParameter(s, changes[nextChange].name, changes[nextChange].value))
+                {
+                    std::fprintf(stderr, "unknown parameter: %s\n", changes[nextChange].name.toRawUTF8());
+                    return 2;
+                }
+            }
+        }
+
+        const int numSamples = int(jmin(juce::int64(blockSizes(blockRandom)), totalSamples - position));
+        for (int s = 0; s < numStreams; ++s)
+        {
+            signals[size_t(s)].fill(buffer.getArrayOfWritePointers() + s * numChannels, numChannels, numSamples);
+        }
+
+        Array<int> numSamplesPerStream;
+        numSamplesPerStream.insertMultiple(0, numSamples, numStreams);
+
+        const juce::int64 start = Time::getHighResolutionTicks();
+        host.processBlock(buffer, numSamplesPerStream);
+        blockMicroseconds.push_back(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start) * 1e6);
+
+        events.addArray(host.getEvents());
+        host.clearEvents();
+    }
+
+    host.stopAcquisition();
+
+    // events per stream
+    std::printf("%d stream(s) of %d channels at %g Hz, %g s in blocks of %d", numStreams, numChannels,
+        double(sampleRate), seconds, minBuffer);
+    if (maxBuffer > minBuffer)
+    {
+        std::printf(" to %d", maxBuffer);
+    }
+    std::printf(" samples\n\n");
+
+    for (int s = 0; s < numStreams; ++s)
+    {
+        int on = 0;
+        int off = 0;
+        for (const HostEvent& event : events)
+        {
+            if (event.streamId == host.getStreamId(s))
+            {
+                (event.state ? on : off)++;
+            }
+        }
+        std::printf("stream%d: %d events on, %d off\n", s + 1, on, off);
+    }
+
+    // time per block
+    std::vector<double> sorted = blockMicroseconds;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0;
+    for (double us : sorted)
+    {
+        total += us;
+    }
+    auto percentile = [&sorted](double p) { return sorted[std::min(sorted.size() - 1, size_t(p * double(sorted.size())))]; };
+
+    std::printf("\n%zu blocks: median %.1f us, 99th percentile %.1f us, max %.1f us per block\n",
+        sorted.size(), percentile(0.5), percentile(0.99), sorted.back());
+    std::printf("%.1f ns per sample (summed over all channels), %.0fx real time\n",
+        total * 1e3 / (double(totalSamples) * numStreams * numChannels), seconds * 1e6 / total);
+
+    if (csvPath.isNotEmpty())
+    {
+        std::ofstream out(csvPath.toStdString());
+        out << "stream,line,state,sample_number\n";
+        for (const HostEvent& event : events)
+        {
+            out << event.streamId << "," << event.line << "," << (event.state ? 1 : 0) << "," << event.sampleNumber << "\n";
+        }
+        if (!out.good())
+        {
+            std::fprintf(stderr, "can't write %s\n", csvPath.toRawUTF8());
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,410 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+Benchmark for the detection kernels in CrossingKernel.h.
+
+For each combination of threshold type, directions, voting and jump limit, a synthetic
+recording is processed buffer by buffer twice: once with a per-sample loop that tests the
+configuration at every sample (the way CrossingDetector::process used to work), and once with
+the specialized kernel selected by CrossingKernel::detectCrossings. Both must produce the same
+number of events; the time per sample of each and the speedup are printed.
+
+Usage: crossing-detector-bench [seconds of data = 20] [buffer size = 1024]
+
+The benchmark suite of the whole detection path runs with "crossing-detector-bench suite"
+(see EngineBenchmark.cpp).
+*/
+
+#include "BitHistory.h"
+#include "CrossingKernel.h"
+#include "EngineBenchmark.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    const float sampleRate = 30000.0f;
+    const int numRepeats = 5;
+
+    /** Small deterministic generator, so both implementations draw the same random thresholds */
+    struct Lcg
+    {
+        uint32_t state = 12345;
+
+        float nextFloat() // in [0, 1)
+        {
+            state = state * 1664525u + 1013904223u;
+            return float(state >> 8) / float(1 << 24);
+        }
+
+        float nextGaussian()
+        {
+            float u1 = nextFloat() + 1e-7f;
+            float u2 = nextFloat();
+            return std::sqrt(-2.0f * std::log(u1)) * std::cos(6.2831853f * u2);
+        }
+    };
+
+    /** Whole recording, preceded by a zeroed region that plays the role of the reset history */
+    struct Recording
+    {
+        int prefix;
+        std::vector<float> input;
+        std::vector<float> channelThreshold;
+    };
+
+    Recording makeRecording(int numSamples, int prefix)
+    {
+        Recording rec;
+        rec.prefix = prefix;
+        rec.input.assign(size_t(prefix + numSamples), 0.0f);
+        rec.channelThreshold.assign(size_t(prefix + numSamples), 0.0f);
+
+        Lcg rng;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float t = i / sampleRate;
+            rec.input[size_t(prefix + i)] = 100.0f * std::sin(6.2831853f * 8.0f * t) + 3.0f * rng.nextGaussian();
+            rec.channelThreshold[size_t(prefix + i)] = 20.0f * std::sin(6.2831853f * 0.5f * t);
+        }
+        return rec;
+    }
+
+    /** The configuration as seen by the old per-sample loop */
+    struct Settings
+    {
+        ThresholdType thresholdType;
+        bool posOn;
+        bool negOn;
+        int pastSpan;
+        int futureSpan;
+        float pastStrict;
+        float futureStrict;
+        bool useJumpLimit;
+        float jumpLimit;
+        float jumpLimitSleep;
+        int timeoutSamp;
+        float constantThresh;
+        float randomMin;
+        float randomMax;
+    };
+
+    /** Per-sample loop with runtime configuration checks, on contiguous history */
+    long long runReference(const Recording& rec, const Settings& s, int bufferSize)
+    {
+        std::vector<float> thresholds(rec.input.size(), 0.0f);
+        Lcg rng;
+        float currRandomThresh = s.randomMin + (s.randomMax - s.randomMin) * rng.nextFloat();
+        const float jumpLimitSleepSamp = s.jumpLimitSleep * sampleRate;
+
+        int sampToReenable = s.pastSpan + 1;
+        int jumpLimitElapsed = int(jumpLimitSleepSamp);
+        int pastSamplesAbove = 0;
+        int futureSamplesAbove = 0;
+        long long numEvents = 0;
+
+        auto shouldTrigger = [&](bool direction, float preVal, float postVal, float preThresh, float postThresh)
+        {
+            if (s.useJumpLimit && std::abs(postVal - preVal) >= s.jumpLimit)
+            {
+                jumpLimitElapsed = 0;
+                return false;
+            }
+
+            if (jumpLimitElapsed < jumpLimitSleepSamp)
+            {
+                jumpLimitElapsed++;
+                return false;
+            }
+
+            int pastSamplesNeeded = CrossingKernel::samplesNeeded(s.pastSpan, s.pastStrict);
+            int futureSamplesNeeded = CrossingKernel::samplesNeeded(s.futureSpan, s.futureStrict);
+
+            bool preSat = direction != (preVal > preThresh);
+            bool postSat = direction == (postVal > postThresh);
+            bool pastSat = (direction ? s.pastSpan - pastSamplesAbove : pastSamplesAbove) >= pastSamplesNeeded;
+            bool futureSat = (direction ? futureSamplesAbove : s.futureSpan - futureSamplesAbove) >= futureSamplesNeeded;
+
+            return preSat && postSat && pastSat && futureSat;
+        };
+
+        for (size_t start = size_t(rec.prefix); start < rec.input.size(); start += size_t(bufferSize))
+        {
+            int nSamples = int(std::min(size_t(bufferSize), rec.input.size() - start));
+            const float* x = rec.input.data() + start;
+            float* t = thresholds.data() + start;
+            const float* channel = rec.channelThreshold.data() + start;
+
+            for (int i = 0; i < nSamples; ++i)
+            {
+                switch (s.thresholdType)
+                {
+                case CONSTANT:
+                    t[i] = s.constantThresh;
+                    break;
+                case RANDOM:
+                    t[i] = currRandomThresh;
+                    break;
+                default:
+                    t[i] = channel[i];
+                    break;
+                }
+
+                int indCross = i - s.futureSpan;
+
+                if (s.pastSpan > 0)
+                {
+                    int indLeaving = indCross - 2 - s.pastSpan;
+                    pastSamplesAbove -= x[indLeaving] > t[indLeaving] ? 1 : 0;
+                    int indEntering = indCross - 2;
+                    pastSamplesAbove += x[indEntering] > t[indEntering] ? 1 : 0;
+                }
+
+                if (s.futureSpan > 0)
+                {
+                    futureSamplesAbove -= x[indCross] > t[indCross] ? 1 : 0;
+                    futureSamplesAbove += x[i] > t[i] ? 1 : 0;
+                }
+
+                if (indCross < sampToReenable)
+                    continue;
+
+                float preVal = x[indCross - 1];
+                float preThresh = t[indCross - 1];
+                float postVal = x[indCross];
+                float postThresh = t[indCross];
+
+                if ((s.posOn && shouldTrigger(true, preVal, postVal, preThresh, postThresh)) ||
+                    (s.negOn && shouldTrigger(false, preVal, postVal, preThresh, postThresh)))
+                {
+                    ++numEvents;
+                    sampToReenable = indCross + 1 + s.timeoutSamp;
+
+                    if (s.thresholdType == RANDOM)
+                    {
+                        currRandomThresh = s.randomMin + (s.randomMax - s.randomMin) * rng.nextFloat();
+                    }
+                }
+            }
+
+            sampToReenable = std::max(-s.futureSpan, sampToReenable - nSamples);
+        }
+
+        return numEvents;
+    }
+
+    /** Kernel host on contiguous history, mirroring the plugin's host */
+    struct BenchHost
+    {
+        const float* x;
+        float* t;
+        BitHistory* aboveHistory;
+        int64_t bufferPos;
+        int nSamples;
+        const Settings* settings;
+        Lcg* rng;
+        float* currRandomThresh;
+        long long numEvents;
+
+        int countAbove(int from, int to)
+        {
+            return aboveHistory->count(bufferPos + from, bufferPos + to);
+        }
+
+        void trigger(int, int decisionInd, float, float, float)
+        {
+            ++numEvents;
+
+            if (settings->thresholdType == RANDOM)
+            {
+                *currRandomThresh = settings->randomMin
+                    + (settings->randomMax - settings->randomMin) * rng->nextFloat();
+
+                int firstNewSample = decisionInd + 1;
+                if (firstNewSample < nSamples)
+                {
+                    std::fill(t + firstNewSample, t + nSamples, *currRandomThresh);
+                    aboveHistory->assign(bufferPos + firstNewSample, x + firstNewSample,
+                        t + firstNewSample, nSamples - firstNewSample);
+                }
+            }
+        }
+    };
+
+    long long runKernel(const Recording& rec, const Settings& s, int bufferSize)
+    {
+        std::vector<float> thresholds(rec.input.size(), 0.0f);
+        Lcg rng;
+        float currRandomThresh = s.randomMin + (s.randomMax - s.randomMin) * rng.nextFloat();
+        BitHistory aboveHistory(s.pastSpan + s.futureSpan + 2);
+
+        CrossingKernel::Config config;
+        config.thresholdType = s.thresholdType;
+        config.directions = (s.posOn ? CrossingScan::RISING : 0) | (s.negOn ? CrossingScan::FALLING : 0);
+        config.pastSpan = s.pastSpan;
+        config.futureSpan = s.futureSpan;
+        config.pastSamplesNeeded = CrossingKernel::samplesNeeded(s.pastSpan, s.pastStrict);
+        config.futureSamplesNeeded = CrossingKernel::samplesNeeded(s.futureSpan, s.futureStrict);
+        config.useJumpLimit = s.useJumpLimit;
+        config.jumpLimit = s.jumpLimit;
+        config.jumpLimitSleepSamp = s.jumpLimitSleep * sampleRate;
+        config.timeoutSamp = s.timeoutSamp;
+        config.constantThresh = s.constantThresh;
+        config.earlyDecision = false;
+        config.useHysteresis = false;
+        config.hysteresis = 0.0f;
+        config.interpolation = CrossingKernel::LINEAR;
+
+        CrossingKernel::State state{ s.pastSpan + 1, int(config.jumpLimitSleepSamp), -s.futureSpan, 0, 0, 0 };
+        long long numEvents = 0;
+
+        for (size_t start = size_t(rec.prefix); start < rec.input.size(); start += size_t(bufferSize))
+        {
+            int nSamples = int(std::min(size_t(bufferSize), rec.input.size() - start));
+            const float* x = rec.input.data() + start;
+            float* t = thresholds.data() + start;
+
+            switch (s.thresholdType)
+            {
+            case CONSTANT:
+                std::fill(t, t + nSamples, s.constantThresh);
+                break;
+            case RANDOM:
+                std::fill(t, t + nSamples, currRandomThresh);
+                break;
+            default:
+                std::copy(rec.channelThreshold.data() + start, rec.channelThreshold.data() + start + nSamples, t);
+                break;
+            }
+
+            BenchHost host{ x, t, &aboveHistory, aboveHistory.append(x, t, nSamples), nSamples,
+                &s, &rng, &currRandomThresh, 0 };
+
+            CrossingKernel::Buffer buffer{ x, t, nSamples, -s.futureSpan };
+            CrossingKernel::detectCrossings(host, config, state, buffer);
+
+            numEvents += host.numEvents;
+            state.sampToReenable = std::max(-s.futureSpan, state.sampToReenable - nSamples);
+            state.nextIndex = std::max(-s.futureSpan, state.nextIndex - nSamples);
+        }
+
+        return numEvents;
+    }
+
+    template <typename Function>
+    double bestNsPerSample(Function run, int numSamples, long long& numEvents)
+    {
+        double best = 1e30;
+        for (int r = 0; r < numRepeats; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            numEvents = run();
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count() / numSamples);
+        }
+        return best;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && std::strcmp(argv[1], "suite") == 0)
+    {
+        return runEngineBenchmark(argc - 2, argv + 2);
+    }
+
+    double seconds = argc > 1 ? std::atof(argv[1]) : 20.0;
+    int bufferSize = argc > 2 ? std::atoi(argv[2]) : 1024;
+    if (seconds <= 0 || bufferSize <= 0)
+    {
+        std::fprintf(stderr, "usage: %s [seconds] [buffer size]\n       %s suite [options]\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    const int numSamples = int(seconds * sampleRate);
+    const int span = 30;
+    const Recording rec = makeRecording(numSamples, 2 * span + 2);
+
+    const char* typeNames[] = { "constant", "random", "channel" };
+    const char* dirNames[] = { "", "rising", "falling", "both" };
+
+    std::printf("%d samples at %.0f Hz, buffers of %d samples%s\n\n", numSamples, sampleRate, bufferSize,
+        CrossingScan::hasAvx2() ? ", AVX2" : "");
+    std::printf("%-10s %-8s %-7s %-5s %12s %12s %8s %8s\n",
+        "threshold", "dirs", "voting", "jump", "loop ns/smp", "kernel ns/smp", "speedup", "events");
+
+    int numMismatches = 0;
+
+    // adaptive thresholds reach the kernel as a per-sample array, like channel thresholds
+    for (int type = CONSTANT; type <= CHANNEL; ++type)
+    {
+        for (int dirs = CrossingScan::RISING; dirs <= CrossingScan::BOTH; ++dirs)
+        {
+            for (int voting = 0; voting < 2; ++voting)
+            {
+                for (int jump = 0; jump < 2; ++jump)
+                {
+                    Settings s;
+                    s.thresholdType = ThresholdType(type);
+                    s.posOn = (dirs & CrossingScan::RISING) != 0;
+                    s.negOn = (dirs & CrossingScan::FALLING) != 0;
+                    s.pastSpan = voting ? span : 0;
+                    s.futureSpan = voting ? span : 0;
+                    s.pastStrict = 0.8f;
+                    s.futureStrict = 0.8f;
+                    s.useJumpLimit = jump != 0;
+                    s.jumpLimit = 12.0f;
+                    s.jumpLimitSleep = 0.0f;
+                    s.timeoutSamp = int(0.01f * sampleRate);
+                    s.constantThresh = 0.0f;
+                    s.randomMin = -20.0f;
+                    s.randomMax = 20.0f;
+
+                    long long referenceEvents = 0;
+                    long long kernelEvents = 0;
+                    double referenceNs = bestNsPerSample([&] { return runReference(rec, s, bufferSize); },
+                        numSamples, referenceEvents);
+                    double kernelNs = bestNsPerSample([&] { return runKernel(rec, s, bufferSize); },
+                        numSamples, kernelEvents);
+
+                    std::printf("%-10s %-8s %-7s %-5s %12.3f %12.3f %7.1fx %8lld%s\n",
+                        typeNames[type], dirNames[dirs], voting ? "on" : "off", jump ? "on" : "off",
+                        referenceNs, kernelNs, referenceNs / kernelNs, kernelEvents,
+                        referenceEvents == kernelEvents ? "" : "  MISMATCH");
+
+                    if (referenceEvents != kernelEvents)
+                        ++numMismatches;
+                }
+            }
+        }
+    }
+
+    return numMismatches == 0 ? 0 : 1;
+}
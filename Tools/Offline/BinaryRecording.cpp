@@ -0,0 +1,288 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "BinaryRecording.h"
+#include "Json.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+/** ------------- Mapped File --------------- */
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : address(nullptr), length(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr) {}
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    LARGE_INTEGER fileSize;
+    if (fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileHandle, &fileSize))
+    {
+        close();
+        return false;
+    }
+    length = fileSize.QuadPart;
+
+    if (length > 0)
+    {
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        address = mappingHandle != nullptr ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (address == nullptr)
+        {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (address != nullptr)
+    {
+        UnmapViewOfFile(address);
+    }
+    if (mappingHandle != nullptr)
+    {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(fileHandle);
+    }
+    address = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+    length = 0;
+}
+
+#else
+
+MappedFile::MappedFile() : address(nullptr), length(0), fd(-1) {}
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+        close();
+        return false;
+    }
+    length = int64_t(info.st_size);
+
+    if (length > 0)
+    {
+        address = mmap(nullptr, size_t(length), PROT_READ, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED)
+        {
+            address = nullptr;
+            close();
+            return false;
+        }
+        madvise(address, size_t(length), MADV_SEQUENTIAL);
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (address != nullptr)
+    {
+        munmap(address, size_t(length));
+    }
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+    address = nullptr;
+    fd = -1;
+    length = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+/** ------------- Binary Recording --------------- */
+
+bool BinaryRecording::listStreams(const std::string& directory, std::vector<Stream>& streams, std::string& error)
+{
+    const fs::path oebinPath = fs::path(directory) / "structure.oebin";
+    std::ifstream in(oebinPath);
+    if (!in)
+    {
+        error = "can't open " + oebinPath.string();
+        return false;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+
+    Json structure;
+    if (!Json::parse(text.str(), structure, error))
+    {
+        error = oebinPath.string() + ": " + error;
+        return false;
+    }
+
+    streams.clear();
+    const Json& continuous = structure["continuous"];
+    for (size_t i = 0; i < continuous.size(); ++i)
+    {
+        const Json& info = continuous[i];
+
+        Stream stream;
+        std::string folder = info["folder_name"].asString();
+        while (!folder.empty() && (folder.back() == '/' || folder.back() == '\\'))
+        {
+            folder.pop_back();
+        }
+        stream.name = info["stream_name"].isNull() ? folder : info["stream_name"].asString();
+        stream.directory = (fs::path(directory) / "continuous" / folder).string();
+        stream.sampleRate = float(info["sample_rate"].asNumber());
+        stream.numChannels = int(info["num_channels"].asNumber());
+
+        const Json& channels = info["channels"];
+        for (int c = 0; c < stream.numChannels; ++c)
+        {
+            stream.bitVolts.push_back(channels[size_t(c)]["bit_volts"].asNumber(1.0));
+        }
+        streams.push_back(stream);
+    }
+    return true;
+}
+
+BinaryRecording::BinaryRecording() : numSamples(0), firstSampleNumber(0) {}
+
+bool BinaryRecording::open(const Stream& stream_, std::string& error)
+{
+    stream = stream_;
+    timestamps.close();
+    numSamples = 0;
+    firstSampleNumber = 0;
+
+    if (stream.numChannels <= 0 || stream.sampleRate <= 0)
+    {
+        error = "stream " + stream.name + " has no channels or no sample rate";
+        return false;
+    }
+    stream.bitVolts.resize(size_t(stream.numChannels), 1.0);
+
+    const fs::path dir(stream.directory);
+    const std::string dataPath = (dir / "continuous.dat").string();
+    if (!data.open(dataPath))
+    {
+        error = "can't map " + dataPath;
+        return false;
+    }
+    numSamples = data.size() / (int64_t(sizeof(int16_t)) * stream.numChannels);
+
+    // the first sample number: sample_numbers.npy, or int64 timestamps.npy in the older format
+    NpyReader sampleNumbers;
+    std::string npyError;
+    if (sampleNumbers.open((dir / "sample_numbers.npy").string(), npyError))
+    {
+        sampleNumbers.read(0, 1, &firstSampleNumber);
+    }
+
+    if (timestamps.open((dir / "timestamps.npy").string(), npyError))
+    {
+        if (timestamps.getType() == "<i8")
+        {
+            if (!sampleNumbers.isOpen())
+            {
+                timestamps.read(0, 1, &firstSampleNumber);
+            }
+            timestamps.close();
+        }
+        else if (timestamps.getType() != "<f8" || timestamps.size() < numSamples)
+        {
+            timestamps.close();
+        }
+    }
+    return true;
+}
+
+double BinaryRecording::getTimestamp(int64_t sampleNumber)
+{
+    if (timestamps.isOpen() && timestamps.size() > 0)
+    {
+        // events may end after the last sample: extrapolate from the nearest one
+        const int64_t index = std::min(std::max<int64_t>(sampleNumber - firstSampleNumber, 0), timestamps.size() - 1);
+        double timestamp;
+        if (timestamps.read(index, 1, &timestamp))
+        {
+            return timestamp + double(sampleNumber - firstSampleNumber - index) / stream.sampleRate;
+        }
+    }
+    return double(sampleNumber) / stream.sampleRate;
+}
+
+void BinaryRecording::read(const std::vector<int>& channels, int64_t start, int count, float* const* dest) const
+{
+    // in tiles of samples that stay in the cache while each channel is picked out of them
+    const int TILE_SAMPLES = 256;
+    const int numChannels = stream.numChannels;
+    const int16_t* samples = static_cast<const int16_t*>(data.data()) + start * numChannels;
+
+    for (int tile = 0; tile < count; tile += TILE_SAMPLES)
+    {
+        const int tileSamples = std::min(TILE_SAMPLES, count - tile);
+        const int16_t* tileData = samples + int64_t(tile) * numChannels;
+
+        for (size_t k = 0; k < channels.size(); ++k)
+        {
+            const int16_t* in = tileData + channels[k];
+            const float scale = float(stream.bitVolts[size_t(channels[k])]);
+            float* out = dest[k] + tile;
+
+            for (int i = 0; i < tileSamples; ++i)
+            {
+                out[i] = in[i * numChannels] * scale;
+            }
+        }
+    }
+}
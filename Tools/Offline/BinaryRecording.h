@@ -0,0 +1,120 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BINARY_RECORDING_H_INCLUDED
+#define BINARY_RECORDING_H_INCLUDED
+
+/*
+Continuous data of an Open Ephys recording in the flat binary format: a continuous.dat file per
+stream with interleaved int16 samples, scaled to volts (or microvolts) by each channel's
+bit_volts, which is listed in the recording's structure.oebin along with the sample rate.
+The first sample number is in sample_numbers.npy (timestamps.npy in recordings from before
+version 0.6 of the GUI).
+
+The data file is memory-mapped, and blocks of it are converted to float channels on request.
+*/
+
+#include "NpyFile.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** Read-only memory mapping of a whole file */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** Maps a file, hinting that it will be read sequentially. Returns false if it can't be mapped. */
+    bool open(const std::string& path);
+    void close();
+
+    const void* data() const { return address; }
+    int64_t size() const { return length; }
+
+private:
+    void* address;
+    int64_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+};
+
+class BinaryRecording
+{
+public:
+    /** A continuous stream of a recording */
+    struct Stream
+    {
+        std::string name;
+        std::string directory;          // containing continuous.dat
+        float sampleRate;
+        int numChannels;
+        std::vector<double> bitVolts;   // of each channel
+    };
+
+    /** Lists the continuous streams of the recording in 'directory' (the one containing
+     *  structure.oebin). Returns false if there is no readable structure.oebin.
+     */
+    static bool listStreams(const std::string& directory, std::vector<Stream>& streams, std::string& error);
+
+    BinaryRecording();
+
+    /** Opens the data of a stream. Returns false (with a message in 'error') if it can't be read. */
+    bool open(const Stream& stream, std::string& error);
+
+    const Stream& getStream() const { return stream; }
+
+    /** Number of samples of each channel */
+    int64_t getNumSamples() const { return numSamples; }
+
+    /** Sample number of the first sample */
+    int64_t getFirstSampleNumber() const { return firstSampleNumber; }
+
+    /** Synchronized time of a sample in seconds, from timestamps.npy if the recording has them
+     *  (otherwise the sample number divided by the sample rate).
+     */
+    double getTimestamp(int64_t sampleNumber);
+
+    /** Converts 'count' samples of the given channels from 'start' (relative to the first
+     *  sample) to floats in physical units, writing those of channels[k] to dest[k].
+     */
+    void read(const std::vector<int>& channels, int64_t start, int count, float* const* dest) const;
+
+private:
+    Stream stream;
+    MappedFile data;
+    int64_t numSamples;
+    int64_t firstSampleNumber;
+    NpyReader timestamps;   // float64 seconds of each sample, if present
+};
+
+#endif // BINARY_RECORDING_H_INCLUDED
@@ -0,0 +1,237 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ChunkedDetection.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <thread>
+
+struct ChunkedDetection::Chunk
+{
+    int64_t begin;
+    int64_t end;
+    std::vector<uint8_t> startState;    // after the warm-up
+    std::vector<uint8_t> endState;
+    std::vector<CrossingEngine::Event> events;
+    std::promise<void> done;
+};
+
+ChunkedDetection::ChunkedDetection() :
+    numThreads(0),
+    bufferSize(1024),
+    chunkSize(0),
+    warmup(-1),
+    recording(nullptr),
+    options(nullptr),
+    numChunks(0),
+    numRepeated(0)
+{}
+
+int64_t ChunkedDetection::getDefaultWarmup(const CrossingEngine::Settings& settings, float sampleRate)
+{
+    const double pi = 3.14159265358979323846;
+    const double msToSamples = sampleRate / 1000.0;
+    const int decimation = std::max(settings.decimation, 1);
+
+    // parts of the state that only depend on a limited number of samples
+    double finite = (settings.pastSpan + settings.futureSpan + 2)
+        + (settings.timeout + settings.eventDuration + settings.bufferEndMaskMs) * msToSamples
+        + settings.jumpLimitSleep * sampleRate
+        + PolyphaseDecimator::TAPS_PER_PHASE * decimation;
+
+    // and those that decay exponentially (with the time constant in seconds)
+    const double TIME_CONSTANTS = 40;
+    double timeConstant = 0;
+
+    if (settings.prefilterType != BiquadCascade::NONE)
+    {
+        timeConstant = std::max(timeConstant, settings.prefilterOrder / (2 * pi * std::max(settings.prefilterLowCut, 0.01f)));
+    }
+    if (settings.thresholdType == ADAPTIVE)
+    {
+        timeConstant = std::max(timeConstant, settings.adaptiveTimeConstMs / 1000.0);
+    }
+    if (settings.thresholdType == PHASE)
+    {
+        timeConstant = std::max(timeConstant, 2 / (pi * std::max(settings.phaseBandwidth, 0.01f)));
+    }
+
+    return int64_t(std::ceil(finite + TIME_CONSTANTS * timeConstant * sampleRate));
+}
+
+void ChunkedDetection::appendEvents(const CrossingEngine& engine, std::vector<CrossingEngine::Event>& out)
+{
+    const size_t first = out.size();
+    out.insert(out.end(), engine.getEvents().begin(), engine.getEvents().end());
+    std::stable_sort(out.begin() + std::ptrdiff_t(first), out.end(),
+        [](const CrossingEngine::Event& a, const CrossingEngine::Event& b)
+        { return a.sampleNumber < b.sampleNumber; });
+}
+
+void ChunkedDetection::process(CrossingEngine& engine, int64_t from, int64_t to,
+    std::vector<CrossingEngine::Event>* events, std::vector<float>& scratch) const
+{
+    const size_t numMonitored = options->channels.size();
+    const bool useThresholdChannel = options->settings.thresholdType == CHANNEL;
+    const std::vector<int> thresholdChannels(1, options->thresholdChannel);
+
+    scratch.resize((numMonitored + 1) * size_t(bufferSize));
+    std::vector<float*> channelData(numMonitored);
+    for (size_t k = 0; k < numMonitored; ++k)
+    {
+        channelData[k] = scratch.data() + k * size_t(bufferSize);
+    }
+    float* thresholdData = scratch.data() + numMonitored * size_t(bufferSize);
+    std::vector<const float*> input(channelData.begin(), channelData.end());
+
+    for (int64_t pos = from; pos < to; pos += bufferSize)
+    {
+        const int count = int(std::min<int64_t>(bufferSize, to - pos));
+        recording->read(options->channels, pos, count, channelData.data());
+        if (useThresholdChannel)
+        {
+            recording->read(thresholdChannels, pos, count, &thresholdData);
+        }
+
+        engine.process(input.data(), thresholdData, count, recording->getFirstSampleNumber() + pos);
+
+        if (events != nullptr)
+        {
+            appendEvents(engine, *events);
+        }
+    }
+}
+
+std::vector<CrossingEngine::Event> ChunkedDetection::run(const BinaryRecording& recording_, const DetectorOptions& options_)
+{
+    recording = &recording_;
+    options = &options_;
+    numRepeated = 0;
+
+    const CrossingEngine::Settings& settings = options->settings;
+    const float sampleRate = recording->getStream().sampleRate;
+    const int64_t numSamples = recording->getNumSamples();
+
+    int threads = numThreads > 0 ? numThreads : int(std::max(1u, std::thread::hardware_concurrency()));
+    int64_t warmupSamples = warmup >= 0 ? warmup : getDefaultWarmup(settings, sampleRate);
+    warmupSamples = (warmupSamples + bufferSize - 1) / bufferSize * bufferSize;
+
+    // states that never converge: every chunk would be repeated, so don't split at all
+    const bool converges = settings.thresholdType != RANDOM
+        && !(settings.thresholdType == ADAPTIVE
+            && (settings.adaptiveEstimator == AdaptiveThreshold::MEDIAN_ABS || settings.useAdaptiveFreeze));
+
+    // chunks of whole buffers, a few per thread, each much longer than the warm-up
+    int64_t samplesPerChunk = chunkSize > 0 ? chunkSize
+        : std::max<int64_t>({ (numSamples + 4 * threads - 1) / (4 * threads), 8 * warmupSamples, 16 * int64_t(bufferSize) });
+    samplesPerChunk = std::max<int64_t>(1, (samplesPerChunk + bufferSize - 1) / bufferSize) * bufferSize;
+
+    if (!converges || threads == 1)
+    {
+        samplesPerChunk = std::max<int64_t>(numSamples, 1);
+    }
+
+    numChunks = int(std::max<int64_t>(1, (numSamples + samplesPerChunk - 1) / samplesPerChunk));
+    std::vector<Chunk> chunks(static_cast<size_t>(numChunks));
+    for (int i = 0; i < numChunks; ++i)
+    {
+        chunks[size_t(i)].begin = i * samplesPerChunk;
+        chunks[size_t(i)].end = std::min(numSamples, (i + 1) * samplesPerChunk);
+    }
+
+    // workers take the chunks in order, while this thread stitches them together
+    std::atomic<int> nextChunk(0);
+    auto work = [&]()
+    {
+        CrossingEngine engine;
+        std::vector<float> scratch;
+
+        for (int i = nextChunk++; i < numChunks; i = nextChunk++)
+        {
+            Chunk& chunk = chunks[size_t(i)];
+
+            options->apply(engine, sampleRate);
+            engine.start(bufferSize);
+
+            process(engine, std::max<int64_t>(0, chunk.begin - warmupSamples), chunk.begin, nullptr, scratch);
+            engine.saveState(chunk.startState);
+
+            process(engine, chunk.begin, chunk.end, &chunk.events, scratch);
+            engine.saveState(chunk.endState);
+
+            chunk.done.set_value();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < std::min(threads, numChunks); ++t)
+    {
+        workers.emplace_back(work);
+    }
+
+    std::vector<CrossingEngine::Event> events;
+    std::vector<uint8_t> trueState;
+    CrossingEngine repeater;
+    std::vector<float> scratch;
+    bool repeaterReady = false;
+
+    for (int i = 0; i < numChunks; ++i)
+    {
+        Chunk& chunk = chunks[size_t(i)];
+        chunk.done.get_future().wait();
+
+        if (i > 0 && chunk.startState != trueState)
+        {
+            // the warm-up didn't arrive at the state of the sequential pass
+            if (!repeaterReady)
+            {
+                options->apply(repeater, sampleRate);
+                repeater.start(bufferSize);
+                repeaterReady = true;
+            }
+            repeater.restoreState(trueState);
+
+            chunk.events.clear();
+            process(repeater, chunk.begin, chunk.end, &chunk.events, scratch);
+            repeater.saveState(chunk.endState);
+            ++numRepeated;
+        }
+
+        events.insert(events.end(), chunk.events.begin(), chunk.events.end());
+        trueState.swap(chunk.endState);
+
+        // free what is no longer needed
+        std::vector<CrossingEngine::Event>().swap(chunk.events);
+        std::vector<uint8_t>().swap(chunk.startState);
+        std::vector<uint8_t>().swap(chunk.endState);
+    }
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    return events;
+}
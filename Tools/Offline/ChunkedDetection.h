@@ -0,0 +1,102 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CHUNKED_DETECTION_H_INCLUDED
+#define CHUNKED_DETECTION_H_INCLUDED
+
+/*
+Detection over a whole recording on several threads, with exactly the events of one sequential
+pass.
+
+The recording is split into chunks (on buffer boundaries), which are processed in parallel. Each
+chunk but the first starts from a fresh detector a warm-up period before the chunk, and saves
+the detector's state where the chunk begins. The chunks are then stitched together in order: the
+state at the end of one chunk is the true state at the start of the next, and if the next chunk's
+warm-up arrived at exactly that state (snapshots compared byte for byte), its events are the
+ones a sequential pass would produce. Otherwise the chunk is processed again from the true
+state, on the thread that stitches the chunks, so a run that repeats most chunks takes about
+as long as a sequential pass (getNumRepeated() tells how many were).
+
+Detector state with finite memory (histories, decimation) converges within the warm-up, and
+adaptive thresholds usually do once their transients have decayed below the floating-point
+resolution. Random thresholds, the median estimator and thresholds frozen after calibration
+never do, so with those the recording is processed in one pass. Two other cases rarely converge,
+and then most chunks are repeated:
+- a timeout that is rearmed by every crossing: when a channel crosses again as soon as the
+  timeout has elapsed, the timing of its events depends on the first event of the stretch,
+  however long the warm-up (e.g. the default 1000 ms timeout on a spiking channel);
+- an input filter: the rounding errors of two runs of the IIR filter from different states
+  don't die out, so its state is rarely the same to the bit after the warm-up.
+*/
+
+#include "BinaryRecording.h"
+#include "CrossingEngine.h"
+#include "DetectorOptions.h"
+
+#include <cstdint>
+#include <vector>
+
+class ChunkedDetection
+{
+public:
+    ChunkedDetection();
+
+    int numThreads;         // 0 = one per core
+    int bufferSize;         // samples per process() call
+    int64_t chunkSize;      // samples per chunk, 0 = chosen from the recording and warm-up
+    int64_t warmup;         // samples processed before each chunk, -1 = getDefaultWarmup()
+
+    /** Runs the detector over all samples of the recording and returns the events in the order
+     *  of their sample numbers (as the GUI receives them in each buffer).
+     */
+    std::vector<CrossingEngine::Event> run(const BinaryRecording& recording, const DetectorOptions& options);
+
+    /** Number of chunks of the last run */
+    int getNumChunks() const { return numChunks; }
+
+    /** Number of chunks of the last run that had to be processed again */
+    int getNumRepeated() const { return numRepeated; }
+
+    /** Warm-up after which the state of the detector usually no longer depends on the samples
+     *  before it, in samples: the spans, timeout, event duration and other finite memory, and
+     *  40 time constants of the filters and adaptive thresholds.
+     */
+    static int64_t getDefaultWarmup(const CrossingEngine::Settings& settings, float sampleRate);
+
+    /** Appends the events of the engine's last buffer to 'out', ordered by sample number. */
+    static void appendEvents(const CrossingEngine& engine, std::vector<CrossingEngine::Event>& out);
+
+private:
+    struct Chunk;
+
+    /** Processes samples [from, to) of the recording with 'engine', appending the events if 'events' is not null. */
+    void process(CrossingEngine& engine, int64_t from, int64_t to, std::vector<CrossingEngine::Event>* events,
+        std::vector<float>& scratch) const;
+
+    const BinaryRecording* recording;
+    const DetectorOptions* options;
+    int numChunks;
+    int numRepeated;
+};
+
+#endif // CHUNKED_DETECTION_H_INCLUDED
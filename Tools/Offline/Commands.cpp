@@ -0,0 +1,158 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Commands.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+RecordingSource::RecordingSource() :
+    sampleRate(0.0f),
+    numChannels(0),
+    bitVolts(1.0)
+{}
+
+bool RecordingSource::parseOption(int argc, const char* const* argv, int& i, std::string& error)
+{
+    const char* option = argv[i];
+    const bool known = std::strcmp(option, "--stream") == 0 || std::strcmp(option, "--rate") == 0
+        || std::strcmp(option, "--num-channels") == 0 || std::strcmp(option, "--bit-volts") == 0;
+
+    if (!known)
+    {
+        return false;
+    }
+    if (i + 1 >= argc)
+    {
+        error = std::string("missing value for ") + option;
+        return true;
+    }
+
+    const char* value = argv[++i];
+    if (std::strcmp(option, "--stream") == 0)
+    {
+        stream = value;
+    }
+    else if (std::strcmp(option, "--rate") == 0)
+    {
+        sampleRate = float(std::atof(value));
+    }
+    else if (std::strcmp(option, "--num-channels") == 0)
+    {
+        numChannels = std::atoi(value);
+    }
+    else
+    {
+        bitVolts = std::atof(value);
+    }
+    return true;
+}
+
+const char* RecordingSource::getUsage()
+{
+    return
+        "  <recording>            directory containing structure.oebin, or a continuous.dat file\n"
+        "  --stream <name|index>  continuous stream of the recording (default: the first)\n"
+        "  --rate <Hz>            sample rate of a continuous.dat file\n"
+        "  --num-channels <n>     number of channels of a continuous.dat file\n"
+        "  --bit-volts <scale>    scale of the samples of a continuous.dat file (default: 1)\n";
+}
+
+bool RecordingSource::open(BinaryRecording& recording, std::string& error) const
+{
+    if (path.empty())
+    {
+        error = "no recording given";
+        return false;
+    }
+
+    BinaryRecording::Stream selected;
+
+    if (!fs::is_directory(path))
+    {
+        // a bare data file: sample numbers and timestamps are read from next to it
+        if (sampleRate <= 0 || numChannels <= 0)
+        {
+            error = "--rate and --num-channels are required for a .dat file";
+            return false;
+        }
+        selected.name = fs::path(path).parent_path().filename().string();
+        selected.directory = fs::path(path).parent_path().string();
+        selected.sampleRate = sampleRate;
+        selected.numChannels = numChannels;
+        selected.bitVolts.assign(size_t(numChannels), bitVolts);
+
+        if (fs::path(path).filename() != "continuous.dat")
+        {
+            error = "expected a continuous.dat file: " + path;
+            return false;
+        }
+        return recording.open(selected, error);
+    }
+
+    std::vector<BinaryRecording::Stream> streams;
+    if (!BinaryRecording::listStreams(path, streams, error))
+    {
+        return false;
+    }
+    if (streams.empty())
+    {
+        error = path + " has no continuous streams";
+        return false;
+    }
+
+    if (stream.empty())
+    {
+        selected = streams[0];
+    }
+    else
+    {
+        char* end = nullptr;
+        const long index = std::strtol(stream.c_str(), &end, 10);
+        bool found = false;
+
+        for (size_t s = 0; s < streams.size() && !found; ++s)
+        {
+            found = streams[s].name == stream || (*end == '\0' && long(s) == index);
+            if (found)
+            {
+                selected = streams[s];
+            }
+        }
+
+        if (!found)
+        {
+            error = "no stream " + stream + " in " + path + "; it has:";
+            for (const auto& s : streams)
+            {
+                error += " \"" + s.name + "\"";
+            }
+            return false;
+        }
+    }
+    return recording.open(selected, error);
+}
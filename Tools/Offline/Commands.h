@@ -0,0 +1,73 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef COMMANDS_H_INCLUDED
+#define COMMANDS_H_INCLUDED
+
+/*
+Subcommands of crossing-detector-tool, and the options they share. Each command takes the
+arguments following its name and returns the exit code.
+*/
+
+#include "BinaryRecording.h"
+
+#include <string>
+
+/** Runs the detector over a recording and writes its events */
+int runReplay(int argc, const char* const* argv);
+
+/** Runs many configurations of the detector over a recording and ranks them */
+int runSweep(int argc, const char* const* argv);
+
+/** Checks the detector against the reference model on random signals and settings */
+int runVerify(int argc, const char* const* argv);
+
+/** Checks that processing doesn't allocate memory once the detector has started */
+int runRealtimeCheck(int argc, const char* const* argv);
+
+/** Where the continuous data comes from: a recording directory (containing structure.oebin)
+ *  and optionally a stream, or a continuous.dat file with its format given explicitly.
+ */
+struct RecordingSource
+{
+    RecordingSource();
+
+    std::string path;
+    std::string stream;     // name or index of the stream, for a recording directory
+    float sampleRate;       // for a .dat file
+    int numChannels;        // for a .dat file
+    double bitVolts;        // for a .dat file
+
+    /** Takes an option at argv[i] if it is one of these (advancing i past its value). Returns
+     *  false if it isn't; sets 'error' if it is but its value is missing.
+     */
+    bool parseOption(int argc, const char* const* argv, int& i, std::string& error);
+
+    /** Usage text of the options */
+    static const char* getUsage();
+
+    /** Opens the recording. Returns false (with a message in 'error') if it can't be read. */
+    bool open(BinaryRecording& recording, std::string& error) const;
+};
+
+#endif // COMMANDS_H_INCLUDED
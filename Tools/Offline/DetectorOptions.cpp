@@ -0,0 +1,249 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "DetectorOptions.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+
+// names of the plugin's parameters that can be set, as listed in the plugin's constructor
+static const char* const PARAMETER_NAMES[] = {
+    "Channel", "TTL_OUT", "Rising", "Falling", "Timeout_ms", "decimation", "prefilter_type",
+    "prefilter_order", "prefilter_low_cut", "prefilter_high_cut", "threshold_type", "constant_threshold",
+    "min_random_threshold", "max_random_threshold", "threshold_chan", "adaptive_estimator",
+    "adaptive_multiplier", "adaptive_time_const", "adaptive_update", "use_adaptive_freeze",
+    "adaptive_calibration", "past_span", "future_span", "past_strict", "future_strict", "phase_target",
+    "phase_freq", "phase_bandwidth", "early_decision", "use_jump_limit", "jump_limit", "jump_limit_sleep",
+    "use_hysteresis", "hysteresis", "use_buffer_end_mask", "buffer_end_mask", "event_duration",
+    "crossing_interpolation", "seed"
+};
+
+static std::string trim(const std::string& s)
+{
+    const size_t begin = s.find_first_not_of(" \t\r\n");
+    const size_t end = s.find_last_not_of(" \t\r\n");
+    return begin == std::string::npos ? std::string() : s.substr(begin, end - begin + 1);
+}
+
+static bool equalsIgnoreCase(const std::string& a, const char* b)
+{
+    const std::string other(b);
+    return a.size() == other.size() && std::equal(a.begin(), a.end(), other.begin(),
+        [](char x, char y) { return std::tolower((unsigned char) x) == std::tolower((unsigned char) y); });
+}
+
+static bool parseNumber(const std::string& text, double& value)
+{
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    value = std::strtod(begin, &end);
+    return end != begin && *end == '\0';
+}
+
+static bool parseBool(const std::string& text, bool& value)
+{
+    if (equalsIgnoreCase(text, "true") || equalsIgnoreCase(text, "on") || text == "1")
+    {
+        value = true;
+        return true;
+    }
+    if (equalsIgnoreCase(text, "false") || equalsIgnoreCase(text, "off") || text == "0")
+    {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+DetectorOptions::DetectorOptions() :
+    channels(1, 0),
+    thresholdChannel(0),
+    firstLine(0),
+    seed(1)
+{}
+
+bool DetectorOptions::set(const std::string& nameText, const std::string& valueText, std::string& error)
+{
+    const std::string name = trim(nameText);
+    const std::string value = trim(valueText);
+
+    if (equalsIgnoreCase(name, "Channel"))
+    {
+        std::vector<int> list;
+        size_t pos = 0;
+        while (pos <= value.size())
+        {
+            size_t comma = value.find(',', pos);
+            if (comma == std::string::npos)
+            {
+                comma = value.size();
+            }
+
+            double number;
+            if (!parseNumber(trim(value.substr(pos, comma - pos)), number) || number < 1)
+            {
+                error = "invalid channel list: " + value;
+                return false;
+            }
+            list.push_back(int(number) - 1);
+            pos = comma + 1;
+        }
+        channels = list;
+        return true;
+    }
+
+    bool flag = false;
+    double number = 0;
+    const bool isBool = parseBool(value, flag);
+    const bool isNumber = parseNumber(value, number);
+    CrossingEngine::Settings& s = settings;
+
+    // boolean parameters
+    bool* boolTarget = nullptr;
+    if (equalsIgnoreCase(name, "Rising")) boolTarget = &s.posOn;
+    else if (equalsIgnoreCase(name, "Falling")) boolTarget = &s.negOn;
+    else if (equalsIgnoreCase(name, "use_adaptive_freeze")) boolTarget = &s.useAdaptiveFreeze;
+    else if (equalsIgnoreCase(name, "early_decision")) boolTarget = &s.earlyDecision;
+    else if (equalsIgnoreCase(name, "use_jump_limit")) boolTarget = &s.useJumpLimit;
+    else if (equalsIgnoreCase(name, "use_hysteresis")) boolTarget = &s.useHysteresis;
+    else if (equalsIgnoreCase(name, "use_buffer_end_mask")) boolTarget = &s.useBufferEndMask;
+
+    if (boolTarget != nullptr)
+    {
+        if (!isBool)
+        {
+            error = name + " must be true or false";
+            return false;
+        }
+        *boolTarget = flag;
+        return true;
+    }
+
+    if (!isNumber)
+    {
+        error = "invalid value for " + name + ": " + value;
+        return false;
+    }
+
+    const int integer = int(number);
+    const float real = float(number);
+
+    if (equalsIgnoreCase(name, "TTL_OUT"))
+    {
+        if (integer < 1 || integer > NUM_EVENT_LINES)
+        {
+            error = "TTL_OUT must be between 1 and " + std::to_string(NUM_EVENT_LINES);
+            return false;
+        }
+        firstLine = integer - 1;
+    }
+    else if (equalsIgnoreCase(name, "Timeout_ms")) s.timeout = integer;
+    else if (equalsIgnoreCase(name, "decimation")) s.decimation = std::max(1, integer);
+    else if (equalsIgnoreCase(name, "prefilter_type")) s.prefilterType = static_cast<BiquadCascade::Type>(integer);
+    else if (equalsIgnoreCase(name, "prefilter_order")) s.prefilterOrder = integer;
+    else if (equalsIgnoreCase(name, "prefilter_low_cut")) s.prefilterLowCut = real;
+    else if (equalsIgnoreCase(name, "prefilter_high_cut")) s.prefilterHighCut = real;
+    else if (equalsIgnoreCase(name, "threshold_type")) s.thresholdType = static_cast<ThresholdType>(integer);
+    else if (equalsIgnoreCase(name, "constant_threshold")) s.constantThresh = real;
+    else if (equalsIgnoreCase(name, "min_random_threshold")) s.randomThreshRange[0] = real;
+    else if (equalsIgnoreCase(name, "max_random_threshold")) s.randomThreshRange[1] = real;
+    else if (equalsIgnoreCase(name, "threshold_chan")) thresholdChannel = integer;
+    else if (equalsIgnoreCase(name, "adaptive_estimator")) s.adaptiveEstimator = static_cast<AdaptiveThreshold::Estimator>(integer);
+    else if (equalsIgnoreCase(name, "adaptive_multiplier")) s.adaptiveMultiplier = real;
+    else if (equalsIgnoreCase(name, "adaptive_time_const")) s.adaptiveTimeConstMs = integer;
+    else if (equalsIgnoreCase(name, "adaptive_update")) s.adaptiveUpdateMs = integer;
+    else if (equalsIgnoreCase(name, "adaptive_calibration")) s.adaptiveCalibrationMs = integer;
+    else if (equalsIgnoreCase(name, "past_span")) s.pastSpan = integer;
+    else if (equalsIgnoreCase(name, "future_span")) s.futureSpan = integer;
+    else if (equalsIgnoreCase(name, "past_strict")) s.pastStrict = real;
+    else if (equalsIgnoreCase(name, "future_strict")) s.futureStrict = real;
+    else if (equalsIgnoreCase(name, "phase_target")) s.phaseTarget = real;
+    else if (equalsIgnoreCase(name, "phase_freq")) s.phaseFreq = real;
+    else if (equalsIgnoreCase(name, "phase_bandwidth")) s.phaseBandwidth = real;
+    else if (equalsIgnoreCase(name, "jump_limit")) s.jumpLimit = real;
+    else if (equalsIgnoreCase(name, "jump_limit_sleep")) s.jumpLimitSleep = real;
+    else if (equalsIgnoreCase(name, "hysteresis")) s.hysteresis = real;
+    else if (equalsIgnoreCase(name, "buffer_end_mask")) s.bufferEndMaskMs = integer;
+    else if (equalsIgnoreCase(name, "event_duration")) s.eventDuration = integer;
+    else if (equalsIgnoreCase(name, "crossing_interpolation")) s.interpolation = static_cast<CrossingKernel::Interpolation>(integer);
+    else if (equalsIgnoreCase(name, "seed")) seed = int64_t(number);
+    else
+    {
+        error = "unknown parameter: " + name;
+        return false;
+    }
+    return true;
+}
+
+bool DetectorOptions::set(const std::string& assignment, std::string& error)
+{
+    const size_t equals = assignment.find('=');
+    if (equals == std::string::npos)
+    {
+        error = "expected name=value: " + assignment;
+        return false;
+    }
+    return set(assignment.substr(0, equals), assignment.substr(equals + 1), error);
+}
+
+bool DetectorOptions::load(const std::string& path, std::string& error)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        error = "can't open " + path;
+        return false;
+    }
+
+    std::string line;
+    for (int lineNumber = 1; std::getline(in, line); ++lineNumber)
+    {
+        line = trim(line.substr(0, line.find('#')));
+        if (!line.empty() && !set(line, error))
+        {
+            error = path + ":" + std::to_string(lineNumber) + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string DetectorOptions::getNames()
+{
+    std::string names;
+    for (auto name : PARAMETER_NAMES)
+    {
+        names += names.empty() ? "" : ", ";
+        names += name;
+    }
+    return names;
+}
+
+void DetectorOptions::apply(CrossingEngine& engine, float sampleRate) const
+{
+    engine.settings = settings;
+    engine.setRandomSeed(seed);
+    engine.configure(sampleRate, int(channels.size()));
+}
@@ -0,0 +1,76 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DETECTOR_OPTIONS_H_INCLUDED
+#define DETECTOR_OPTIONS_H_INCLUDED
+
+/*
+Detector parameters of the offline tools, given by the names of the plugin's parameters
+(e.g. "past_span=10", case-insensitive) so that the settings of a GUI session can be reused.
+"Channel" takes a comma-separated list of channel numbers, starting from 1 as in the editor.
+*/
+
+#include "CrossingEngine.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct DetectorOptions
+{
+    /** TTL lines that channels are mapped to, as in the plugin */
+    static const int NUM_EVENT_LINES = 64;
+
+    DetectorOptions();
+
+    CrossingEngine::Settings settings;
+
+    std::vector<int> channels;  // monitored channels of the stream, from 0
+    int thresholdChannel;       // of the stream, from 0, for CHANNEL thresholds
+    int firstLine;              // TTL line of the first monitored channel, from 0 (TTL_OUT - 1)
+    int64_t seed;               // of random thresholds
+
+    /** Sets a parameter from its text value. Returns false (with a message in 'error') if the
+     *  name is unknown or the value can't be parsed.
+     */
+    bool set(const std::string& name, const std::string& value, std::string& error);
+
+    /** Sets "name=value" */
+    bool set(const std::string& assignment, std::string& error);
+
+    /** Reads parameters from a file with one "name = value" per line ('#' starts a comment). */
+    bool load(const std::string& path, std::string& error);
+
+    /** Lists the parameter names, for help texts */
+    static std::string getNames();
+
+    /** TTL line (from 0) of the events of a monitored channel, given its index among the
+     *  monitored channels: the lines follow firstLine, wrapping around after the last one.
+     */
+    int getEventLine(int channel) const { return (firstLine + channel) % NUM_EVENT_LINES; }
+
+    /** Configures an engine for a stream with the given sample rate. */
+    void apply(CrossingEngine& engine, float sampleRate) const;
+};
+
+#endif // DETECTOR_OPTIONS_H_INCLUDED
@@ -0,0 +1,110 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "EventWriter.h"
+
+#include <filesystem>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+EventWriter::EventWriter() :
+    csv(nullptr),
+    word(0),
+    numEvents(0)
+{}
+
+EventWriter::~EventWriter()
+{
+    close();
+}
+
+bool EventWriter::open(const std::string& directory, const std::string& csvPath, std::string& error)
+{
+    close();
+    word = 0;
+    numEvents = 0;
+
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+
+    const fs::path dir(directory);
+    if (!states.open((dir / "states.npy").string(), "<i2")
+        || !sampleNumbers.open((dir / "sample_numbers.npy").string(), "<i8")
+        || !timestamps.open((dir / "timestamps.npy").string(), "<f8")
+        || !fullWords.open((dir / "full_words.npy").string(), "<u8"))
+    {
+        error = "can't create the event files in " + directory;
+        close();
+        return false;
+    }
+
+    if (!csvPath.empty())
+    {
+        csv = std::fopen(csvPath.c_str(), "w");
+        if (csv == nullptr)
+        {
+            error = "can't create " + csvPath;
+            close();
+            return false;
+        }
+        std::fprintf(csv, "sample_number,timestamp,line,state,channel,crossing_point,crossing_level,"
+            "threshold,direction,latency,crossing_time\n");
+    }
+    return true;
+}
+
+void EventWriter::write(const CrossingEngine::Event& event, int line, double timestamp)
+{
+    const uint64_t bit = uint64_t(1) << line;
+    word = event.on ? (word | bit) : (word & ~bit);
+
+    states.write(int16_t(event.on ? line + 1 : -(line + 1)));
+    sampleNumbers.write(int64_t(event.sampleNumber));
+    timestamps.write(timestamp);
+    fullWords.write(word);
+    ++numEvents;
+
+    if (csv != nullptr)
+    {
+        std::fprintf(csv, "%lld,%.9f,%d,%d,%d,%lld,%.9g,%.9g,%d,%d,%.6f\n",
+            (long long) event.sampleNumber, timestamp, line + 1, event.on ? 1 : 0, event.channel,
+            (long long) event.crossingPoint, event.crossingLevel, event.threshold, event.rising() ? 1 : 0,
+            event.latency, event.crossingTime);
+    }
+}
+
+bool EventWriter::close()
+{
+    bool ok = states.close();
+    ok = sampleNumbers.close() && ok;
+    ok = timestamps.close() && ok;
+    ok = fullWords.close() && ok;
+
+    if (csv != nullptr)
+    {
+        ok = std::fclose(csv) == 0 && ok;
+        csv = nullptr;
+    }
+    return ok;
+}
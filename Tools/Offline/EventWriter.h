@@ -0,0 +1,76 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef EVENT_WRITER_H_INCLUDED
+#define EVENT_WRITER_H_INCLUDED
+
+/*
+Writes detected events as the GUI's binary format records a TTL event channel: states.npy
+(+line or -line, counting lines from 1), sample_numbers.npy, timestamps.npy (seconds) and
+full_words.npy (the state of all lines after each event).
+
+The binary format doesn't store the events' metadata (crossing point, level, ...), so it can
+additionally be written to a CSV file with one row per event.
+*/
+
+#include "CrossingEngine.h"
+#include "NpyFile.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+class EventWriter
+{
+public:
+    EventWriter();
+    ~EventWriter();
+
+    EventWriter(const EventWriter&) = delete;
+    EventWriter& operator=(const EventWriter&) = delete;
+
+    /** Creates the files in 'directory' (which is created if necessary), and the CSV file if
+     *  csvPath is not empty. Returns false (with a message in 'error') if they can't be created.
+     */
+    bool open(const std::string& directory, const std::string& csvPath, std::string& error);
+
+    /** Writes an event on the given TTL line (from 0), with its synchronized time in seconds */
+    void write(const CrossingEngine::Event& event, int line, double timestamp);
+
+    /** Completes the files. Returns false if they couldn't all be written. */
+    bool close();
+
+    int64_t getNumEvents() const { return numEvents; }
+
+private:
+    NpyWriter states;
+    NpyWriter sampleNumbers;
+    NpyWriter timestamps;
+    NpyWriter fullWords;
+    FILE* csv;
+
+    uint64_t word;  // current state of the lines
+    int64_t numEvents;
+};
+
+#endif // EVENT_WRITER_H_INCLUDED
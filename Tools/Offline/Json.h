@@ -0,0 +1,241 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_H_INCLUDED
+#define JSON_H_INCLUDED
+
+/*
+Minimal JSON reader, enough for the structure.oebin file of a recording. Numbers are doubles
+and strings are not unescaped beyond the simple escapes.
+*/
+
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Json
+{
+public:
+    enum Type { NUL = 0, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+    Json() : type(NUL), number(0) {}
+
+    /** Parses a document. Returns false (with a message in 'error') if it is not valid JSON. */
+    static bool parse(const std::string& text, Json& result, std::string& error)
+    {
+        size_t pos = 0;
+        if (!parseValue(text, pos, result) || (skipSpace(text, pos), pos != text.size()))
+        {
+            error = "invalid JSON near offset " + std::to_string(pos);
+            return false;
+        }
+        return true;
+    }
+
+    Type getType() const { return type; }
+    bool isNull() const { return type == NUL; }
+
+    double asNumber(double fallback = 0) const { return type == NUMBER ? number : fallback; }
+    bool asBool(bool fallback = false) const { return type == BOOLEAN ? number != 0 : fallback; }
+    const std::string& asString() const { return string; }
+
+    /** Number of elements of an array */
+    size_t size() const { return elements.size(); }
+
+    /** Element of an array */
+    const Json& operator[](size_t i) const { return i < elements.size() ? elements[i] : null(); }
+
+    /** Member of an object, or null if it has none with that name */
+    const Json& operator[](const char* name) const
+    {
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            if (names[i] == name)
+            {
+                return elements[i];
+            }
+        }
+        return null();
+    }
+
+private:
+    static const Json& null()
+    {
+        static const Json instance;
+        return instance;
+    }
+
+    static void skipSpace(const std::string& s, size_t& pos)
+    {
+        while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\n' || s[pos] == '\r'))
+        {
+            ++pos;
+        }
+    }
+
+    static bool parseString(const std::string& s, size_t& pos, std::string& out)
+    {
+        if (pos >= s.size() || s[pos] != '"')
+        {
+            return false;
+        }
+
+        for (++pos; pos < s.size(); ++pos)
+        {
+            char c = s[pos];
+            if (c == '"')
+            {
+                ++pos;
+                return true;
+            }
+            if (c == '\\' && pos + 1 < s.size())
+            {
+                c = s[++pos];
+                switch (c)
+                {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'u': pos += 4; c = '?'; break; // not needed for the names in a recording
+                default: break;
+                }
+            }
+            out += c;
+        }
+        return false;
+    }
+
+    static bool parseLiteral(const std::string& s, size_t& pos, const char* literal)
+    {
+        const std::string lit(literal);
+        if (s.compare(pos, lit.size(), lit) != 0)
+        {
+            return false;
+        }
+        pos += lit.size();
+        return true;
+    }
+
+    static bool parseValue(const std::string& s, size_t& pos, Json& out)
+    {
+        skipSpace(s, pos);
+        if (pos >= s.size())
+        {
+            return false;
+        }
+
+        const char c = s[pos];
+        if (c == '{' || c == '[')
+        {
+            const bool isObject = c == '{';
+            const char end = isObject ? '}' : ']';
+            out.type = isObject ? OBJECT : ARRAY;
+            ++pos;
+
+            skipSpace(s, pos);
+            if (pos < s.size() && s[pos] == end)
+            {
+                ++pos;
+                return true;
+            }
+
+            for (;;)
+            {
+                if (isObject)
+                {
+                    std::string name;
+                    skipSpace(s, pos);
+                    if (!parseString(s, pos, name))
+                    {
+                        return false;
+                    }
+                    skipSpace(s, pos);
+                    if (pos >= s.size() || s[pos++] != ':')
+                    {
+                        return false;
+                    }
+                    out.names.push_back(std::move(name));
+                }
+
+                out.elements.emplace_back();
+                if (!parseValue(s, pos, out.elements.back()))
+                {
+                    return false;
+                }
+
+                skipSpace(s, pos);
+                if (pos < s.size() && s[pos] == ',')
+                {
+                    ++pos;
+                }
+                else if (pos < s.size() && s[pos] == end)
+                {
+                    ++pos;
+                    return true;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+        }
+        if (c == '"')
+        {
+            out.type = STRING;
+            return parseString(s, pos, out.string);
+        }
+        if (c == 't' || c == 'f')
+        {
+            out.type = BOOLEAN;
+            out.number = c == 't';
+            return parseLiteral(s, pos, c == 't' ? "true" : "false");
+        }
+        if (c == 'n')
+        {
+            out.type = NUL;
+            return parseLiteral(s, pos, "null");
+        }
+
+        const char* begin = s.c_str() + pos;
+        char* end = nullptr;
+        out.type = NUMBER;
+        out.number = std::strtod(begin, &end);
+        if (end == begin)
+        {
+            return false;
+        }
+        pos += size_t(end - begin);
+        return true;
+    }
+
+    Type type;
+    double number;
+    std::string string;
+    std::vector<std::string> names;     // of an object's members
+    std::vector<Json> elements;         // of an array, or an object's member values
+};
+
+#endif // JSON_H_INCLUDED
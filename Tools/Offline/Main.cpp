@@ -0,0 +1,81 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+crossing-detector-tool: runs the crossing detector offline, without the GUI.
+
+    crossing-detector-tool <command> [arguments]
+*/
+
+#include "Commands.h"
+
+#include <cstdio>
+#include <cstring>
+
+struct Command
+{
+    const char* name;
+    int (*run)(int argc, const char* const* argv);
+    const char* description;
+};
+
+static const Command COMMANDS[] = {
+    { "replay", runReplay, "run the detector over a recording and write its events" },
+    { "sweep", runSweep, "rank configurations of the detector by their events on a recording" },
+    { "verify", runVerify, "check the detector against the reference model on random signals" },
+    { "rt-check", runRealtimeCheck, "check that the detector doesn't allocate memory while processing" },
+};
+
+static void printUsage()
+{
+    std::fprintf(stderr, "usage: crossing-detector-tool <command> [arguments]\n\ncommands:\n");
+    for (const Command& command : COMMANDS)
+    {
+        std::fprintf(stderr, "  %-10s %s\n", command.name, command.description);
+    }
+    std::fprintf(stderr, "\nRun a command with --help for its arguments.\n");
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 2;
+    }
+
+    for (const Command& command : COMMANDS)
+    {
+        if (std::strcmp(argv[1], command.name) == 0)
+        {
+            return command.run(argc - 2, argv + 2);
+        }
+    }
+
+    if (std::strcmp(argv[1], "--help") != 0 && std::strcmp(argv[1], "-h") != 0)
+    {
+        std::fprintf(stderr, "unknown command: %s\n\n", argv[1]);
+    }
+    printUsage();
+    return 2;
+}
@@ -0,0 +1,262 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef NPY_FILE_H_INCLUDED
+#define NPY_FILE_H_INCLUDED
+
+/*
+One-dimensional NumPy (.npy) arrays, as used for the sample numbers, timestamps and events of
+Open Ephys binary recordings.
+
+NpyReader reads elements at any position without loading the whole array. NpyWriter appends
+elements as they are produced; the header is written with room for any length and completed
+with the final length when the file is closed.
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+class NpyReader
+{
+public:
+    NpyReader() : file(nullptr), dataOffset(0), length(0), itemSize(0) {}
+    ~NpyReader() { close(); }
+
+    NpyReader(const NpyReader&) = delete;
+    NpyReader& operator=(const NpyReader&) = delete;
+
+    /** Opens an array. Returns false (with a message in 'error') if it can't be read. */
+    bool open(const std::string& path, std::string& error)
+    {
+        close();
+
+        file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            error = "can't open " + path;
+            return false;
+        }
+
+        unsigned char preamble[10];
+        if (std::fread(preamble, 1, 10, file) != 10 || std::memcmp(preamble, "\x93NUMPY", 6) != 0)
+        {
+            error = path + " is not a .npy file";
+            close();
+            return false;
+        }
+
+        // version 1 has a 2-byte header length, versions 2 and 3 a 4-byte one
+        size_t headerLength = preamble[8] | (size_t(preamble[9]) << 8);
+        size_t preambleLength = 10;
+        if (preamble[6] >= 2)
+        {
+            unsigned char high[2];
+            if (std::fread(high, 1, 2, file) != 2)
+            {
+                error = path + " is truncated";
+                close();
+                return false;
+            }
+            headerLength |= (size_t(high[0]) << 16) | (size_t(high[1]) << 24);
+            preambleLength = 12;
+        }
+
+        std::string header(headerLength, ' ');
+        if (std::fread(&header[0], 1, headerLength, file) != headerLength)
+        {
+            error = path + " is truncated";
+            close();
+            return false;
+        }
+        dataOffset = int64_t(preambleLength + headerLength);
+
+        descr = stringValue(header, "descr");
+        if (descr.size() < 3 || (descr[0] != '<' && descr[0] != '|'))
+        {
+            error = path + ": unsupported element type " + descr;
+            close();
+            return false;
+        }
+        itemSize = std::atoi(descr.c_str() + 2);
+
+        if (header.find("'fortran_order': True") != std::string::npos)
+        {
+            error = path + ": Fortran order is not supported";
+            close();
+            return false;
+        }
+
+        // shape (n,) or (n, 1)
+        const size_t shape = header.find("'shape'");
+        const size_t open = shape == std::string::npos ? shape : header.find('(', shape);
+        if (open == std::string::npos)
+        {
+            error = path + ": no shape";
+            close();
+            return false;
+        }
+        length = std::strtoll(header.c_str() + open + 1, nullptr, 10);
+        return true;
+    }
+
+    void close()
+    {
+        if (file != nullptr)
+        {
+            std::fclose(file);
+            file = nullptr;
+        }
+    }
+
+    bool isOpen() const { return file != nullptr; }
+
+    /** Number of elements */
+    int64_t size() const { return length; }
+
+    /** Type of the elements, e.g. "<i8" or "<f8" */
+    const std::string& getType() const { return descr; }
+
+    /** Reads 'count' elements from 'index' into 'dest', if the array has the type of T. */
+    template <typename T>
+    bool read(int64_t index, int64_t count, T* dest)
+    {
+        if (file == nullptr || itemSize != int(sizeof(T)) || index < 0 || index + count > length
+            || fseek64(dataOffset + index * itemSize) != 0)
+        {
+            return false;
+        }
+        return std::fread(dest, sizeof(T), size_t(count), file) == size_t(count);
+    }
+
+private:
+    static std::string stringValue(const std::string& header, const char* key)
+    {
+        const size_t keyPos = header.find(std::string("'") + key + "'");
+        if (keyPos == std::string::npos)
+        {
+            return {};
+        }
+        const size_t begin = header.find('\'', header.find(':', keyPos));
+        const size_t end = begin == std::string::npos ? begin : header.find('\'', begin + 1);
+        if (end == std::string::npos)
+        {
+            return {};
+        }
+        return header.substr(begin + 1, end - begin - 1);
+    }
+
+    int fseek64(int64_t offset)
+    {
+#ifdef _WIN32
+        return _fseeki64(file, offset, SEEK_SET);
+#else
+        return fseeko(file, off_t(offset), SEEK_SET);
+#endif
+    }
+
+    FILE* file;
+    std::string descr;
+    int64_t dataOffset;
+    int64_t length;
+    int itemSize;
+};
+
+class NpyWriter
+{
+public:
+    NpyWriter() : file(nullptr), length(0) {}
+    ~NpyWriter() { close(); }
+
+    NpyWriter(const NpyWriter&) = delete;
+    NpyWriter& operator=(const NpyWriter&) = delete;
+
+    /** Creates an empty array of the given type (e.g. "<i8"). Returns false if the file can't be created. */
+    bool open(const std::string& path, const char* type)
+    {
+        close();
+
+        file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        descr = type;
+        length = 0;
+        return writeHeader();
+    }
+
+    /** Appends elements */
+    template <typename T>
+    void write(const T* values, size_t count)
+    {
+        std::fwrite(values, sizeof(T), count, file);
+        length += int64_t(count);
+    }
+
+    template <typename T>
+    void write(T value)
+    {
+        write(&value, 1);
+    }
+
+    /** Completes the header with the number of elements written and closes the file. */
+    bool close()
+    {
+        if (file == nullptr)
+        {
+            return true;
+        }
+
+        bool ok = std::fseek(file, 0, SEEK_SET) == 0 && writeHeader();
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+private:
+    static const int HEADER_SIZE = 128; // including the preamble; a multiple of 64 as numpy writes it
+
+    bool writeHeader()
+    {
+        char header[HEADER_SIZE];
+        std::memset(header, ' ', HEADER_SIZE);
+        std::memcpy(header, "\x93NUMPY\x01\x00", 8);
+        header[8] = char(HEADER_SIZE - 10);
+        header[9] = 0;
+
+        const int n = std::snprintf(header + 10, HEADER_SIZE - 10, "{'descr': '%s', 'fortran_order': False, 'shape': (%lld,), }",
+            descr.c_str(), (long long) length);
+        header[10 + n] = ' ';
+        header[HEADER_SIZE - 1] = '\n';
+
+        return std::fwrite(header, 1, HEADER_SIZE, file) == HEADER_SIZE;
+    }
+
+    FILE* file;
+    std::string descr;
+    int64_t length;
+};
+
+#endif // NPY_FILE_H_INCLUDED
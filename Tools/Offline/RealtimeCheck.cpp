@@ -0,0 +1,464 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+The rt-check command: checks the engine's real-time contract (see CrossingEngine.h), that
+process() doesn't allocate or free memory once start() has reserved for the largest buffer.
+
+This file replaces the global operator new and delete of the tool, counting the calls made on
+the processing thread while process() runs. A list of scenarios covers every threshold type,
+the input filter, decimation, voting, early decisions, the jump limit, hysteresis and the buffer
+end mask, and changes of the settings during processing (applied with the engine's update
+functions, as the plugin does between buffers). Each scenario runs on noise with spikes and a
+slow oscillation, in buffers of random sizes up to the reserved size; the first buffer after
+the start and after each change is of the reserved size. Any allocation fails the scenario.
+
+Aligned allocations and malloc() are not counted; the engine uses neither.
+*/
+
+#include "Commands.h"
+#include "CrossingEngine.h"
+#include "DetectorOptions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // counted on the thread that runs process(), while 'armed'
+    thread_local bool armed = false;
+    std::atomic<long long> numAllocations(0);
+    std::atomic<long long> numFrees(0);
+    std::atomic<size_t> lastAllocationSize(0);
+    bool abortOnAllocation = false;
+
+    void noteAllocation(size_t size)
+    {
+        if (armed)
+        {
+            numAllocations.fetch_add(1, std::memory_order_relaxed);
+            lastAllocationSize.store(size, std::memory_order_relaxed);
+            if (abortOnAllocation)
+            {
+                // stop where it happens, for a debugger or a core dump
+                std::abort();
+            }
+        }
+    }
+
+    void noteFree(void* p)
+    {
+        if (armed && p != nullptr)
+        {
+            numFrees.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void* allocate(size_t size)
+    {
+        noteAllocation(size);
+        return std::malloc(size > 0 ? size : 1);
+    }
+}
+
+void* operator new(size_t size)
+{
+    if (void* p = allocate(size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    if (void* p = allocate(size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    noteFree(p);
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    noteFree(p);
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    noteFree(p);
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    noteFree(p);
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    noteFree(p);
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    noteFree(p);
+    std::free(p);
+}
+
+namespace
+{
+    const float sampleRate = 30000.0f;
+
+    /** Settings of a scenario, by the plugin's parameter names, and those changed halfway through */
+    struct Scenario
+    {
+        const char* name;
+        std::vector<std::string> settings;
+        std::vector<std::string> changes;
+    };
+
+    /** "Channel=1,2,...,n" */
+    std::string allChannels(int numChannels)
+    {
+        std::string list = "Channel=";
+        for (int c = 1; c <= numChannels; ++c)
+        {
+            list += (c > 1 ? "," : "") + std::to_string(c);
+        }
+        return list;
+    }
+
+    std::vector<Scenario> getScenarios(int numChannels)
+    {
+        const std::string moreChannels = allChannels(std::min(64, 2 * numChannels));
+
+        return {
+            { "constant threshold", {}, {} },
+            { "both directions, timeout 0", { "Rising=true", "Timeout_ms=0", "constant_threshold=-20" }, {} },
+            { "random thresholds", { "threshold_type=1", "min_random_threshold=-80", "max_random_threshold=-20" }, {} },
+            { "threshold channel", { "threshold_type=2" }, {} },
+            { "adaptive threshold (RMS)", { "threshold_type=3", "adaptive_estimator=0" }, {} },
+            { "adaptive threshold (mean |x|)", { "threshold_type=3", "adaptive_estimator=1" }, {} },
+            { "adaptive threshold (median |x|)", { "threshold_type=3", "adaptive_estimator=2", "adaptive_update=10",
+                "adaptive_multiplier=2" }, {} },
+            { "phase", { "threshold_type=4", "phase_freq=10", "phase_bandwidth=4", "phase_target=180",
+                "Rising=true" }, {} },
+            { "high-pass filter", { "prefilter_type=1", "prefilter_order=4" }, {} },
+            { "band-pass filter", { "prefilter_type=2", "prefilter_order=8", "constant_threshold=-20" }, {} },
+            { "decimation, threshold channel", { "decimation=4", "threshold_type=2" }, {} },
+            { "voting", { "constant_threshold=0", "past_span=30", "future_span=30", "past_strict=0.5",
+                "future_strict=0.5" }, {} },
+            { "voting, early decision", { "constant_threshold=0", "past_span=30", "future_span=3000",
+                "future_strict=0.5", "early_decision=true" }, {} },
+            { "jump limit, hysteresis", { "use_jump_limit=true", "jump_limit=50", "jump_limit_sleep=0.01",
+                "use_hysteresis=true", "hysteresis=20" }, {} },
+            { "buffer end mask, long events", { "use_buffer_end_mask=true", "buffer_end_mask=5",
+                "event_duration=500" }, {} },
+            { "change: longer spans", {}, { "past_span=6000", "future_span=6000" } },
+            { "change: shorter timeout", { "Timeout_ms=1000" }, { "Timeout_ms=0", "Rising=true", "constant_threshold=-20" } },
+            { "change: more channels", { "Channel=1" }, { moreChannels } },
+            { "change: less decimation", { "decimation=8", "threshold_type=2" }, { "decimation=1" } },
+            { "change: threshold type", { "threshold_type=0" }, { "threshold_type=3", "adaptive_estimator=2", "adaptive_multiplier=2" } },
+        };
+    }
+
+    /** Noise (sd 10) with spikes (-100, about 20 per second) on a 10 Hz oscillation (amplitude 30) */
+    std::vector<std::vector<float>> makeSignal(int numChannels, int length, unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::normal_distribution<float> noise(0.0f, 10.0f);
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        const double twoPi = 2.0 * std::acos(-1.0);
+
+        std::vector<std::vector<float>> signal((size_t) numChannels, std::vector<float>((size_t) length));
+        for (int c = 0; c < numChannels; ++c)
+        {
+            const double phase = twoPi * uniform(random);
+            for (int i = 0; i < length; ++i)
+            {
+                float& x = signal[size_t(c)][size_t(i)];
+                x = noise(random) + 30.0f * float(std::sin(twoPi * 10.0 * i / sampleRate + phase));
+                if (uniform(random) < 20.0f / sampleRate)
+                {
+                    x -= 100.0f;
+                }
+            }
+        }
+        return signal;
+    }
+
+    bool setAll(DetectorOptions& options, const std::vector<std::string>& assignments)
+    {
+        for (const std::string& assignment : assignments)
+        {
+            std::string error;
+            if (!options.set(assignment, error))
+            {
+                std::fprintf(stderr, "rt-check: %s\n", error.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Applies changed settings between buffers, with all the update functions the plugin may call */
+    void applyChanges(CrossingEngine& engine, const DetectorOptions& options)
+    {
+        const bool moreChannels = int(options.channels.size()) != engine.getNumChannels();
+        const bool newThresholdType = options.settings.thresholdType != engine.settings.thresholdType;
+
+        engine.settings = options.settings;
+        if (moreChannels)
+        {
+            engine.setChannels(int(options.channels.size()));
+        }
+        engine.updateDecimators();
+        engine.updateSampleRateDependentValues();
+        engine.updatePrefilters();
+        engine.updatePhaseEstimators();
+        engine.resetDetectors();
+        if (newThresholdType && options.settings.thresholdType == RANDOM)
+        {
+            engine.resetRandomThresh();
+        }
+    }
+
+    /** Result of one scenario */
+    struct Outcome
+    {
+        long long events;
+        long long allocations;
+        long long frees;
+        int firstBuffer;        // in which something was allocated or freed, or -1
+        int firstBufferSize;
+        size_t allocationSize;  // of the last allocation
+    };
+
+    Outcome run(const Scenario& scenario, int numChannels, const std::vector<std::vector<float>>& signal,
+        const std::vector<float>& threshold, int maxBuffer, unsigned seed, bool& valid)
+    {
+        Outcome outcome{ 0, 0, 0, -1, 0, 0 };
+
+        DetectorOptions options;
+        valid = setAll(options, { allChannels(numChannels), "Rising=false", "Falling=true",
+            "constant_threshold=-50", "Timeout_ms=1", "event_duration=2", "adaptive_calibration=100" })
+            && setAll(options, scenario.settings);
+        if (!valid)
+        {
+            return outcome;
+        }
+
+        CrossingEngine engine;
+        options.apply(engine, sampleRate);
+        engine.start(maxBuffer);
+
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> bufferSizes(1, maxBuffer);
+
+        const int length = int(threshold.size());
+        std::vector<const float*> inputs(signal.size());
+        bool changed = scenario.changes.empty();
+        bool fullBuffer = true;
+
+        int pos = 0;
+        for (int buffer = 0; pos < length; ++buffer)
+        {
+            if (!changed && pos >= length / 2)
+            {
+                valid = setAll(options, scenario.changes);
+                if (!valid)
+                {
+                    return outcome;
+                }
+                applyChanges(engine, options);
+                changed = true;
+                fullBuffer = true;
+            }
+
+            const int size = std::min(fullBuffer ? maxBuffer : bufferSizes(random), length - pos);
+            fullBuffer = false;
+            for (size_t k = 0; k < options.channels.size(); ++k)
+            {
+                inputs[k] = signal[size_t(options.channels[k]) % signal.size()].data() + pos;
+            }
+
+            const long long allocationsBefore = numAllocations.load();
+            const long long freesBefore = numFrees.load();
+
+            armed = true;
+            engine.process(inputs.data(), threshold.data() + pos, size, pos);
+            armed = false;
+
+            if (outcome.firstBuffer < 0 && (numAllocations.load() != allocationsBefore || numFrees.load() != freesBefore))
+            {
+                outcome.firstBuffer = buffer;
+                outcome.firstBufferSize = size;
+            }
+            outcome.events += (long long) engine.getEvents().size();
+            pos += size;
+        }
+
+        engine.stop();
+        return outcome;
+    }
+
+    void printRealtimeCheckUsage()
+    {
+        std::fprintf(stderr,
+            "usage: crossing-detector-tool rt-check [options]\n"
+            "\n"
+            "Checks that the detector doesn't allocate memory while processing buffers of up to the\n"
+            "size it was started with, for each threshold type and option and with settings changed\n"
+            "during processing. Exits with 1 if it does.\n"
+            "\n"
+            "  --channels <n>     monitored channels (default: 16)\n"
+            "  --buffer <n>       largest buffer, reserved when starting (default: 4096)\n"
+            "  --seconds <s>      length of the signal of each scenario, at 30 kHz (default: 2)\n"
+            "  --seed <n>         seed of the signal and the buffer sizes (default: 1)\n"
+            "  --abort            abort at the first allocation (to see where it is in a debugger)\n");
+    }
+}
+
+int runRealtimeCheck(int argc, const char* const* argv)
+{
+    int numChannels = 16;
+    int maxBuffer = 4096;
+    double seconds = 2.0;
+    unsigned seed = 1;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+        {
+            printRealtimeCheckUsage();
+            return 0;
+        }
+        if (std::strcmp(arg, "--abort") == 0)
+        {
+            abortOnAllocation = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            std::fprintf(stderr, "rt-check: missing value for %s\n\n", arg);
+            printRealtimeCheckUsage();
+            return 2;
+        }
+
+        const char* value = argv[++i];
+        if (std::strcmp(arg, "--channels") == 0) numChannels = std::max(1, std::min(64, std::atoi(value)));
+        else if (std::strcmp(arg, "--buffer") == 0) maxBuffer = std::max(1, std::atoi(value));
+        else if (std::strcmp(arg, "--seconds") == 0) seconds = std::atof(value);
+        else if (std::strcmp(arg, "--seed") == 0) seed = unsigned(std::strtoul(value, nullptr, 10));
+        else
+        {
+            std::fprintf(stderr, "rt-check: unexpected argument: %s\n\n", arg);
+            printRealtimeCheckUsage();
+            return 2;
+        }
+    }
+
+    const int length = std::max(1, int(seconds * sampleRate));
+    const std::vector<Scenario> scenarios = getScenarios(numChannels);
+
+    // enough channels for the scenarios that add some, and a slow threshold channel
+    const std::vector<std::vector<float>> signal = makeSignal(std::min(64, 2 * numChannels), length, seed);
+    std::vector<float> threshold((size_t) length);
+    for (int i = 0; i < length; ++i)
+    {
+        threshold[size_t(i)] = -40.0f + 20.0f * float(std::sin(2.0 * std::acos(-1.0) * i / sampleRate));
+    }
+
+    std::printf("%d channels at %g Hz, %g s per scenario in buffers of up to %d samples\n\n",
+        numChannels, double(sampleRate), seconds, maxBuffer);
+
+    int numFailed = 0;
+    for (size_t s = 0; s < scenarios.size(); ++s)
+    {
+        bool valid = true;
+        const long long allocationsBefore = numAllocations.load();
+        const long long freesBefore = numFrees.load();
+        Outcome outcome = run(scenarios[s], numChannels, signal, threshold, maxBuffer, seed + unsigned(s), valid);
+        if (!valid)
+        {
+            return 2;
+        }
+        outcome.allocations = numAllocations.load() - allocationsBefore;
+        outcome.frees = numFrees.load() - freesBefore;
+        outcome.allocationSize = lastAllocationSize.load();
+
+        std::printf("%-34s %9lld events  ", scenarios[s].name, outcome.events);
+        if (outcome.firstBuffer < 0)
+        {
+            std::printf("ok\n");
+            continue;
+        }
+
+        ++numFailed;
+        std::printf("FAILED: %lld allocations, %lld frees, from buffer %d (%d samples)",
+            outcome.allocations, outcome.frees, outcome.firstBuffer, outcome.firstBufferSize);
+        if (outcome.allocations > 0)
+        {
+            std::printf(", last of %zu bytes", outcome.allocationSize);
+        }
+        std::printf("\n");
+    }
+
+    if (numFailed > 0)
+    {
+        std::printf("\n%d of %zu scenarios allocated while processing\n", numFailed, scenarios.size());
+        return 1;
+    }
+
+    std::printf("\nno allocations while processing in %zu scenarios\n", scenarios.size());
+    return 0;
+}
@@ -0,0 +1,192 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ReferenceEvents.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <numeric>
+
+double ReferenceEvents::Score::getF1() const
+{
+    const double denominator = double(2 * hits + (numReference - hits) + falseAlarms);
+    return denominator > 0 ? 2 * hits / denominator : 0.0;
+}
+
+ReferenceEvents::ReferenceEvents() : withChannels(false) {}
+
+bool ReferenceEvents::load(const std::string& path, std::string& error)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        error = "can't open " + path;
+        return false;
+    }
+
+    std::vector<int64_t> samples;
+    std::vector<int> chans;
+    int numWithChannel = 0;
+
+    std::string line;
+    for (int lineNumber = 1; std::getline(in, line); ++lineNumber)
+    {
+        line = line.substr(0, line.find('#'));
+        for (char& c : line)
+        {
+            c = c == ',' || c == ';' ? ' ' : c;
+        }
+
+        const char* text = line.c_str();
+        char* end = nullptr;
+        const double sample = std::strtod(text, &end);
+        if (end == text)
+        {
+            continue; // empty, or a header
+        }
+
+        text = end;
+        const double channel = std::strtod(text, &end);
+        if (end != text)
+        {
+            if (channel < 1)
+            {
+                error = path + ":" + std::to_string(lineNumber) + ": channels start from 1";
+                return false;
+            }
+            ++numWithChannel;
+        }
+
+        samples.push_back(int64_t(sample));
+        chans.push_back(end != text ? int(channel) - 1 : -1);
+    }
+
+    if (numWithChannel != 0 && numWithChannel != int(samples.size()))
+    {
+        error = path + ": either all events or none must have a channel";
+        return false;
+    }
+
+    std::vector<size_t> order(samples.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+        { return chans[a] != chans[b] ? chans[a] < chans[b] : samples[a] < samples[b]; });
+
+    sampleNumbers.clear();
+    channels.clear();
+    for (size_t i : order)
+    {
+        sampleNumbers.push_back(samples[i]);
+        channels.push_back(chans[i]);
+    }
+    withChannels = numWithChannel > 0;
+    return true;
+}
+
+int64_t ReferenceEvents::count(const std::vector<int>& monitoredChannels) const
+{
+    if (!withChannels)
+    {
+        return int64_t(channels.size());
+    }
+
+    std::vector<int> unique(monitoredChannels);
+    std::sort(unique.begin(), unique.end());
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+    int64_t total = 0;
+    for (int channel : unique)
+    {
+        const auto range = std::equal_range(channels.begin(), channels.end(), channel);
+        total += int64_t(range.second - range.first);
+    }
+    return total;
+}
+
+ReferenceEvents::Score ReferenceEvents::score(std::vector<Detection>& detections,
+    const std::vector<int>& monitoredChannels, int64_t tolerance) const
+{
+    Score result = {};
+
+    // without channels, all detections are matched to the same events
+    auto groupOf = [this](int channel) { return withChannels ? channel : -1; };
+
+    std::vector<int> groups;
+    for (int channel : monitoredChannels)
+    {
+        groups.push_back(groupOf(channel));
+    }
+    std::sort(groups.begin(), groups.end());
+    groups.erase(std::unique(groups.begin(), groups.end()), groups.end());
+
+    std::sort(detections.begin(), detections.end(), [&](const Detection& a, const Detection& b)
+        {
+            const int ga = groupOf(a.channel);
+            const int gb = groupOf(b.channel);
+            return ga != gb ? ga < gb : a.crossingPoint < b.crossingPoint;
+        });
+
+    double latencySum = 0;
+    auto detection = detections.begin();
+
+    for (int group : groups)
+    {
+        const auto range = std::equal_range(channels.begin(), channels.end(), group);
+        const int64_t* refs = sampleNumbers.data() + (range.first - channels.begin());
+        const size_t numRefs = size_t(range.second - range.first);
+        result.numReference += int64_t(numRefs);
+
+        size_t next = 0;
+        const int64_t* lastHit = nullptr;
+
+        for (; detection != detections.end() && groupOf(detection->channel) == group; ++detection)
+        {
+            const int64_t crossing = detection->crossingPoint;
+            while (next < numRefs && refs[next] < crossing - tolerance)
+            {
+                ++next;
+            }
+
+            if (next < numRefs && refs[next] <= crossing + tolerance)
+            {
+                lastHit = &refs[next++];
+                const int64_t latency = detection->available - *lastHit;
+                ++result.hits;
+                latencySum += double(latency);
+                result.maxLatency = result.hits == 1 ? latency : std::max(result.maxLatency, latency);
+            }
+            else if (!withChannels && lastHit != nullptr && std::abs(crossing - *lastHit) <= tolerance)
+            {
+                ++result.duplicates;
+            }
+            else
+            {
+                ++result.falseAlarms;
+            }
+        }
+    }
+
+    result.meanLatency = result.hits > 0 ? latencySum / double(result.hits) : 0.0;
+    return result;
+}
@@ -0,0 +1,93 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef REFERENCE_EVENTS_H_INCLUDED
+#define REFERENCE_EVENTS_H_INCLUDED
+
+/*
+Labelled events of a recording (e.g. spikes marked by hand or found by a spike sorter), to score
+detected events against.
+
+They are read from a text file with one event per line: its sample number and optionally the
+channel of the stream it is on (from 1), separated by a comma or white space. Lines that don't
+start with a number (such as a header) and anything after a '#' are ignored. Without channels,
+an event may be detected on any of the monitored channels.
+*/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ReferenceEvents
+{
+public:
+    ReferenceEvents();
+
+    /** A detected event */
+    struct Detection
+    {
+        int64_t crossingPoint;  // sample number of the crossing
+        int64_t available;      // sample number at the end of the buffer in which it was detected
+        int channel;            // of the stream, from 0
+    };
+
+    /** How well a set of detections matches the reference events */
+    struct Score
+    {
+        int64_t numReference;   // reference events on the monitored channels
+        int64_t hits;           // reference events with a detection within the tolerance
+        int64_t falseAlarms;    // detections without a reference event
+        int64_t duplicates;     // further detections of an event that was already hit on another channel
+        double meanLatency;     // from the reference events to the end of the buffer their detection was in, in samples
+        int64_t maxLatency;
+
+        /** Harmonic mean of the fraction of reference events hit and the fraction of detections that are hits */
+        double getF1() const;
+    };
+
+    /** Reads the events from a file. Returns false (with a message in 'error') if it can't be read. */
+    bool load(const std::string& path, std::string& error);
+
+    /** Number of events */
+    size_t size() const { return sampleNumbers.size(); }
+
+    /** True if the events have channels */
+    bool hasChannels() const { return withChannels; }
+
+    /** Number of events that can be detected on the monitored channels (of the stream, from 0) */
+    int64_t count(const std::vector<int>& monitoredChannels) const;
+
+    /** Matches the detections to the reference events on the monitored channels: in order of their
+     *  crossing points, each detection takes the first event not taken yet that is within
+     *  'tolerance' samples of the crossing. Reorders the detections.
+     */
+    Score score(std::vector<Detection>& detections, const std::vector<int>& monitoredChannels, int64_t tolerance) const;
+
+private:
+    // sorted by channel, then sample number
+    std::vector<int64_t> sampleNumbers;
+    std::vector<int> channels;
+    bool withChannels;
+};
+
+#endif // REFERENCE_EVENTS_H_INCLUDED
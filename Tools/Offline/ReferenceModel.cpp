@@ -0,0 +1,90 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ReferenceModel.h"
+
+#include <cmath>
+
+namespace ReferenceModel
+{
+    // the MATLAB code works on doubles and indexes from 1; here data(i) is x[i - 1]
+    std::vector<int64_t> detect(const float* x, const float* threshold, int64_t numSamples, const Settings& settings)
+    {
+        auto data = [x](int64_t i) { return double(x[i - 1]); };
+        auto thresh = [threshold](int64_t i) { return double(threshold[i - 1]); };
+
+        auto shouldTurnOn = [&](int64_t samp, bool bRising)
+        {
+            const bool bThreshSat = (bRising == (data(samp - 1) - thresh(samp - 1) <= 0))
+                && (bRising == (data(samp) - thresh(samp) > 0));
+
+            bool bJumpSat = true;
+            if (settings.useJumpLimit)
+            {
+                bJumpSat = std::abs(data(samp) - data(samp - 1)) <= settings.jumpLimit;
+            }
+
+            bool bPastSat = true;
+            if (settings.pastSpan > 0)
+            {
+                int pastNum = 0;
+                for (int64_t j = 1; j <= settings.pastSpan; ++j)
+                {
+                    pastNum += bRising == (data(samp - 1 - j) - thresh(samp - 1 - j) <= 0) ? 1 : 0;
+                }
+                const double pastPct = pastNum * 100.0 / settings.pastSpan;
+                bPastSat = pastPct >= settings.pastPct;
+            }
+
+            bool bFutureSat = true;
+            if (settings.futureSpan > 0)
+            {
+                int futureNum = 0;
+                for (int64_t j = 1; j <= settings.futureSpan; ++j)
+                {
+                    futureNum += bRising == (data(samp + j) - thresh(samp + j) > 0) ? 1 : 0;
+                }
+                const double futurePct = futureNum * 100.0 / settings.futureSpan;
+                bFutureSat = futurePct >= settings.futurePct;
+            }
+
+            return bThreshSat && bJumpSat && bPastSat && bFutureSat;
+        };
+
+        std::vector<int64_t> eventInds;
+        int64_t kSample = settings.pastSpan + 2;
+        while (kSample <= numSamples - settings.futureSpan)
+        {
+            const bool bTurnOn = (settings.rising && shouldTurnOn(kSample, true))
+                || (settings.falling && shouldTurnOn(kSample, false));
+
+            if (bTurnOn)
+            {
+                eventInds.push_back(kSample - 1);
+                kSample = kSample + settings.timeoutSamples;
+            }
+            kSample = kSample + 1;
+        }
+        return eventInds;
+    }
+}
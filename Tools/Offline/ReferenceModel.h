@@ -0,0 +1,64 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef REFERENCE_MODEL_H_INCLUDED
+#define REFERENCE_MODEL_H_INCLUDED
+
+/*
+Reference model of the crossing detector: a direct port of Resources/simulate_cd.m, which
+defines when events should occur. It looks at the whole signal at once, sample by sample,
+without buffers, histories or any of the optimizations of the engine, so that it is easy to
+check against the MATLAB code.
+
+As in simulate_cd, a sample k is an event onset if the signal crosses the threshold between
+k - 1 and k in a selected direction, the jump across the threshold is within the jump limit,
+enough of the pastSpan samples before k - 1 are on the side the signal comes from, and enough
+of the futureSpan samples after k are on the side it goes to. After an onset, no onset is
+detected for timeoutSamples samples. The only extension is that the threshold may differ
+from sample to sample (for the engine's CHANNEL thresholds).
+*/
+
+#include <cstdint>
+#include <vector>
+
+namespace ReferenceModel
+{
+    /** The settings of simulate_cd, with the timeout in samples */
+    struct Settings
+    {
+        bool rising;
+        bool falling;
+        int timeoutSamples;
+        bool useJumpLimit;
+        double jumpLimit;
+        int pastSpan;
+        double pastPct;     // percentage of the past span needed
+        int futureSpan;
+        double futurePct;
+    };
+
+    /** Returns the indices of the event onsets in x[0, numSamples), given the threshold at each sample. */
+    std::vector<int64_t> detect(const float* x, const float* threshold, int64_t numSamples, const Settings& settings);
+}
+
+#endif // REFERENCE_MODEL_H_INCLUDED
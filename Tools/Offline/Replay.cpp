@@ -0,0 +1,372 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+The replay command: streams a recording through the detector as the plugin would have seen it
+during acquisition, and writes the events it produces.
+
+The recording is converted to float channels in large blocks, on a separate thread, while the
+engine processes the previous block in buffers of the size the GUI would have used (--buffer),
+as the events' placement and decision latencies depend on the buffer boundaries. With several
+threads, the recording is instead processed in chunks in parallel (see ChunkedDetection), with
+the same result.
+*/
+
+#include "ChunkedDetection.h"
+#include "Commands.h"
+#include "CrossingEngine.h"
+#include "DetectorOptions.h"
+#include "EventWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <vector>
+
+static void printReplayUsage()
+{
+    std::fprintf(stderr,
+        "usage: crossing-detector-tool replay <recording> [options]\n"
+        "\n"
+        "Runs the crossing detector over a recording and writes its events in the format the GUI\n"
+        "records TTL events in (states.npy, sample_numbers.npy, timestamps.npy, full_words.npy).\n"
+        "\n"
+        "%s"
+        "  --set <name>=<value>   detector parameter, named as in the plugin (repeatable)\n"
+        "  --params <file>        file of name = value lines\n"
+        "  --channels <list>      monitored channels, from 1 (same as --set Channel=<list>)\n"
+        "  --output <dir>         directory for the event files (default: crossing-detector-events)\n"
+        "  --csv <file>           also write the events with their metadata as CSV\n"
+        "  --block <samples>      samples converted at a time (default: 65536)\n"
+        "  --buffer <samples>     samples per detector buffer, as in the GUI (default: 1024;\n"
+        "                         0 = whole blocks)\n"
+        "  --threads <n>          threads to process chunks of the recording on (default: 0 = one\n"
+        "                         per core; 1 = a single sequential pass)\n"
+        "  --chunk <s>            length of the chunks (default: chosen from the recording)\n"
+        "  --warmup <ms>          data processed before each chunk to reach its starting state\n"
+        "                         (default: chosen from the parameters)\n"
+        "\n"
+        "Parameters: %s\n",
+        RecordingSource::getUsage(), DetectorOptions::getNames().c_str());
+}
+
+/** Processes the recording in one pass, converting the next block while the detector processes
+ *  the current one, and writes the events. Returns the time spent in the detector in seconds.
+ */
+static double replaySequential(BinaryRecording& recording, const DetectorOptions& options,
+    int blockSize, int bufferSize, EventWriter& writer)
+{
+    CrossingEngine engine;
+    options.apply(engine, recording.getStream().sampleRate);
+    engine.start(bufferSize);
+
+    // two sets of block buffers: one being converted while the other is processed
+    const size_t numMonitored = options.channels.size();
+    const bool useThresholdChannel = options.settings.thresholdType == CHANNEL;
+    const std::vector<int> thresholdChannels(1, options.thresholdChannel);
+    std::vector<float> storage[2];
+    std::vector<float*> channelData[2];
+    float* thresholdData[2];
+
+    for (int b = 0; b < 2; ++b)
+    {
+        storage[b].resize((numMonitored + 1) * size_t(blockSize));
+        for (size_t k = 0; k < numMonitored; ++k)
+        {
+            channelData[b].push_back(storage[b].data() + k * size_t(blockSize));
+        }
+        thresholdData[b] = storage[b].data() + numMonitored * size_t(blockSize);
+    }
+
+    auto convert = [&](int b, int64_t start, int count)
+    {
+        recording.read(options.channels, start, count, channelData[b].data());
+        if (useThresholdChannel)
+        {
+            recording.read(thresholdChannels, start, count, &thresholdData[b]);
+        }
+    };
+
+    const int64_t numSamples = recording.getNumSamples();
+    const int64_t firstSampleNumber = recording.getFirstSampleNumber();
+    std::vector<const float*> input(numMonitored);
+    std::vector<CrossingEngine::Event> ordered;
+    double processSeconds = 0;
+
+    std::future<void> nextBlock;
+    if (numSamples > 0)
+    {
+        nextBlock = std::async(std::launch::async, convert, 0, int64_t(0), int(std::min<int64_t>(blockSize, numSamples)));
+    }
+
+    for (int64_t blockStart = 0, block = 0; blockStart < numSamples; blockStart += blockSize, ++block)
+    {
+        const int b = int(block % 2);
+        const int blockCount = int(std::min<int64_t>(blockSize, numSamples - blockStart));
+        nextBlock.get();
+
+        const int64_t nextStart = blockStart + blockCount;
+        if (nextStart < numSamples)
+        {
+            nextBlock = std::async(std::launch::async, convert, 1 - b, nextStart,
+                int(std::min<int64_t>(blockSize, numSamples - nextStart)));
+        }
+
+        const auto processStart = std::chrono::steady_clock::now();
+
+        for (int offset = 0; offset < blockCount; offset += bufferSize)
+        {
+            const int count = std::min(bufferSize, blockCount - offset);
+            for (size_t k = 0; k < numMonitored; ++k)
+            {
+                input[k] = channelData[b][k] + offset;
+            }
+
+            engine.process(input.data(), thresholdData[b] + offset, count, firstSampleNumber + blockStart + offset);
+
+            ordered.clear();
+            ChunkedDetection::appendEvents(engine, ordered);
+            for (const CrossingEngine::Event& event : ordered)
+            {
+                writer.write(event, options.getEventLine(event.channel), recording.getTimestamp(event.sampleNumber));
+            }
+        }
+
+        processSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - processStart).count();
+    }
+
+    return processSeconds;
+}
+
+int runReplay(int argc, const char* const* argv)
+{
+    RecordingSource source;
+    DetectorOptions options;
+    std::string outputDir = "crossing-detector-events";
+    std::string csvPath;
+    int blockSize = 65536;
+    int bufferSize = 1024;
+    int numThreads = 0;
+    double chunkSeconds = 0;
+    double warmupMs = -1;
+    std::string error;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        const bool hasValue = value != nullptr;
+
+        if (source.parseOption(argc, argv, i, error))
+        {
+            if (!error.empty())
+            {
+                break;
+            }
+        }
+        else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+        {
+            printReplayUsage();
+            return 0;
+        }
+        else if (arg[0] == '-' && arg[1] == '-' && !hasValue)
+        {
+            error = std::string("missing value for ") + arg;
+            break;
+        }
+        else if (std::strcmp(arg, "--set") == 0)
+        {
+            if (!options.set(argv[++i], error))
+            {
+                break;
+            }
+        }
+        else if (std::strcmp(arg, "--params") == 0)
+        {
+            if (!options.load(argv[++i], error))
+            {
+                break;
+            }
+        }
+        else if (std::strcmp(arg, "--channels") == 0)
+        {
+            if (!options.set("Channel", argv[++i], error))
+            {
+                break;
+            }
+        }
+        else if (std::strcmp(arg, "--output") == 0)
+        {
+            outputDir = argv[++i];
+        }
+        else if (std::strcmp(arg, "--csv") == 0)
+        {
+            csvPath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--block") == 0)
+        {
+            blockSize = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(arg, "--buffer") == 0)
+        {
+            bufferSize = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(arg, "--threads") == 0)
+        {
+            numThreads = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(arg, "--chunk") == 0)
+        {
+            chunkSeconds = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(arg, "--warmup") == 0)
+        {
+            warmupMs = std::atof(argv[++i]);
+        }
+        else if (arg[0] != '-' && source.path.empty())
+        {
+            source.path = arg;
+        }
+        else
+        {
+            error = std::string("unexpected argument: ") + arg;
+            break;
+        }
+    }
+
+    if (error.empty() && blockSize <= 0)
+    {
+        error = "--block must be positive";
+    }
+    if (!error.empty())
+    {
+        std::fprintf(stderr, "replay: %s\n\n", error.c_str());
+        printReplayUsage();
+        return 2;
+    }
+
+    BinaryRecording recording;
+    if (!source.open(recording, error))
+    {
+        std::fprintf(stderr, "replay: %s\n", error.c_str());
+        return 1;
+    }
+
+    const BinaryRecording::Stream& stream = recording.getStream();
+
+    for (int channel : options.channels)
+    {
+        if (channel >= stream.numChannels)
+        {
+            std::fprintf(stderr, "replay: channel %d is not in the stream, which has %d channels\n",
+                channel + 1, stream.numChannels);
+            return 1;
+        }
+    }
+    if (options.settings.thresholdType == CHANNEL && (options.thresholdChannel < 0 || options.thresholdChannel >= stream.numChannels))
+    {
+        std::fprintf(stderr, "replay: threshold channel %d is not in the stream\n", options.thresholdChannel);
+        return 1;
+    }
+    const std::string filterError = CrossingEngine::checkPrefilter(options.settings, stream.sampleRate);
+    if (!filterError.empty())
+    {
+        std::fprintf(stderr, "replay: %s\n", filterError.c_str());
+        return 1;
+    }
+
+    // blocks hold whole buffers, so that the buffers don't depend on the block size
+    if (bufferSize <= 0 || bufferSize > blockSize)
+    {
+        bufferSize = blockSize;
+    }
+    blockSize -= blockSize % bufferSize;
+
+    EventWriter writer;
+    if (!writer.open(outputDir, csvPath, error))
+    {
+        std::fprintf(stderr, "replay: %s\n", error.c_str());
+        return 1;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    double processSeconds = 0;
+    int numChunks = 1;
+    int numRepeated = 0;
+
+    if (numThreads == 1)
+    {
+        processSeconds = replaySequential(recording, options, blockSize, bufferSize, writer);
+    }
+    else
+    {
+        ChunkedDetection detection;
+        detection.numThreads = numThreads;
+        detection.bufferSize = bufferSize;
+        detection.chunkSize = int64_t(chunkSeconds * stream.sampleRate);
+        detection.warmup = warmupMs >= 0 ? int64_t(warmupMs * stream.sampleRate / 1000.0) : -1;
+
+        for (const CrossingEngine::Event& event : detection.run(recording, options))
+        {
+            writer.write(event, options.getEventLine(event.channel), recording.getTimestamp(event.sampleNumber));
+        }
+        numChunks = detection.getNumChunks();
+        numRepeated = detection.getNumRepeated();
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    if (!writer.close())
+    {
+        std::fprintf(stderr, "replay: could not write all events to %s\n", outputDir.c_str());
+        return 1;
+    }
+
+    const int64_t numSamples = recording.getNumSamples();
+    const double recordedSeconds = double(numSamples) / stream.sampleRate;
+    std::printf("%s: %lld samples x %d channels (%.1f s) in %.3f s, %.1f Msamples/s per channel, %.0fx real time\n",
+        stream.name.c_str(), (long long) numSamples, int(options.channels.size()), recordedSeconds, seconds,
+        seconds > 0 ? numSamples / seconds / 1e6 : 0.0, seconds > 0 ? recordedSeconds / seconds : 0.0);
+
+    if (numThreads == 1)
+    {
+        std::printf("detection: %.3f s, waiting for data: %.3f s\n", processSeconds, seconds - processSeconds);
+    }
+    else
+    {
+        std::printf("%d chunks, %d of them (%.0f%%) processed again from the preceding state\n",
+            numChunks, numRepeated, 100.0 * numRepeated / numChunks);
+
+        // the repeated chunks are processed one after the other, so most of the parallel work was wasted
+        if (numChunks > 2 && 2 * numRepeated >= numChunks)
+        {
+            std::printf("most chunks depend on the detector's state before their warm-up (e.g. a timeout that\n"
+                        "is rearmed by every crossing, or an input filter); --threads 1 avoids the wasted work\n");
+        }
+    }
+    std::printf("%lld events written to %s\n", (long long) writer.getNumEvents(), outputDir.c_str());
+    return 0;
+}
@@ -0,0 +1,701 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+The sweep command: runs many configurations of the detector over a recording, to tune the
+crossing criteria (spans, strictness, jump limit, timeout, ...) offline.
+
+Each varied parameter takes a list of values and ranges; every combination of them is run (a
+grid search), or a random sample of the combinations (--random). The recording is converted
+once, a block at a time, and all configurations process that block in buffers of the GUI's
+size: each thread takes every n-th configuration and runs them buffer by buffer, so that the
+buffer is still in its cache for the next configuration. The configurations are then ranked by
+how well their events match labelled reference events (--reference), or without those, by the
+latency of their decisions.
+*/
+
+#include "Commands.h"
+#include "CrossingEngine.h"
+#include "DetectorOptions.h"
+#include "ReferenceEvents.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+static void printSweepUsage()
+{
+    std::fprintf(stderr,
+        "usage: crossing-detector-tool sweep <recording> --vary <name>=<values> [options]\n"
+        "\n"
+        "Runs the detector over a recording with every combination of the varied parameters, and\n"
+        "ranks the configurations by how well their events match a file of reference events.\n"
+        "\n"
+        "%s"
+        "  --set <name>=<value>   parameter shared by all configurations (repeatable)\n"
+        "  --params <file>        file of name = value lines\n"
+        "  --channels <list>      monitored channels, from 1 (same as --set Channel=<list>)\n"
+        "  --vary <name>=<values> parameter to vary (repeatable): a comma-separated list of values\n"
+        "                         and from:to:step ranges, e.g. past_span=0,5:20:5\n"
+        "  --random <n>           run n combinations drawn at random instead of all of them\n"
+        "  --search-seed <n>      seed of the random draw (default: 1)\n"
+        "  --reference <file>     events to score against: a sample number and optionally a\n"
+        "                         channel (from 1) per line\n"
+        "  --tolerance <ms>       distance from a reference event within which a crossing hits it\n"
+        "                         (default: 1)\n"
+        "  --max-events <n>       stop configurations with more events than this (default: ten\n"
+        "                         times the number of reference events, if there are any)\n"
+        "  --top <n>              configurations listed (default: 20; 0 = all)\n"
+        "  --csv <file>           write all configurations and their scores as CSV\n"
+        "  --threads <n>          threads to run the configurations on (default: 0 = one per core)\n"
+        "  --block <samples>      samples converted at a time (default: 65536)\n"
+        "  --buffer <samples>     samples per detector buffer, as in the GUI (default: 1024)\n"
+        "\n"
+        "Parameters: %s\n",
+        RecordingSource::getUsage(), DetectorOptions::getNames().c_str());
+}
+
+/** A varied parameter and its values (as text, as they are passed to DetectorOptions) */
+struct Axis
+{
+    std::string name;
+    std::vector<std::string> values;
+};
+
+static std::string formatValue(double value)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.6g", value);
+    return text;
+}
+
+/** Parses "name=a,b,from:to:step,..." */
+static bool parseAxis(const std::string& text, Axis& axis, std::string& error)
+{
+    const size_t equals = text.find('=');
+    if (equals == std::string::npos || equals == 0)
+    {
+        error = "expected --vary name=values: " + text;
+        return false;
+    }
+    axis.name = text.substr(0, equals);
+
+    for (const char* fixed : { "Channel", "threshold_chan", "TTL_OUT" })
+    {
+        if (axis.name.size() == std::strlen(fixed) && std::equal(axis.name.begin(), axis.name.end(), fixed,
+                [](char a, char b) { return std::tolower((unsigned char) a) == std::tolower((unsigned char) b); }))
+        {
+            error = axis.name + " can't be varied, as all configurations share the same input";
+            return false;
+        }
+    }
+
+    const std::string list = text.substr(equals + 1);
+    size_t pos = 0;
+    while (pos <= list.size())
+    {
+        size_t comma = list.find(',', pos);
+        if (comma == std::string::npos)
+        {
+            comma = list.size();
+        }
+        const std::string item = list.substr(pos, comma - pos);
+        pos = comma + 1;
+
+        if (item.find(':') == std::string::npos)
+        {
+            axis.values.push_back(item);
+            continue;
+        }
+
+        double from, to, step;
+        char extra;
+        if (std::sscanf(item.c_str(), "%lf:%lf:%lf%c", &from, &to, &step, &extra) != 3 || step <= 0 || to < from)
+        {
+            error = "invalid range for " + axis.name + ": " + item + " (expected from:to:step)";
+            return false;
+        }
+        const long long numSteps = (long long) std::floor((to - from) / step + 1e-9);
+        if (numSteps > 100000)
+        {
+            error = "range for " + axis.name + " has too many values: " + item;
+            return false;
+        }
+        for (long long k = 0; k <= numSteps; ++k)
+        {
+            axis.values.push_back(formatValue(from + double(k) * step));
+        }
+    }
+
+    // check the values as the configurations will set them
+    DetectorOptions probe;
+    for (const std::string& value : axis.values)
+    {
+        if (!probe.set(axis.name, value, error))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** One configuration and what it detected */
+struct Trial
+{
+    std::vector<size_t> choice;     // value of each axis
+    DetectorOptions options;
+    CrossingEngine engine;
+
+    int64_t numEvents = 0;          // turning on
+    double latencySum = 0;          // decision latencies, in samples
+    int maxLatency = 0;
+    bool stopped = false;           // after too many events
+    std::vector<ReferenceEvents::Detection> detections;
+    ReferenceEvents::Score score = {};
+};
+
+int runSweep(int argc, const char* const* argv)
+{
+    RecordingSource source;
+    DetectorOptions options;
+    std::vector<Axis> axes;
+    std::string referencePath;
+    std::string csvPath;
+    long long numRandom = 0;
+    unsigned long long searchSeed = 1;
+    double toleranceMs = 1;
+    long long maxEvents = -1;
+    int top = 20;
+    int numThreads = 0;
+    int blockSize = 65536;
+    int bufferSize = 1024;
+    std::string error;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        const bool hasValue = value != nullptr;
+
+        if (source.parseOption(argc, argv, i, error))
+        {
+            if (!error.empty())
+            {
+                break;
+            }
+        }
+        else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+        {
+            printSweepUsage();
+            return 0;
+        }
+        else if (arg[0] == '-' && arg[1] == '-' && !hasValue)
+        {
+            error = std::string("missing value for ") + arg;
+            break;
+        }
+        else if (std::strcmp(arg, "--set") == 0)
+        {
+            if (!options.set(argv[++i], error))
+            {
+                break;
+            }
+        }
+        else if (std::strcmp(arg, "--params") == 0)
+        {
+            if (!options.load(argv[++i], error))
+            {
+                break;
+            }
+        }
+        else if (std::strcmp(arg, "--channels") == 0)
+        {
+            if (!options.set("Channel", argv[++i], error))
+            {
+                break;
+            }
+        }
+        else if (std::strcmp(arg, "--vary") == 0)
+        {
+            axes.emplace_back();
+            if (!parseAxis(argv[++i], axes.back(), error))
+            {
+                break;
+            }
+        }
+        else if (std::strcmp(arg, "--random") == 0)
+        {
+            numRandom = std::atoll(argv[++i]);
+        }
+        else if (std::strcmp(arg, "--search-seed") == 0)
+        {
+            searchSeed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--reference") == 0)
+        {
+            referencePath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--tolerance") == 0)
+        {
+            toleranceMs = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(arg, "--max-events") == 0)
+        {
+            maxEvents = std::atoll(argv[++i]);
+        }
+        else if (std::strcmp(arg, "--top") == 0)
+        {
+            top = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(arg, "--csv") == 0)
+        {
+            csvPath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--threads") == 0)
+        {
+            numThreads = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(arg, "--block") == 0)
+        {
+            blockSize = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(arg, "--buffer") == 0)
+        {
+            bufferSize = std::atoi(argv[++i]);
+        }
+        else if (arg[0] != '-' && source.path.empty())
+        {
+            source.path = arg;
+        }
+        else
+        {
+            error = std::string("unexpected argument: ") + arg;
+            break;
+        }
+    }
+
+    if (error.empty() && axes.empty())
+    {
+        error = "no parameter to vary (--vary)";
+    }
+    if (error.empty() && blockSize <= 0)
+    {
+        error = "--block must be positive";
+    }
+    if (!error.empty())
+    {
+        std::fprintf(stderr, "sweep: %s\n\n", error.c_str());
+        printSweepUsage();
+        return 2;
+    }
+
+    ReferenceEvents reference;
+    const bool useReference = !referencePath.empty();
+    if (useReference && !reference.load(referencePath, error))
+    {
+        std::fprintf(stderr, "sweep: %s\n", error.c_str());
+        return 1;
+    }
+
+    BinaryRecording recording;
+    if (!source.open(recording, error))
+    {
+        std::fprintf(stderr, "sweep: %s\n", error.c_str());
+        return 1;
+    }
+
+    const BinaryRecording::Stream& stream = recording.getStream();
+    for (int channel : options.channels)
+    {
+        if (channel >= stream.numChannels)
+        {
+            std::fprintf(stderr, "sweep: channel %d is not in the stream, which has %d channels\n",
+                channel + 1, stream.numChannels);
+            return 1;
+        }
+    }
+    if (options.settings.thresholdType == CHANNEL && (options.thresholdChannel < 0 || options.thresholdChannel >= stream.numChannels))
+    {
+        std::fprintf(stderr, "sweep: threshold channel %d is not in the stream\n", options.thresholdChannel);
+        return 1;
+    }
+
+    if (bufferSize <= 0 || bufferSize > blockSize)
+    {
+        bufferSize = blockSize;
+    }
+    blockSize -= blockSize % bufferSize;
+
+    // the combinations to run, as indices into the grid of all of them
+    double gridSize = 1;
+    for (const Axis& axis : axes)
+    {
+        gridSize *= double(axis.values.size());
+    }
+
+    std::vector<long long> combinations;
+    if (numRandom > 0 && double(numRandom) < gridSize)
+    {
+        std::mt19937_64 random(searchSeed);
+        std::uniform_real_distribution<double> uniform(0.0, gridSize);
+        std::set<long long> drawn;
+        while ((long long) drawn.size() < numRandom)
+        {
+            drawn.insert(std::min((long long) uniform(random), (long long) gridSize - 1));
+        }
+        combinations.assign(drawn.begin(), drawn.end());
+    }
+    else if (gridSize <= 1e6)
+    {
+        for (long long c = 0; c < (long long) gridSize; ++c)
+        {
+            combinations.push_back(c);
+        }
+    }
+    else
+    {
+        std::fprintf(stderr, "sweep: %.0f combinations are too many to run them all; draw some with --random\n", gridSize);
+        return 2;
+    }
+
+    const float sampleRate = stream.sampleRate;
+    std::vector<std::unique_ptr<Trial>> trials;
+    std::string filterError;    // of the first configuration with an unusable input filter
+    size_t numInvalid = 0;
+    for (long long c : combinations)
+    {
+        std::unique_ptr<Trial> trial(new Trial);
+        trial->options = options;
+        for (const Axis& axis : axes)
+        {
+            const size_t index = size_t(c % (long long) axis.values.size());
+            c /= (long long) axis.values.size();
+            trial->choice.push_back(index);
+            trial->options.set(axis.name, axis.values[index], error);
+        }
+
+        // e.g. a band-pass whose cutoffs cross as both are varied
+        const std::string invalid = CrossingEngine::checkPrefilter(trial->options.settings, sampleRate);
+        if (!invalid.empty())
+        {
+            if (numInvalid++ == 0)
+            {
+                filterError = invalid;
+            }
+            continue;
+        }
+
+        trial->options.apply(trial->engine, sampleRate);
+        trial->engine.start(bufferSize);
+        trials.push_back(std::move(trial));
+    }
+
+    if (numInvalid > 0)
+    {
+        std::fprintf(stderr, "sweep: skipping %zu of %zu configurations whose input filter can't be used, e.g. %s\n",
+            numInvalid, combinations.size(), filterError.c_str());
+    }
+    if (trials.empty())
+    {
+        return 1;
+    }
+
+    // the detections are only kept to be scored
+    if (maxEvents < 0)
+    {
+        maxEvents = useReference ? 10 * (long long) reference.size() + 1000 : INT64_MAX;
+    }
+    const int64_t tolerance = int64_t(std::llround(toleranceMs * sampleRate / 1000.0));
+
+    // two sets of block buffers: one being converted while the other is processed
+    const size_t numMonitored = options.channels.size();
+    const bool useThresholdChannel = options.settings.thresholdType == CHANNEL;
+    const std::vector<int> thresholdChannels(1, options.thresholdChannel);
+    std::vector<float> storage[2];
+    std::vector<float*> channelData[2];
+    float* thresholdData[2];
+
+    for (int b = 0; b < 2; ++b)
+    {
+        storage[b].resize((numMonitored + 1) * size_t(blockSize));
+        for (size_t k = 0; k < numMonitored; ++k)
+        {
+            channelData[b].push_back(storage[b].data() + k * size_t(blockSize));
+        }
+        thresholdData[b] = storage[b].data() + numMonitored * size_t(blockSize);
+    }
+
+    auto convert = [&](int b, int64_t start, int count)
+    {
+        recording.read(options.channels, start, count, channelData[b].data());
+        if (useThresholdChannel)
+        {
+            recording.read(thresholdChannels, start, count, &thresholdData[b]);
+        }
+    };
+
+    const int threads = std::min<int>(int(trials.size()),
+        numThreads > 0 ? numThreads : int(std::max(1u, std::thread::hardware_concurrency())));
+
+    // runs every threads-th configuration, starting from 'first', over a block
+    auto work = [&](int first, int b, int64_t blockStart, int blockCount)
+    {
+        std::vector<const float*> input(numMonitored);
+
+        for (int offset = 0; offset < blockCount; offset += bufferSize)
+        {
+            const int count = std::min(bufferSize, blockCount - offset);
+            for (size_t k = 0; k < numMonitored; ++k)
+            {
+                input[k] = channelData[b][k] + offset;
+            }
+            const int64_t firstSampleNumber = recording.getFirstSampleNumber() + blockStart + offset;
+
+            for (size_t t = size_t(first); t < trials.size(); t += size_t(threads))
+            {
+                Trial& trial = *trials[t];
+                if (trial.stopped)
+                {
+                    continue;
+                }
+
+                trial.engine.process(input.data(), thresholdData[b] + offset, count, firstSampleNumber);
+
+                for (const CrossingEngine::Event& event : trial.engine.getEvents())
+                {
+                    if (!event.on)
+                    {
+                        continue;
+                    }
+                    ++trial.numEvents;
+                    trial.latencySum += event.latency;
+                    trial.maxLatency = std::max(trial.maxLatency, event.latency);
+
+                    if (useReference)
+                    {
+                        trial.detections.push_back({ event.crossingPoint, event.crossingPoint + event.latency,
+                            options.channels[size_t(event.channel)] });
+                    }
+                }
+
+                if (trial.numEvents > maxEvents)
+                {
+                    trial.stopped = true;
+                    std::vector<ReferenceEvents::Detection>().swap(trial.detections);
+                }
+            }
+        }
+    };
+
+    const auto startTime = std::chrono::steady_clock::now();
+    const int64_t numSamples = recording.getNumSamples();
+
+    std::future<void> nextBlock;
+    if (numSamples > 0)
+    {
+        nextBlock = std::async(std::launch::async, convert, 0, int64_t(0), int(std::min<int64_t>(blockSize, numSamples)));
+    }
+
+    for (int64_t blockStart = 0, block = 0; blockStart < numSamples; blockStart += blockSize, ++block)
+    {
+        const int b = int(block % 2);
+        const int blockCount = int(std::min<int64_t>(blockSize, numSamples - blockStart));
+        nextBlock.get();
+
+        const int64_t nextStart = blockStart + blockCount;
+        if (nextStart < numSamples)
+        {
+            nextBlock = std::async(std::launch::async, convert, 1 - b, nextStart,
+                int(std::min<int64_t>(blockSize, numSamples - nextStart)));
+        }
+
+        std::vector<std::future<void>> workers;
+        for (int t = 1; t < threads; ++t)
+        {
+            workers.push_back(std::async(std::launch::async, work, t, b, blockStart, blockCount));
+        }
+        work(0, b, blockStart, blockCount);
+        for (auto& worker : workers)
+        {
+            worker.get();
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // rank: by F1 score against the reference, or by latency; stopped and silent configurations last
+    std::vector<size_t> order(trials.size());
+    for (size_t t = 0; t < trials.size(); ++t)
+    {
+        order[t] = t;
+        Trial& trial = *trials[t];
+        if (useReference && !trial.stopped)
+        {
+            trial.score = reference.score(trial.detections, options.channels, tolerance);
+        }
+    }
+
+    auto meanLatency = [&](const Trial& trial)
+    {
+        if (useReference)
+        {
+            return trial.score.meanLatency;
+        }
+        return trial.numEvents > 0 ? trial.latencySum / double(trial.numEvents) : 0.0;
+    };
+
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+        {
+            const Trial& x = *trials[a];
+            const Trial& y = *trials[b];
+            if (x.stopped != y.stopped)
+            {
+                return y.stopped;
+            }
+            if (useReference && x.score.getF1() != y.score.getF1())
+            {
+                return x.score.getF1() > y.score.getF1();
+            }
+            if ((x.numEvents > 0) != (y.numEvents > 0))
+            {
+                return x.numEvents > 0;
+            }
+            return meanLatency(x) < meanLatency(y);
+        });
+
+    const double recordedMinutes = double(numSamples) / sampleRate / 60.0;
+    const double msPerSample = 1000.0 / sampleRate;
+
+    std::printf("%zu configurations x %zu channels over %.1f s of %s in %.2f s (%.0fx real time per configuration)\n",
+        trials.size(), numMonitored, recordedMinutes * 60.0, stream.name.c_str(), seconds,
+        seconds > 0 ? recordedMinutes * 60.0 * double(trials.size()) / seconds : 0.0);
+    if (useReference)
+    {
+        std::printf("%lld reference events on the monitored channels, tolerance %lld samples\n",
+            (long long) reference.count(options.channels), (long long) tolerance);
+    }
+    std::printf("\n%4s", "rank");
+    for (const Axis& axis : axes)
+    {
+        std::printf("  %*s", int(std::max<size_t>(axis.name.size(), 8)), axis.name.c_str());
+    }
+    if (useReference)
+    {
+        std::printf("  %8s  %6s  %6s  %8s", "events", "F1", "hits %", "FA/min");
+    }
+    else
+    {
+        std::printf("  %8s  %8s", "events", "per min");
+    }
+    std::printf("  %12s  %12s\n", "latency (ms)", "max (ms)");
+
+    const size_t numListed = top > 0 ? std::min(order.size(), size_t(top)) : order.size();
+    for (size_t r = 0; r < numListed; ++r)
+    {
+        const Trial& trial = *trials[order[r]];
+        std::printf("%4zu", r + 1);
+        for (size_t a = 0; a < axes.size(); ++a)
+        {
+            std::printf("  %*s", int(std::max<size_t>(axes[a].name.size(), 8)), axes[a].values[trial.choice[a]].c_str());
+        }
+
+        if (trial.stopped)
+        {
+            std::printf("  stopped after %lld events\n", (long long) trial.numEvents);
+            continue;
+        }
+        if (useReference)
+        {
+            const ReferenceEvents::Score& score = trial.score;
+            std::printf("  %8lld  %6.3f  %6.1f  %8.2f  %12.2f  %12.2f\n", (long long) trial.numEvents, score.getF1(),
+                score.numReference > 0 ? 100.0 * score.hits / score.numReference : 0.0,
+                recordedMinutes > 0 ? score.falseAlarms / recordedMinutes : 0.0,
+                score.meanLatency * msPerSample, score.maxLatency * msPerSample);
+        }
+        else
+        {
+            std::printf("  %8lld  %8.2f  %12.2f  %12.2f\n", (long long) trial.numEvents,
+                recordedMinutes > 0 ? trial.numEvents / recordedMinutes : 0.0,
+                meanLatency(trial) * msPerSample, trial.maxLatency * msPerSample);
+        }
+    }
+
+    if (!csvPath.empty())
+    {
+        FILE* csv = std::fopen(csvPath.c_str(), "w");
+        if (csv == nullptr)
+        {
+            std::fprintf(stderr, "sweep: can't create %s\n", csvPath.c_str());
+            return 1;
+        }
+
+        std::fprintf(csv, "rank");
+        for (const Axis& axis : axes)
+        {
+            std::fprintf(csv, ",%s", axis.name.c_str());
+        }
+        std::fprintf(csv, ",events,stopped,hits,misses,false_alarms,duplicates,f1,mean_latency_ms,max_latency_ms\n");
+
+        for (size_t r = 0; r < order.size(); ++r)
+        {
+            const Trial& trial = *trials[order[r]];
+            const ReferenceEvents::Score& score = trial.score;
+            const double maxLatency = useReference ? double(score.maxLatency) : double(trial.maxLatency);
+
+            std::fprintf(csv, "%zu", r + 1);
+            for (size_t a = 0; a < axes.size(); ++a)
+            {
+                std::fprintf(csv, ",%s", axes[a].values[trial.choice[a]].c_str());
+            }
+            if (useReference && !trial.stopped)
+            {
+                std::fprintf(csv, ",%lld,0,%lld,%lld,%lld,%lld,%.6f", (long long) trial.numEvents,
+                    (long long) score.hits, (long long) (score.numReference - score.hits),
+                    (long long) score.falseAlarms, (long long) score.duplicates, score.getF1());
+            }
+            else
+            {
+                std::fprintf(csv, ",%lld,%d,,,,,", (long long) trial.numEvents, trial.stopped ? 1 : 0);
+            }
+            std::fprintf(csv, ",%.6f,%.6f\n", meanLatency(trial) * msPerSample, maxLatency * msPerSample);
+        }
+
+        if (std::fclose(csv) != 0)
+        {
+            std::fprintf(stderr, "sweep: could not write %s\n", csvPath.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
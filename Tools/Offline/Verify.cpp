@@ -0,0 +1,724 @@
+/*
+------------------------------------------------------------------
+
+This file is part of a plugin for the Open Ephys GUI
+Copyright (C) 2026 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+The verify command: checks the engine against the reference model (simulate_cd) on random
+signals and settings.
+
+Each case is a short signal, made of values on a coarse grid so that samples often equal the
+threshold and each other, settings within what simulate_cd describes (constant or per-sample
+thresholds, directions, timeout, jump limit, sample voting) plus the engine's options that must
+not change which samples are onsets (early decisions, interpolation, event duration), and a
+random split of the signal into buffers. The engine must find exactly the onsets of the model.
+
+A case that doesn't is minimized: the signal is shortened, settings are reset to their simplest
+values, buffers are merged and samples zeroed, as long as the engine and the model still
+disagree. The result is printed and saved as a case file, which --case runs again.
+
+The signals run at 1000 Hz, so that timeouts in ms are a whole number of samples.
+
+The model has no decimation. Before the random cases, the crossings the engine reports with
+decimation are compared with those without it, on a smooth signal at 30 kHz, and the input
+filters that the plugin and tools reject are checked.
+*/
+
+#include "Commands.h"
+#include "CrossingEngine.h"
+#include "DetectorOptions.h"
+#include "ReferenceModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const float sampleRate = 1000.0f;
+
+    /** One input to both detectors */
+    struct Case
+    {
+        DetectorOptions options;
+        std::vector<float> signal;
+        std::vector<float> threshold;   // for CHANNEL thresholds
+        std::vector<int> buffers;       // sizes, adding up to the length of the signal
+    };
+
+    /** The reference model's settings for the engine's; strictness becomes a percentage as it
+     *  would have been typed (to 0.01%), so that e.g. 0.3 is 30% and not 30.0000012%.
+     */
+    ReferenceModel::Settings getModelSettings(const CrossingEngine::Settings& s)
+    {
+        ReferenceModel::Settings model;
+        model.rising = s.posOn;
+        model.falling = s.negOn;
+        model.timeoutSamples = int(std::lround(s.timeout * sampleRate / 1000.0));
+        model.useJumpLimit = s.useJumpLimit;
+        model.jumpLimit = s.jumpLimit;
+        model.pastSpan = s.pastSpan;
+        model.pastPct = std::round(double(s.pastStrict) * 1e4) / 100.0;
+        model.futureSpan = s.futureSpan;
+        model.futurePct = std::round(double(s.futureStrict) * 1e4) / 100.0;
+        return model;
+    }
+
+    std::vector<int64_t> runModel(const Case& c)
+    {
+        const std::vector<float> constant(c.signal.size(), c.options.settings.constantThresh);
+        const bool channel = c.options.settings.thresholdType == CHANNEL;
+        return ReferenceModel::detect(c.signal.data(), channel ? c.threshold.data() : constant.data(),
+            int64_t(c.signal.size()), getModelSettings(c.options.settings));
+    }
+
+    std::vector<int64_t> runEngine(const Case& c)
+    {
+        CrossingEngine engine;
+        c.options.apply(engine, sampleRate);
+        engine.start(c.buffers.empty() ? 1 : *std::max_element(c.buffers.begin(), c.buffers.end()));
+
+        std::vector<int64_t> onsets;
+        int pos = 0;
+        for (int size : c.buffers)
+        {
+            const float* input = c.signal.data() + pos;
+            engine.process(&input, c.threshold.data() + pos, size, pos);
+            for (const CrossingEngine::Event& event : engine.getEvents())
+            {
+                if (event.on)
+                {
+                    onsets.push_back(event.crossingPoint);
+                }
+            }
+            pos += size;
+        }
+        std::sort(onsets.begin(), onsets.end());
+
+        // simulate_cd only decides crossings whose future span is complete; with early decisions,
+        // the engine may also decide those in the last futureSpan samples
+        const int64_t decidable = int64_t(c.signal.size()) - c.options.settings.futureSpan;
+        onsets.erase(std::lower_bound(onsets.begin(), onsets.end(), decidable), onsets.end());
+        return onsets;
+    }
+
+    bool disagree(const Case& c)
+    {
+        return runModel(c) != runEngine(c);
+    }
+
+    /** Values on a grid of 0.5, around thresholds on the same grid */
+    Case generate(std::mt19937_64& random)
+    {
+        auto uniform = [&random](int from, int to) { return std::uniform_int_distribution<int>(from, to)(random); };
+        auto chance = [&random](double p) { return std::bernoulli_distribution(p)(random); };
+
+        Case c;
+        CrossingEngine::Settings& s = c.options.settings;
+        c.options.channels = { 0 };
+
+        const int length = chance(0.2) ? uniform(1, 3000) : uniform(1, 300);
+        c.signal.resize(size_t(length));
+        c.threshold.resize(size_t(length));
+
+        const int style = uniform(0, 3);
+        float level = 0;
+        for (int i = 0; i < length; ++i)
+        {
+            switch (style)
+            {
+            case 0: // white noise
+                level = 0.5f * float(uniform(-4, 4));
+                break;
+            case 1: // random walk
+                level += 0.5f * float(uniform(-1, 1));
+                break;
+            case 2: // slow oscillation with noise
+                level = 0.5f * std::round(4.0f * std::sin(float(i) * 0.2f) + float(uniform(-1, 1)));
+                break;
+            default: // flat with spikes
+                level = chance(0.05) ? 0.5f * float(uniform(-8, 8)) : 0.0f;
+                break;
+            }
+            c.signal[size_t(i)] = level;
+            c.threshold[size_t(i)] = i > 0 && chance(0.9) ? c.threshold[size_t(i - 1)] : 0.5f * float(uniform(-2, 2));
+        }
+
+        s.thresholdType = chance(0.3) ? CHANNEL : CONSTANT;
+        s.constantThresh = 0.5f * float(uniform(-2, 2));
+        s.posOn = chance(0.7);
+        s.negOn = !s.posOn || chance(0.5);
+        s.timeout = chance(0.5) ? 0 : uniform(1, 10);
+        s.useJumpLimit = chance(0.3);
+        // off the grid of the signal: simulate_cd allows a jump of exactly the limit, which the
+        // engine rejects (so that the phase threshold's limit of 180 degrees rejects half cycles)
+        s.jumpLimit = 0.25f + 0.5f * float(uniform(0, 5));
+
+        const int maxSpan = chance(0.2) ? 40 : 8;
+        s.pastSpan = chance(0.3) ? 0 : uniform(1, maxSpan);
+        s.futureSpan = chance(0.3) ? 0 : uniform(1, maxSpan);
+        s.pastStrict = float(uniform(0, 100)) / 100.0f;
+        s.futureStrict = float(uniform(0, 100)) / 100.0f;
+
+        s.earlyDecision = chance(0.5);
+        s.interpolation = CrossingKernel::Interpolation(uniform(0, 1));
+        s.eventDuration = uniform(0, 5);
+
+        const int split = uniform(0, 3);
+        for (int pos = 0; pos < length;)
+        {
+            int size = split == 0 ? 1 : split == 1 ? uniform(1, 8) : split == 2 ? uniform(1, 300) : length;
+            size = std::min(size, length - pos);
+            c.buffers.push_back(size);
+            pos += size;
+        }
+        return c;
+    }
+
+    /** Keeps the first 'length' samples */
+    Case truncate(const Case& c, int length)
+    {
+        Case shorter = c;
+        shorter.signal.resize(size_t(length));
+        shorter.threshold.resize(size_t(length));
+        shorter.buffers.clear();
+
+        int pos = 0;
+        for (int size : c.buffers)
+        {
+            if (pos >= length)
+            {
+                break;
+            }
+            shorter.buffers.push_back(std::min(size, length - pos));
+            pos += size;
+        }
+        return shorter;
+    }
+
+    /** Drops the first 'count' samples */
+    Case dropFront(const Case& c, int count)
+    {
+        Case shorter = c;
+        shorter.signal.erase(shorter.signal.begin(), shorter.signal.begin() + count);
+        shorter.threshold.erase(shorter.threshold.begin(), shorter.threshold.begin() + count);
+        shorter.buffers.clear();
+
+        int pos = 0;
+        for (int size : c.buffers)
+        {
+            const int kept = std::min(size, pos + size - count);
+            if (kept > 0)
+            {
+                shorter.buffers.push_back(kept);
+            }
+            pos += size;
+        }
+        return shorter;
+    }
+
+    /** Makes a disagreeing case as small and plain as possible while it still disagrees. */
+    Case minimize(Case c)
+    {
+        bool changed = true;
+        auto attempt = [&](const Case& candidate)
+        {
+            if (disagree(candidate))
+            {
+                c = candidate;
+                changed = true;
+                return true;
+            }
+            return false;
+        };
+
+        while (changed)
+        {
+            changed = false;
+
+            // shortest prefix, then the shortest suffix of that
+            int low = 1;
+            int high = int(c.signal.size());
+            while (low < high)
+            {
+                const int mid = (low + high) / 2;
+                if (disagree(truncate(c, mid)))
+                {
+                    high = mid;
+                }
+                else
+                {
+                    low = mid + 1;
+                }
+            }
+            if (high < int(c.signal.size()))
+            {
+                c = truncate(c, high);
+                changed = true;
+            }
+            for (int count = int(c.signal.size()) / 2; count > 0; count /= 2)
+            {
+                while (count < int(c.signal.size()) && attempt(dropFront(c, count)))
+                {
+                }
+            }
+
+            // simplest settings
+            using Settings = CrossingEngine::Settings;
+            auto simplify = [&](auto member, auto value)
+            {
+                if (c.options.settings.*member == value)
+                {
+                    return false;
+                }
+                Case candidate = c;
+                candidate.options.settings.*member = value;
+                return attempt(candidate);
+            };
+            simplify(&Settings::earlyDecision, false);
+            simplify(&Settings::interpolation, CrossingKernel::LINEAR);
+            simplify(&Settings::eventDuration, 0);
+            simplify(&Settings::useJumpLimit, false);
+            simplify(&Settings::timeout, 0);
+            simplify(&Settings::pastStrict, 0.0f);
+            simplify(&Settings::futureStrict, 0.0f);
+            if (c.options.settings.posOn && c.options.settings.negOn)
+            {
+                simplify(&Settings::negOn, false) || simplify(&Settings::posOn, false);
+            }
+            simplify(&Settings::thresholdType, CONSTANT);
+            simplify(&Settings::constantThresh, 0.0f);
+            for (int span = 0; span < c.options.settings.pastSpan && !simplify(&Settings::pastSpan, span); ++span)
+            {
+            }
+            for (int span = 0; span < c.options.settings.futureSpan && !simplify(&Settings::futureSpan, span); ++span)
+            {
+            }
+
+            // fewer buffers
+            if (c.buffers.size() > 1)
+            {
+                Case single = c;
+                single.buffers.assign(1, int(c.signal.size()));
+                if (!attempt(single))
+                {
+                    for (size_t b = 0; b + 1 < c.buffers.size(); ++b)
+                    {
+                        Case merged = c;
+                        merged.buffers[b] += merged.buffers[b + 1];
+                        merged.buffers.erase(merged.buffers.begin() + std::ptrdiff_t(b) + 1);
+                        attempt(merged);
+                    }
+                }
+            }
+
+            // plainer samples
+            for (size_t i = 0; i < c.signal.size(); ++i)
+            {
+                // in order of preference, so that a sample never goes back and forth
+                for (float value : { 0.0f, c.options.settings.constantThresh })
+                {
+                    if (c.signal[i] == value)
+                    {
+                        break;
+                    }
+                    Case candidate = c;
+                    candidate.signal[i] = value;
+                    if (attempt(candidate))
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+        return c;
+    }
+
+    void writeList(std::ostream& out, const char* name, const std::vector<float>& values)
+    {
+        out << name << ":";
+        for (float value : values)
+        {
+            out << " " << value;
+        }
+        out << "\n";
+    }
+
+    void writeList(std::ostream& out, const char* name, const std::vector<int64_t>& values)
+    {
+        out << name << ":";
+        for (int64_t value : values)
+        {
+            out << " " << value;
+        }
+        out << "\n";
+    }
+
+    /** Writes a case in the format of --case, with the onsets of both detectors as comments */
+    void writeCase(std::ostream& out, const Case& c)
+    {
+        const CrossingEngine::Settings& s = c.options.settings;
+        out << "Rising=" << (s.posOn ? "true" : "false") << "\n"
+            << "Falling=" << (s.negOn ? "true" : "false") << "\n"
+            << "threshold_type=" << int(s.thresholdType) << "\n"
+            << "constant_threshold=" << s.constantThresh << "\n"
+            << "Timeout_ms=" << s.timeout << "\n"
+            << "use_jump_limit=" << (s.useJumpLimit ? "true" : "false") << "\n"
+            << "jump_limit=" << s.jumpLimit << "\n"
+            << "past_span=" << s.pastSpan << "\n"
+            << "past_strict=" << s.pastStrict << "\n"
+            << "future_span=" << s.futureSpan << "\n"
+            << "future_strict=" << s.futureStrict << "\n"
+            << "early_decision=" << (s.earlyDecision ? "true" : "false") << "\n"
+            << "crossing_interpolation=" << int(s.interpolation) << "\n"
+            << "event_duration=" << s.eventDuration << "\n";
+
+        out << "buffers:";
+        for (int size : c.buffers)
+        {
+            out << " " << size;
+        }
+        out << "\n";
+        writeList(out, "signal", c.signal);
+        if (s.thresholdType == CHANNEL)
+        {
+            writeList(out, "threshold", c.threshold);
+        }
+
+        out << "# ";
+        writeList(out, "model onsets", runModel(c));
+        out << "# ";
+        writeList(out, "engine onsets", runEngine(c));
+    }
+
+    bool readCase(const std::string& path, Case& c, std::string& error)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            error = "can't open " + path;
+            return false;
+        }
+
+        c = Case();
+        c.options.channels = { 0 };
+
+        std::string line;
+        while (std::getline(in, line))
+        {
+            line = line.substr(0, line.find('#'));
+            const size_t colon = line.find(':');
+            if (colon == std::string::npos)
+            {
+                if (line.find_first_not_of(" \t\r") != std::string::npos && !c.options.set(line, error))
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            const std::string name = line.substr(0, colon);
+            std::istringstream values(line.substr(colon + 1));
+            float value;
+            if (name == "buffers")
+            {
+                while (values >> value)
+                {
+                    c.buffers.push_back(int(value));
+                }
+            }
+            else if (name == "signal" || name == "threshold")
+            {
+                std::vector<float>& list = name == "signal" ? c.signal : c.threshold;
+                while (values >> value)
+                {
+                    list.push_back(value);
+                }
+            }
+            else
+            {
+                error = "unknown list in " + path + ": " + name;
+                return false;
+            }
+        }
+
+        c.threshold.resize(c.signal.size(), 0.0f);
+        int total = 0;
+        for (int size : c.buffers)
+        {
+            total += size;
+        }
+        if (c.buffers.empty() || total != int(c.signal.size()))
+        {
+            error = path + ": the buffers must add up to the length of the signal";
+            return false;
+        }
+        return true;
+    }
+
+    /** Times of the crossings found in a smooth signal at 30 kHz, with the given decimation */
+    std::vector<CrossingEngine::Event> detectSmooth(const std::vector<float>& signal, int decimation)
+    {
+        DetectorOptions options;
+        options.settings.decimation = decimation;
+        options.settings.posOn = true;
+        options.settings.negOn = true;
+        options.settings.constantThresh = 0.0f; // where the signal is steep
+        options.settings.timeout = 0;
+        options.settings.eventDuration = 1;
+
+        CrossingEngine engine;
+        options.apply(engine, 30000.0f);
+        engine.start(1024);
+
+        std::vector<CrossingEngine::Event> crossings;
+        for (int pos = 0; pos < int(signal.size()); pos += 1024)
+        {
+            const float* input = signal.data() + pos;
+            engine.process(&input, nullptr, std::min(1024, int(signal.size()) - pos), pos);
+            for (const CrossingEngine::Event& event : engine.getEvents())
+            {
+                // skip the settling of the anti-aliasing filter, and the end, where the decimated
+                // signal hasn't caught up yet
+                if (event.on && event.crossingPoint >= 3000 && event.crossingPoint < int64_t(signal.size()) - 3000)
+                {
+                    crossings.push_back(event);
+                }
+            }
+        }
+        return crossings;
+    }
+
+    /** Checks that decimation doesn't move the reported crossings: on a signal well within the
+     *  anti-aliasing filter's pass band, the crossing times must match those without
+     *  decimation (to within the interpolation error) once the filter's delay is accounted for.
+     *  Returns the largest difference, in input samples, or -1 if the crossings don't pair up.
+     */
+    double checkDecimationTiming(int decimation)
+    {
+        const double twoPi = 2.0 * std::acos(-1.0);
+        std::vector<float> signal(30000 * 4);
+        for (size_t i = 0; i < signal.size(); ++i)
+        {
+            const double t = double(i) / 30000.0;
+            signal[i] = float(100.0 * std::sin(twoPi * 7.0 * t) + 40.0 * std::sin(twoPi * 23.0 * t + 1.0));
+        }
+
+        const std::vector<CrossingEngine::Event> reference = detectSmooth(signal, 1);
+        const std::vector<CrossingEngine::Event> decimated = detectSmooth(signal, decimation);
+        if (reference.empty() || reference.size() != decimated.size())
+        {
+            return -1.0;
+        }
+
+        double maxDifference = 0.0;
+        for (size_t i = 0; i < reference.size(); ++i)
+        {
+            if (reference[i].rising() != decimated[i].rising()
+                || std::llabs(reference[i].crossingPoint - decimated[i].crossingPoint) > decimation
+                || reference[i].crossingPoint + reference[i].latency < decimated[i].crossingPoint)
+            {
+                return -1.0;
+            }
+            maxDifference = std::max(maxDifference, std::abs(reference[i].crossingTime - decimated[i].crossingTime));
+        }
+        return maxDifference;
+    }
+
+    /** Checks which input filters CrossingEngine::checkPrefilter() rejects at 30 kHz: empty or
+     *  inverted band-passes, and cutoffs at or above the Nyquist frequency after decimation.
+     *  Returns a description of the first filter it gets wrong, or an empty string.
+     */
+    std::string checkPrefilterValidation()
+    {
+        struct FilterCase
+        {
+            BiquadCascade::Type type;
+            float lowCut;
+            float highCut;
+            int decimation;
+            bool valid;
+        };
+
+        const FilterCase cases[] = {
+            { BiquadCascade::BANDPASS, 300.0f, 6000.0f, 1, true },
+            { BiquadCascade::BANDPASS, 6000.0f, 300.0f, 1, false },
+            { BiquadCascade::BANDPASS, 300.0f, 300.0f, 1, false },
+            { BiquadCascade::BANDPASS, 300.0f, 15000.0f, 1, false },
+            { BiquadCascade::BANDPASS, 300.0f, 6000.0f, 10, false },
+            { BiquadCascade::BANDPASS, 300.0f, 1000.0f, 10, true },
+            { BiquadCascade::HIGHPASS, 1400.0f, 1000.0f, 10, true },   // the high cutoff is unused
+            { BiquadCascade::HIGHPASS, 1500.0f, 6000.0f, 10, false },
+            { BiquadCascade::NONE, 6000.0f, 300.0f, 32, true },
+        };
+
+        for (const FilterCase& f : cases)
+        {
+            CrossingEngine::Settings settings;
+            settings.prefilterType = f.type;
+            settings.prefilterLowCut = f.lowCut;
+            settings.prefilterHighCut = f.highCut;
+            settings.decimation = f.decimation;
+
+            if (CrossingEngine::checkPrefilter(settings, 30000.0f).empty() != f.valid)
+            {
+                std::ostringstream text;
+                text << (f.valid ? "rejected" : "accepted") << " a filter of type " << int(f.type) << " from "
+                     << f.lowCut << " to " << f.highCut << " Hz with decimation by " << f.decimation;
+                return text.str();
+            }
+        }
+        return std::string();
+    }
+
+    void printVerifyUsage()
+    {
+        std::fprintf(stderr,
+            "usage: crossing-detector-tool verify [options]\n"
+            "\n"
+            "Runs the detector and a reference model of Resources/simulate_cd.m on random signals,\n"
+            "settings and buffer splits, and checks that they find the same event onsets. A case\n"
+            "where they don't is minimized and saved.\n"
+            "\n"
+            "  --cases <n>        number of random cases (default: 10000)\n"
+            "  --seed <n>         seed of the first case (default: 1); case i uses seed + i\n"
+            "  --save <file>      where to save a minimized mismatch (default: crossing-detector-mismatch.txt)\n"
+            "  --case <file>      run a saved case instead\n"
+            "\n"
+            "Before the random cases, it checks that the crossing times reported with decimation match\n"
+            "those without it, and that input filters with crossed cutoffs or cutoffs above the Nyquist\n"
+            "frequency are rejected.\n");
+    }
+}
+
+int runVerify(int argc, const char* const* argv)
+{
+    long long numCases = 10000;
+    unsigned long long seed = 1;
+    std::string savePath = "crossing-detector-mismatch.txt";
+    std::string casePath;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0)
+        {
+            printVerifyUsage();
+            return 0;
+        }
+        if (i + 1 >= argc)
+        {
+            std::fprintf(stderr, "verify: missing value for %s\n\n", arg);
+            printVerifyUsage();
+            return 2;
+        }
+
+        const char* value = argv[++i];
+        if (std::strcmp(arg, "--cases") == 0) numCases = std::atoll(value);
+        else if (std::strcmp(arg, "--seed") == 0) seed = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(arg, "--save") == 0) savePath = value;
+        else if (std::strcmp(arg, "--case") == 0) casePath = value;
+        else
+        {
+            std::fprintf(stderr, "verify: unexpected argument: %s\n\n", arg);
+            printVerifyUsage();
+            return 2;
+        }
+    }
+
+    if (!casePath.empty())
+    {
+        Case c;
+        std::string error;
+        if (!readCase(casePath, c, error))
+        {
+            std::fprintf(stderr, "verify: %s\n", error.c_str());
+            return 1;
+        }
+
+        std::ostringstream text;
+        writeCase(text, c);
+        std::printf("%s%s\n", text.str().c_str(), disagree(c) ? "MISMATCH" : "same onsets");
+        return disagree(c) ? 1 : 0;
+    }
+
+    const std::string filterError = checkPrefilterValidation();
+    if (!filterError.empty())
+    {
+        std::printf("the input filter check %s\n", filterError.c_str());
+        return 1;
+    }
+
+    // decimation must not shift the reported crossings (the anti-aliasing filter's delay is
+    // taken out); a difference of a fraction of a sample comes from interpolating between
+    // decimated samples
+    for (int decimation : { 2, 3, 8, 30, PolyphaseDecimator::MAX_FACTOR })
+    {
+        const double difference = checkDecimationTiming(decimation);
+        if (difference < 0.0 || difference > 1.0)
+        {
+            std::printf("with decimation by %d, the crossings differ from those without decimation", decimation);
+            if (difference >= 0.0)
+            {
+                std::printf(" by up to %.2f samples", difference);
+            }
+            std::printf("\n");
+            return 1;
+        }
+    }
+
+    for (long long i = 0; i < numCases; ++i)
+    {
+        std::mt19937_64 random(seed + (unsigned long long) i);
+        const Case c = generate(random);
+        if (!disagree(c))
+        {
+            continue;
+        }
+
+        std::printf("case %lld (seed %llu) disagrees with the reference model; minimizing...\n\n",
+            i, seed + (unsigned long long) i);
+        const Case minimal = minimize(c);
+
+        std::ostringstream text;
+        text << "# found by crossing-detector-tool verify --seed " << seed + (unsigned long long) i << " --cases 1\n";
+        writeCase(text, minimal);
+        std::printf("%s\n", text.str().c_str());
+
+        std::ofstream out(savePath);
+        out << text.str();
+        if (out.good())
+        {
+            std::printf("saved to %s (run it with --case %s)\n", savePath.c_str(), savePath.c_str());
+        }
+        return 1;
+    }
+
+    std::printf("%lld cases, all with the onsets of the reference model\n", numCases);
+    return 0;
+}